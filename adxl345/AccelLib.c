@@ -1,8 +1,23 @@
 #include "adxl345.h"
+#include "adxl345_filter.h"
+#include "adxl345_event.h"
+
+#define SAMPLE_RING_SIZE 64
+
+static adxl345_sample_t samples[ SAMPLE_RING_SIZE ];
+static adxl345_sample_t block[ ADXL345_FIFO_SIZE ];
+static adxl345_ring_t sample_ring;
+static adxl345_cic_t decimator;
+
+//watermark handler, reading the FIFO releases the interrupt pin
+static void fifo_watermark( uint8_t event )
+{
+    adxl345_fifo_drain( &sample_ring );
+}
 
 void main() 
 {
-    int x, y, z;
+    uint8_t i, count, event;
     
     UART1_Init( 9600 );
     TWI_Init( 100000 );
@@ -10,6 +25,9 @@ void main()
     
     adxl345_init( );
     
+    //configuration below is collected in RAM and written in a few bursts
+    adxl345_batch_begin();
+
     //set activity/ inactivity thresholds (0-255)
     adxl345_setActivityThreshold(75); //62.5mg per increment
     adxl345_setInactivityThreshold(75); //62.5mg per increment
@@ -40,13 +58,13 @@ void main()
     adxl345_setFreeFallThreshold(7); //(5 - 9) recommended - 62.5mg per increment
     adxl345_setFreeFallDuration(45); //(20 - 70) recommended - 5ms per increment
 
-    //setting all interupts to take place on int pin 1
-    //I had issues with int pin 2, was unable to reset it
-    adxl345_setInterruptMapping( ADXL345_INT_SINGLE_TAP_BIT, ADXL345_INT1_PIN );
-    adxl345_setInterruptMapping( ADXL345_INT_DOUBLE_TAP_BIT, ADXL345_INT1_PIN );
-    adxl345_setInterruptMapping( ADXL345_INT_FREE_FALL_BIT, ADXL345_INT1_PIN );
-    adxl345_setInterruptMapping( ADXL345_INT_ACTIVITY_BIT, ADXL345_INT1_PIN );
-    adxl345_setInterruptMapping( ADXL345_INT_INACTIVITY_BIT, ADXL345_INT1_PIN );
+    //setting all interupts to take place on int pin 2, wired to INT0 of the MCU
+    //the event dispatcher reads INT_SOURCE, which releases the pin
+    adxl345_setInterruptMapping( ADXL345_INT_SINGLE_TAP_BIT, ADXL345_INT2_PIN );
+    adxl345_setInterruptMapping( ADXL345_INT_DOUBLE_TAP_BIT, ADXL345_INT2_PIN );
+    adxl345_setInterruptMapping( ADXL345_INT_FREE_FALL_BIT, ADXL345_INT2_PIN );
+    adxl345_setInterruptMapping( ADXL345_INT_ACTIVITY_BIT, ADXL345_INT2_PIN );
+    adxl345_setInterruptMapping( ADXL345_INT_INACTIVITY_BIT, ADXL345_INT2_PIN );
 
     //register interupt actions - 1 == on; 0 == off
     adxl345_setInterrupt( ADXL345_INT_SINGLE_TAP_BIT, 1);
@@ -55,9 +73,51 @@ void main()
     adxl345_setInterrupt( ADXL345_INT_ACTIVITY_BIT, 1);
     adxl345_setInterrupt( ADXL345_INT_INACTIVITY_BIT, 1);
 
+    adxl345_batch_commit();
+
+    //sample at 800Hz into the FIFO, watermark of 24 on int pin 2
+    //int pin 2 is wired to INT0 of the MCU
+    adxl345_ring_init( &sample_ring, samples, SAMPLE_RING_SIZE );
+    adxl345_set_bw( ADXL345_BW_400 );
+    adxl345_fifo_init( ADXL345_FIFO_STREAM, 24, ADXL345_INT2_PIN );
+
+    //3rd order CIC, 800Hz down to 50Hz
+    adxl345_cic_init( &decimator, 3, 4 );
+
+    //watermark is handled right away, the other events are queued
+    adxl345_event_init();
+    adxl345_event_on( ADXL345_WATERMARK, fifo_watermark );
+
+    MCUCR |= ( 1 << ISC01 ) | ( 1 << ISC00 ); // The rising edge of INT0 generates an interrupt request
+    GICR  |= ( 1 << INT0 );                   // External Interrupt Request 0 Enable
+    SREG_I_bit = 1;
+
     while( 1 )
     {
-        //Boring accelerometer stuff
-        adxl345_readAccel( &x, &y, &z ); //read the accelerometer values and store them in variables x,y,z
+        //one INT_SOURCE read per interrupt, no polling in between
+        adxl345_event_dispatch();
+
+        while( adxl345_event_get( &event ) )
+        {
+            //tap, free fall and activity stuff
+        }
+
+        count = 0;
+        while( count < ADXL345_FIFO_SIZE && adxl345_ring_get( &sample_ring, &block[count] ) )
+        {
+            count++;
+        }
+
+        count = adxl345_cic_process( &decimator, block, block, count );
+
+        for( i = 0; i < count; i++ )
+        {
+            //Boring accelerometer stuff on block[i]
+        }
     }
+}
+
+void accel_ISR() iv IVT_ADDR_INT0 ics ICS_AUTO
+{
+    adxl345_event_isr();
 }
\ No newline at end of file
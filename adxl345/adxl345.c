@@ -1,69 +1,197 @@
 
+#include <stddef.h>
+#include <string.h>
 #include "adxl345.h"
 #include <math.h>
 
 #define constrain(amt,low,high) ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
 
-#define ADXL345_DEVICE_WRITE (0x3A)  // ADXL345 device address
-#define ADXL345_DEVICE_READ (0x3B)
 #define ADXL345_TO_READ (6)   // num of bytes we are going to read each time (two bytes for each axis)
 
-#define ACKNOWLEDGE 1
-#define NO_ACKNOWLEDGE 0
+#define FIFO_MODE_MASK     0b11000000  // FIFO_CTL mode bits
+#define FIFO_TRIGGER_BIT   5           // FIFO_CTL trigger bit
+#define FIFO_SAMPLES_MASK  0b00011111  // FIFO_CTL samples bits
+#define FIFO_ENTRIES_MASK  0b00111111  // FIFO_STATUS entries bits
+#define FIFO_TRIG_BIT      7           // FIFO_STATUS trigger bit
+
+// Register cache covers the writable registers THRESH_TAP .. FIFO_CTL
+#define CACHE_FIRST        ADXL345_THRESH_TAP
+#define CACHE_LAST         ADXL345_FIFO_CTL
+#define CACHE_SIZE         ADXL345_CACHE_SIZE
+#define CACHE_BIT( reg )   ( 1UL << ( ( reg ) - CACHE_FIRST ) )
+#define CACHE_WRITABLE     ( 0x00003FFFUL      /* 0x1d - 0x2a */ \
+                           | 0x00078000UL      /* 0x2c - 0x2f */ \
+                           | CACHE_BIT( ADXL345_DATA_FORMAT ) \
+                           | CACHE_BIT( ADXL345_FIFO_CTL ) )
+#define IS_CACHED( reg )   ( ( reg ) >= CACHE_FIRST && ( reg ) <= CACHE_LAST \
+                           && ( CACHE_WRITABLE & CACHE_BIT( reg ) ) )
+#define CACHE_LAST_PHASE   ( CACHE_BIT( ADXL345_POWER_CTL ) | CACHE_BIT( ADXL345_INT_ENABLE ) )
+#define CACHE_MAX_GAP      3           // clean registers rewritten to join two bursts
+
+#define FULL_RES_BIT       3           // DATA_FORMAT full resolution bit
+#define RANGE_MASK         0b00000011  // DATA_FORMAT range bits
+
+// counts * Q12 scale, rounded, to mg
+#define TO_MG( raw, axis ) ( ( int16_t )( ( ( int32_t )( int16_t )( ( raw ) << dev->conv_shift ) \
+                             * dev->scale[axis] + 2048 ) >> 12 ) - dev->bias[axis] )
 
 //private:
+static void busWrite( uint8_t address, uint8_t* buff, uint8_t num );
+static void busRead( uint8_t address, int num, uint8_t buff[] );
 static void writeTo( uint8_t address, uint8_t val );
 static void readFrom( uint8_t address, int num, uint8_t buff[] );
+static void cacheSync( void );
+static void cacheFlush( uint32_t phase_mask );
+static void sampleDone( adxl345_bus_t* _bus, uint8_t* buff, uint8_t num );
 static void setRegisterBit( uint8_t regAdress, uint8_t bitPos, bool state );
 static bool getRegisterBit( uint8_t regAdress, uint8_t bitPos );
 
-// Variables
-static uint8_t _buff[6] ;  //6 chars buffer for saving data read from the device
-static bool status;        // set when error occurs
+// Sensor the functions below work on
+static adxl345_t default_dev;
+static adxl345_t* dev = &default_dev;
 
-// see error code for details
-static int error_code;    // Initial state
-static double gains[3];       // counts to Gs
+#ifndef ADXL345_HOST
+static adxl345_bus_t i2c_bus;     // used when adxl345_setBus was not called
+#endif
 
-// Writes val to address register on device
-static void writeTo( uint8_t address,  uint8_t val )
+// Writes num bytes starting at address register, register address auto increments.
+// Here and in busRead the SPI transport waits for a running DMA read.
+static void busWrite( uint8_t address, uint8_t* buff, uint8_t num )
 {
-    TWI_Start();              // issue I2C start signal
-    TWI_Write( ADXL345_DEVICE_WRITE );          // send byte via I2C  (device address + W)
-    TWI_Write( address );       // send byte (address of the location)
-    TWI_Write( val );         // send data (data to be written)
-    TWI_Stop();               // issue I2C stop signal
+    if( dev->bus == NULL )
+    {
+        dev->status = ADXL345_ERROR;
+        dev->error_code = ADXL345_NO_BUS;
+        return;
+    }
+
+    dev->bus_transactions++;
+    dev->bus->write( dev->bus, address, buff, num );
 }
 
 // Reads num  chars starting from address register on device in to _buff array
-static void readFrom( uint8_t address, int num, uint8_t _buff[] )
+static void busRead( uint8_t address, int num, uint8_t buff[] )
 {
-    int i = 0;
-    
-    TWI_Start();              // issue I2C start signal
-    TWI_Write( ADXL345_DEVICE_WRITE );        // send byte via I2C (device address + W)
-    TWI_Write( address );     // send byte (data address)
+    if( dev->bus == NULL )
+    {
+        dev->status = ADXL345_ERROR;
+        dev->error_code = ADXL345_NO_BUS;
+        return;
+    }
 
-    TWI_Start();              // issue I2C signal repeated start
-    TWI_Write( ADXL345_DEVICE_READ );        // send byte (device address + R)
+    dev->bus_transactions++;
+    dev->bus->read( dev->bus, address, buff, ( uint8_t )num );
+}
 
-    while( i < num )
+// Writes val to address register on device.  Cached registers skip
+// writes of an unchanged value and are only marked dirty inside a batch.
+static void writeTo( uint8_t address,  uint8_t val )
+{
+    if( IS_CACHED( address ) )
     {
-        if( i == ( num - 1 ) )
-            _buff[i] = TWI_Read( NO_ACKNOWLEDGE );
-        else
-            _buff[i] = TWI_Read( ACKNOWLEDGE );
-        i++;
+        uint32_t bit = CACHE_BIT( address );
+
+        if( ( dev->cache_valid & bit ) && dev->reg_cache[ address - CACHE_FIRST ] == val
+            && !( dev->cache_dirty & bit ) )
+        {
+            return;                   // device already holds val
+        }
+
+        dev->reg_cache[ address - CACHE_FIRST ] = val;
+        dev->cache_valid |= bit;
+
+        if( dev->batch_depth )
+        {
+            dev->cache_dirty |= bit;  // goes out with adxl345_batch_commit
+            return;
+        }
+
+        dev->cache_dirty &= ~bit;
     }
-    
-    if ( i != num )
+
+    busWrite( address, &val, 1 );
+}
+
+// Reads num chars starting from address register.  A single cached
+// register is served from RAM once its value is known.
+static void readFrom( uint8_t address, int num, uint8_t buff[] )
+{
+    if( num == 1 && IS_CACHED( address ) )
     {
-        status = ADXL345_ERROR;
-        error_code = ADXL345_READ_ERROR;
+        uint32_t bit = CACHE_BIT( address );
+
+        if( !( dev->cache_valid & bit ) )
+        {
+            busRead( address, 1, &dev->reg_cache[ address - CACHE_FIRST ] );
+            dev->cache_valid |= bit;
+        }
+
+        buff[0] = dev->reg_cache[ address - CACHE_FIRST ];
+        return;
+    }
+
+    busRead( address, num, buff );
+}
+
+// Loads the cache with two burst reads.  DATAX0 - DATAZ1 are skipped so a
+// FIFO entry is not popped.
+static void cacheSync()
+{
+    busRead( CACHE_FIRST, ADXL345_DATA_FORMAT - CACHE_FIRST + 1, dev->reg_cache );
+    busRead( ADXL345_FIFO_CTL, 1, &dev->reg_cache[ ADXL345_FIFO_CTL - CACHE_FIRST ] );
+
+    dev->cache_valid = CACHE_WRITABLE;
+    dev->cache_dirty = 0;
+}
+
+// Writes dirty registers selected by phase_mask as bursts of consecutive
+// registers.  Short runs of clean registers between two dirty ones are
+// written along with them when that saves a transaction, as long as their
+// cached values are known.
+static void cacheFlush( uint32_t phase_mask )
+{
+    uint8_t reg, first, last, gap;
+    uint32_t dirty = dev->cache_dirty & phase_mask;
+
+    reg = CACHE_FIRST;
+
+    while( dirty && reg <= CACHE_LAST )
+    {
+        if( !( dirty & CACHE_BIT( reg ) ) )
+        {
+            reg++;
+            continue;
+        }
+
+        first = last = reg;
+        gap = 0;
+
+        // extend burst while registers are writable, known and gaps stay
+        // short, dirty registers are always known
+        for( reg = first + 1; reg <= CACHE_LAST; reg++ )
+        {
+            if( !( phase_mask & CACHE_WRITABLE & dev->cache_valid & CACHE_BIT( reg ) ) )
+                break;
+
+            if( dirty & CACHE_BIT( reg ) )
+            {
+                last = reg;
+                gap = 0;
+            }
+            else if( ++gap > CACHE_MAX_GAP )
+            {
+                break;
+            }
+        }
+
+        busWrite( first, &dev->reg_cache[ first - CACHE_FIRST ], last - first + 1 );
+
+        for( reg = first; reg <= last; reg++ )
+        {
+            dirty &= ~CACHE_BIT( reg );
+            dev->cache_dirty &= ~CACHE_BIT( reg );
+        }
     }
-    
-    TWI_Stop();
-    
 }
 
 static void setRegisterBit( uint8_t regAdress, uint8_t bitPos, bool state )
@@ -96,14 +224,83 @@ static bool getRegisterBit( uint8_t regAdress, uint8_t bitPos )
 
 
 // Public
+void adxl345_setBus( adxl345_bus_t* _bus )
+{
+    dev->bus = _bus;
+}
+
+void adxl345_open( adxl345_t* _dev, adxl345_bus_t* _bus )
+{
+    memset( _dev, 0, sizeof( adxl345_t ) );
+    _dev->bus = _bus;
+
+    dev = _dev;
+    adxl345_init();
+}
+
+adxl345_t* adxl345_select( adxl345_t* _dev )
+{
+    adxl345_t* prev = dev;
+
+    dev = ( _dev != NULL ) ? _dev : &default_dev;
+    return prev;
+}
+
+adxl345_t* adxl345_selected()
+{
+    return dev;
+}
+
+// All data registers are read first, one burst per sensor back to back,
+// and only then converted, so the reads sit as close together as the bus
+// allows.
+void adxl345_read_group( adxl345_t** devs, uint8_t count, adxl345_sample_t* samples )
+{
+    adxl345_t* prev = dev;
+    uint8_t i;
+
+    for( i = 0; i < count; i++ )
+    {
+        dev = devs[i];
+        busRead( ADXL345_DATAX0, ADXL345_TO_READ, dev->buff );
+    }
+
+    for( i = 0; i < count; i++ )
+    {
+        samples[i].x = ( int16_t )( ( ( uint16_t )devs[i]->buff[1] << 8 ) | devs[i]->buff[0] );
+        samples[i].y = ( int16_t )( ( ( uint16_t )devs[i]->buff[3] << 8 ) | devs[i]->buff[2] );
+        samples[i].z = ( int16_t )( ( ( uint16_t )devs[i]->buff[5] << 8 ) | devs[i]->buff[4] );
+    }
+
+    dev = prev;
+}
+
 void adxl345_init( )
 {
-    status = ADXL345_OK;
-    error_code = ADXL345_NO_ERROR;
+    dev->status = ADXL345_OK;
+    dev->error_code = ADXL345_NO_ERROR;
+    dev->batch_depth = 0;
+
+#ifndef ADXL345_HOST
+    if( dev->bus == NULL )
+    {
+        adxl345_bus_i2c_init( &i2c_bus, ADXL345_I2C_ADDRESS );
+        dev->bus = &i2c_bus;
+    }
+#endif
+
+    cacheSync();
+
+    dev->gains[0] = 0.00376390;
+    dev->gains[1] = 0.00376009;
+    dev->gains[2] = 0.00349265;
 
-    gains[0] = 0.00376390;
-    gains[1] = 0.00376009;
-    gains[2] = 0.00349265;
+    // same calibration as gains, in mg/LSB Q12
+    dev->scale[0] = 15417;
+    dev->scale[1] = 15401;
+    dev->scale[2] = 14306;
+    dev->bias[0] = dev->bias[1] = dev->bias[2] = 0;
+    adxl345_conv_update();
     
     //Turning on the ADXL345
     writeTo( ADXL345_POWER_CTL, 0 );
@@ -119,13 +316,39 @@ void adxl345_readAccelxyz( int *xyz )
 
 void adxl345_readAccel( int *x, int *y, int *z )
 {
-    readFrom( ADXL345_DATAX0, ADXL345_TO_READ, _buff ); //read the acceleration data from the ADXL345
+    busRead( ADXL345_DATAX0, ADXL345_TO_READ, dev->buff ); //read the acceleration data from the ADXL345
 
     // each axis reading comes in 10 bit resolution, ie 2  chars. Least Significat  char first!!
     // thus we are converting both  chars in to one int
-    *x = ( ( ( int ) _buff[1] ) << 8 ) | _buff[0];
-    *y = ( ( ( int ) _buff[3] ) << 8 ) | _buff[2];
-    *z = ( ( ( int ) _buff[5] ) << 8 ) | _buff[4];
+    *x = ( ( ( int ) dev->buff[1] ) << 8 ) | dev->buff[0];
+    *y = ( ( ( int ) dev->buff[3] ) << 8 ) | dev->buff[2];
+    *z = ( ( ( int ) dev->buff[5] ) << 8 ) | dev->buff[4];
+}
+
+void adxl345_readSample( adxl345_sample_t* sample )
+{
+    busRead( ADXL345_DATAX0, ADXL345_TO_READ, dev->buff );
+
+    sample->x = ( int16_t )( ( ( uint16_t )dev->buff[1] << 8 ) | dev->buff[0] );
+    sample->y = ( int16_t )( ( ( uint16_t )dev->buff[3] << 8 ) | dev->buff[2] );
+    sample->z = ( int16_t )( ( ( uint16_t )dev->buff[5] << 8 ) | dev->buff[4] );
+}
+
+uint8_t adxl345_readRegister( uint8_t reg )
+{
+    uint8_t _b = '\0';
+
+    readFrom( reg, 1, &_b );
+    return _b;
+}
+
+void adxl345_writeRegister( uint8_t reg, uint8_t val )
+{
+    writeTo( reg, val );
+    if( reg == ADXL345_DATA_FORMAT )
+    {
+        adxl345_conv_update();
+    }
 }
 
 void adxl345_get_Gxyz( double *xyz )
@@ -137,7 +360,7 @@ void adxl345_get_Gxyz( double *xyz )
     
     for( i = 0; i < 3; i++ )
     {
-        xyz[i] = xyz_int[i] * gains[i];
+        xyz[i] = xyz_int[i] * dev->gains[i];
     }
 }
 
@@ -154,7 +377,7 @@ void adxl345_setTapThreshold( uint8_t tapThreshold )
 // Gets the THRESH_TAP  char value
 // return value is comprised between 0 and 255
 // the scale factor is 62.5 mg/LSB
-int adxl345_getTapThreshold()
+uint8_t adxl345_getTapThreshold()
 {
     uint8_t _b = '\0';
 
@@ -163,13 +386,19 @@ int adxl345_getTapThreshold()
 }
 
 // set/get the gain for each axis in Gs / count
+// The milli-g scale is per full resolution count, TO_MG shifts 10-bit
+// counts up by the range first, so the gain is divided by that shift
 void adxl345_setAxisGains( double *_gains )
 {
     int i = 0;
+    double q;
 
     for ( i = 0; i < 3; i++ )
     {
-        gains[i] = _gains[i];
+        dev->gains[i] = _gains[i];
+
+        q = _gains[i] * 4096000.0 / ( 1 << dev->conv_shift ) + 0.5;
+        dev->scale[i] = ( q < 0.0 ) ? 0 : ( q > 65535.0 ) ? 0xFFFF : ( uint16_t )q;
     }
 }
 
@@ -180,7 +409,7 @@ void adxl345_getAxisGains( double* _gains )
 
     for( i = 0; i < 3; i++ )
     {
-       _gains[i] = gains[i];
+       _gains[i] = dev->gains[i];
     }
 }
 
@@ -238,7 +467,7 @@ void adxl345_setDoubleTapLatency( uint8_t doubleTapLatency )
 }
 
 // Gets the Latent value
-int adxl345_getDoubleTapLatency()
+uint8_t adxl345_getDoubleTapLatency()
 {
     uint8_t _b = '\0';
 
@@ -312,7 +541,7 @@ void adxl345_setTimeInactivity( uint8_t timeInactivity )
 }
 
 // Gets the TIME_INACT register
-int adxl345_getTimeInactivity()
+uint8_t adxl345_getTimeInactivity()
 {
     uint8_t _b = '\0';
 
@@ -579,8 +808,8 @@ void adxl345_set_bw( int bw_code )
 {
     if( ( bw_code < ADXL345_BW_3 ) || ( bw_code > ADXL345_BW_1600 ) )
     {
-        status = false;
-        error_code = ADXL345_BAD_ARG;
+        dev->status = false;
+        dev->error_code = ADXL345_BAD_ARG;
     }
     else
     {
@@ -634,12 +863,12 @@ int adxl345_getInterruptSource()
     return ( int )_b;
 }
 
-bool adxl345_getInterruptSourceBit( uint8_t interruptBit )
+bool adxl345_getInterruptSourceBit( int interruptBit )
 {
     return getRegisterBit( ADXL345_INT_SOURCE, interruptBit );
 }
 
-bool adxl345_getInterruptMapping( uint8_t interruptBit )
+bool adxl345_getInterruptMapping( int interruptBit )
 {
     return getRegisterBit( ADXL345_INT_MAP, interruptBit );
 }
@@ -709,6 +938,7 @@ void adxl345_setRangeSetting( int val )
     readFrom( ADXL345_DATA_FORMAT, 1, &_b );
     _s |= ( _b & 0b11101100 );
     writeTo( ADXL345_DATA_FORMAT, _s );
+    adxl345_conv_update();
 }
 
 // gets the state of the SELF_TEST bit
@@ -767,6 +997,7 @@ bool adxl345_getFullResBit()
 void adxl345_setFullResBit( bool fullResBit )
 {
     setRegisterBit( ADXL345_DATA_FORMAT, 3, fullResBit );
+    adxl345_conv_update();
 }
 
 // Gets the state of the justify bit
@@ -781,4 +1012,332 @@ bool adxl345_getJustifyBit()
 void adxl345_setJustifyBit( bool justifyBit )
 {
     setRegisterBit( ADXL345_DATA_FORMAT, 2, justifyBit );
-}
\ No newline at end of file
+}
+
+
+
+// Configures FIFO mode, watermark and the watermark interrupt in one go.
+// Interrupt is disabled while FIFO_CTL changes so no stale watermark fires.
+void adxl345_fifo_init( uint8_t mode, uint8_t watermark, int interruptPin )
+{
+    uint8_t _b;
+
+    if( mode > ADXL345_FIFO_TRIGGER || watermark > FIFO_SAMPLES_MASK )
+    {
+        dev->status = ADXL345_ERROR;
+        dev->error_code = ADXL345_BAD_ARG;
+        return;
+    }
+
+    adxl345_setInterrupt( ADXL345_INT_WATERMARK_BIT, false );
+
+    _b = ( mode << 6 ) | ( watermark & FIFO_SAMPLES_MASK );
+    if( interruptPin == ADXL345_INT2_PIN )
+    {
+        _b |= ( 1 << FIFO_TRIGGER_BIT );
+    }
+    writeTo( ADXL345_FIFO_CTL, _b );
+
+    adxl345_setInterruptMapping( ADXL345_INT_WATERMARK_BIT, interruptPin );
+
+    if( mode != ADXL345_FIFO_BYPASS )
+    {
+        adxl345_setInterrupt( ADXL345_INT_WATERMARK_BIT, true );
+    }
+}
+
+// Sets the FIFO mode bits, other FIFO_CTL bits left alone
+void adxl345_setFifoMode( uint8_t mode )
+{
+    uint8_t _b = '\0';
+
+    if( mode > ADXL345_FIFO_TRIGGER )
+    {
+        dev->status = ADXL345_ERROR;
+        dev->error_code = ADXL345_BAD_ARG;
+        return;
+    }
+
+    readFrom( ADXL345_FIFO_CTL, 1, &_b );
+    _b = ( _b & ~FIFO_MODE_MASK ) | ( mode << 6 );
+    writeTo( ADXL345_FIFO_CTL, _b );
+}
+
+uint8_t adxl345_getFifoMode()
+{
+    uint8_t _b = '\0';
+
+    readFrom( ADXL345_FIFO_CTL, 1, &_b );
+    return ( _b & FIFO_MODE_MASK ) >> 6;
+}
+
+// Sets the samples bits, watermark in FIFO / stream mode
+void adxl345_setFifoSamples( uint8_t samples )
+{
+    uint8_t _b = '\0';
+
+    readFrom( ADXL345_FIFO_CTL, 1, &_b );
+    _b = ( _b & ~FIFO_SAMPLES_MASK ) | ( samples & FIFO_SAMPLES_MASK );
+    writeTo( ADXL345_FIFO_CTL, _b );
+}
+
+uint8_t adxl345_getFifoSamples()
+{
+    uint8_t _b = '\0';
+
+    readFrom( ADXL345_FIFO_CTL, 1, &_b );
+    return _b & FIFO_SAMPLES_MASK;
+}
+
+// Trigger bit, 0 links trigger mode to INT1, 1 to INT2
+void adxl345_setFifoTriggerPin( int interruptPin )
+{
+    setRegisterBit( ADXL345_FIFO_CTL, FIFO_TRIGGER_BIT, ( bool )interruptPin );
+}
+
+uint8_t adxl345_getFifoEntries()
+{
+    uint8_t _b = '\0';
+
+    readFrom( ADXL345_FIFO_STATUS, 1, &_b );
+    return _b & FIFO_ENTRIES_MASK;
+}
+
+bool adxl345_isFifoTriggered()
+{
+    return getRegisterBit( ADXL345_FIFO_STATUS, FIFO_TRIG_BIT );
+}
+
+// Reads all entries present in the FIFO into ring.  Each entry has to be
+// read as its own 6 byte burst from DATAX0, the FIFO pops on the last byte.
+uint8_t adxl345_fifo_drain( adxl345_ring_t* ring )
+{
+    uint8_t entries, i, next;
+    uint8_t _b[ ADXL345_TO_READ ];
+
+    entries = adxl345_getFifoEntries();
+
+    for( i = 0; i < entries; i++ )
+    {
+        busRead( ADXL345_DATAX0, ADXL345_TO_READ, _b );
+
+        next = ring->head + 1;
+        if( next == ring->size )
+        {
+            next = 0;
+        }
+
+        if( next == ring->tail )
+        {
+            ring->overflow++;            // Ring full, drop sample
+            continue;
+        }
+
+        ring->buffer[ ring->head ].x = ( int16_t )( ( ( uint16_t )_b[1] << 8 ) | _b[0] );
+        ring->buffer[ ring->head ].y = ( int16_t )( ( ( uint16_t )_b[3] << 8 ) | _b[2] );
+        ring->buffer[ ring->head ].z = ( int16_t )( ( ( uint16_t )_b[5] << 8 ) | _b[4] );
+        ring->head = next;
+    }
+
+    return entries;
+}
+
+void adxl345_ring_init( adxl345_ring_t* ring, adxl345_sample_t* buffer, uint8_t size )
+{
+    ring->buffer   = buffer;
+    ring->size     = size;
+    ring->head     = 0;
+    ring->tail     = 0;
+    ring->overflow = 0;
+}
+
+bool adxl345_ring_get( adxl345_ring_t* ring, adxl345_sample_t* sample )
+{
+    uint8_t tail = ring->tail;
+
+    if( tail == ring->head )
+    {
+        return false;
+    }
+
+    *sample = ring->buffer[ tail ];
+
+    if( ++tail == ring->size )
+    {
+        tail = 0;
+    }
+    ring->tail = tail;
+
+    return true;
+}
+
+uint8_t adxl345_ring_count( adxl345_ring_t* ring )
+{
+    uint8_t head = ring->head;
+    uint8_t tail = ring->tail;
+
+    return ( head >= tail ) ? head - tail : ring->size - tail + head;
+}
+
+// Starts a batch, writes to cached registers stay in RAM until commit.
+// Batches nest, the outermost commit writes.
+void adxl345_batch_begin()
+{
+    dev->batch_depth++;
+}
+
+// Writes registers changed during the batch.  POWER_CTL and INT_ENABLE
+// go last as the datasheet asks for them to be set after the others.
+void adxl345_batch_commit()
+{
+    if( dev->batch_depth == 0 || --dev->batch_depth > 0 )
+    {
+        return;
+    }
+
+    cacheFlush( CACHE_WRITABLE & ~CACHE_LAST_PHASE );
+    cacheFlush( CACHE_LAST_PHASE );
+}
+
+// Forgets cached values, e.g. after the sensor lost power.  The next
+// access of each register reads the device again.
+void adxl345_cache_invalidate()
+{
+    dev->cache_valid = 0;
+    dev->cache_dirty = 0;
+}
+
+uint32_t adxl345_getBusTransactions()
+{
+    return dev->bus_transactions;
+}
+
+void adxl345_resetBusTransactions()
+{
+    dev->bus_transactions = 0;
+}
+// Completion of adxl345_readSampleAsync, may run in interrupt context
+static void sampleDone( adxl345_bus_t* _bus, uint8_t* buff, uint8_t num )
+{
+    adxl345_t* owner = ( adxl345_t* )_bus->owner;   // selection may have changed
+
+    ( void )num;
+    owner->async_sample.x = ( int16_t )( ( ( uint16_t )buff[1] << 8 ) | buff[0] );
+    owner->async_sample.y = ( int16_t )( ( ( uint16_t )buff[3] << 8 ) | buff[2] );
+    owner->async_sample.z = ( int16_t )( ( ( uint16_t )buff[5] << 8 ) | buff[4] );
+
+    if( owner->async_done != NULL )
+    {
+        owner->async_done( &owner->async_sample );
+    }
+}
+
+bool adxl345_readSampleAsync( void ( *done )( adxl345_sample_t* sample ) )
+{
+    if( dev->bus == NULL )
+    {
+        dev->status = ADXL345_ERROR;
+        dev->error_code = ADXL345_NO_BUS;
+        return false;
+    }
+
+    if( dev->bus->busy )
+    {
+        return false;
+    }
+
+    dev->async_done = done;
+    dev->bus->owner = dev;
+    dev->bus_transactions++;
+
+    return dev->bus->read_async( dev->bus, ADXL345_DATAX0, dev->async_buff, ADXL345_TO_READ,
+                                 sampleDone );
+}
+// 10-bit mode doubles the mg/LSB with each range step, full resolution
+// keeps 3.9 mg/LSB.  Shifting counts up keeps one scale for all ranges.
+void adxl345_conv_update()
+{
+    uint8_t _b = '\0';
+
+    readFrom( ADXL345_DATA_FORMAT, 1, &_b );
+
+    if( _b & ( 1 << FULL_RES_BIT ) )
+        dev->conv_shift = 0;
+    else
+        dev->conv_shift = _b & RANGE_MASK;
+}
+
+void adxl345_setAxisScale( uint16_t* _scale )
+{
+    dev->scale[0] = _scale[0];
+    dev->scale[1] = _scale[1];
+    dev->scale[2] = _scale[2];
+}
+
+void adxl345_getAxisScale( uint16_t* _scale )
+{
+    _scale[0] = dev->scale[0];
+    _scale[1] = dev->scale[1];
+    _scale[2] = dev->scale[2];
+}
+
+void adxl345_setAxisBias( int16_t* _bias )
+{
+    dev->bias[0] = _bias[0];
+    dev->bias[1] = _bias[1];
+    dev->bias[2] = _bias[2];
+}
+
+void adxl345_getAxisBias( int16_t* _bias )
+{
+    _bias[0] = dev->bias[0];
+    _bias[1] = dev->bias[1];
+    _bias[2] = dev->bias[2];
+}
+
+void adxl345_get_mGxyz( int16_t* xyz )
+{
+    busRead( ADXL345_DATAX0, ADXL345_TO_READ, dev->buff );
+
+    xyz[0] = TO_MG( ( ( uint16_t )dev->buff[1] << 8 ) | dev->buff[0], 0 );
+    xyz[1] = TO_MG( ( ( uint16_t )dev->buff[3] << 8 ) | dev->buff[2], 1 );
+    xyz[2] = TO_MG( ( ( uint16_t )dev->buff[5] << 8 ) | dev->buff[4], 2 );
+}
+
+void adxl345_convert_mg( adxl345_sample_t* samples, uint8_t count )
+{
+    while( count-- )
+    {
+        samples->x = TO_MG( samples->x, 0 );
+        samples->y = TO_MG( samples->y, 1 );
+        samples->z = TO_MG( samples->z, 2 );
+        samples++;
+    }
+}
+
+uint8_t adxl345_ring_get_mg( adxl345_ring_t* ring, adxl345_sample_t* out, uint8_t max )
+{
+    uint8_t n = 0;
+    uint8_t tail = ring->tail;
+    adxl345_sample_t* in;
+
+    while( n < max && tail != ring->head )
+    {
+        in = &ring->buffer[ tail ];
+
+        out->x = TO_MG( in->x, 0 );
+        out->y = TO_MG( in->y, 1 );
+        out->z = TO_MG( in->z, 2 );
+        out++;
+        n++;
+
+        if( ++tail == ring->size )
+        {
+            tail = 0;
+        }
+    }
+
+    ring->tail = tail;
+
+    return n;
+}
@@ -72,6 +72,7 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include "adxl345_bus.h"
 
 /**
  *  @defgroup Registers 
@@ -164,6 +165,76 @@ Interrupt bit position
 #define ADXL345_NO_ERROR  0  // initial state
 #define ADXL345_READ_ERROR 1 // problem reading accel
 #define ADXL345_BAD_ARG  2   // bad method argument
+#define ADXL345_NO_BUS   3   // no transport set
+
+/**
+ *  @defgroup FIFO_Modes
+ *  @{
+ */
+#define ADXL345_FIFO_BYPASS  0x00 /**< FIFO is bypassed */
+#define ADXL345_FIFO_FIFO    0x01 /**< Collects up to 32 samples then stops */
+#define ADXL345_FIFO_STREAM  0x02 /**< Holds the last 32 samples, oldest dropped */
+#define ADXL345_FIFO_TRIGGER 0x03 /**< Holds samples around a trigger event */
+/**@}*/
+
+#define ADXL345_FIFO_SIZE    32   // Entries in hardware FIFO
+#define ADXL345_CACHE_SIZE   28   // Cached registers THRESH_TAP .. FIFO_CTL
+
+/**
+ *  @struct One xyz sample as read from the data registers
+ */
+typedef struct
+{
+    int16_t x;
+    int16_t y;
+    int16_t z;
+} adxl345_sample_t;
+
+/**
+ *  @struct Ring of samples filled by adxl345_fifo_drain
+ *
+ *  Storage is supplied by the caller.  One slot is kept free to tell a
+ *  full ring from an empty one.
+ */
+typedef struct
+{
+    adxl345_sample_t* buffer;   /**< Caller supplied storage */
+    uint8_t size;               /**< Number of slots in buffer */
+    volatile uint8_t head;      /**< Write index */
+    volatile uint8_t tail;      /**< Read index */
+    uint16_t overflow;          /**< Samples dropped because ring was full */
+} adxl345_ring_t;
+
+/**
+ *  @struct State of one sensor
+ *
+ *  Every driver function works on the sensor picked by adxl345_select.
+ *  Each sensor has its own transport, on I2C one per SDO address
+ *  (ADXL345_I2C_ADDRESS, ADXL345_I2C_ADDRESS_ALT), on SPI one per chip
+ *  select.  The fields are private to the driver.
+ */
+typedef struct
+{
+    adxl345_bus_t* bus;                 /**< Transport */
+    uint8_t buff[6];                    /**< Data register burst */
+    bool status;                        /**< ADXL345_OK or ADXL345_ERROR */
+    int error_code;                     /**< Cause of the last error */
+    double gains[3];                    /**< Counts to g */
+
+    uint16_t scale[3];                  /**< mg/LSB at full resolution, Q12 */
+    int16_t bias[3];                    /**< mg */
+    uint8_t conv_shift;                 /**< Range shift in 10-bit mode */
+
+    uint8_t reg_cache[ ADXL345_CACHE_SIZE ];
+    uint32_t cache_valid;               /**< Bit set when reg_cache holds the device value */
+    uint32_t cache_dirty;               /**< Bit set when reg_cache waits for a commit */
+    uint8_t batch_depth;                /**< Nesting of adxl345_batch_begin */
+    uint32_t bus_transactions;          /**< Bus transactions issued */
+
+    uint8_t async_buff[6];
+    adxl345_sample_t async_sample;
+    void ( *async_done )( adxl345_sample_t* sample );
+} adxl345_t;
 
 /**
  *  @defgroup General_Use_Functions
@@ -172,13 +243,84 @@ Interrupt bit position
 
 /**
  *  @ingroup General_Use_Functions
- *  @brief Initializes the Sensor
+ *  @brief Initializes the selected Sensor
  *
- *  @pre TWI_Init needs to be called before.
+ *  @pre TWI_Init needs to be called before when the default I2C
+ *  transport is used.
  *
  */
 void adxl345_init( void );
 
+/**
+ *  @brief Sets the transport the driver talks through
+ *
+ *  Call before adxl345_init.  Without it the driver uses I2C at
+ *  ADXL345_I2C_ADDRESS.
+ *
+ *  @param bus - transport set up by one of the adxl345_bus_*_init functions
+ */
+void adxl345_setBus( adxl345_bus_t* bus );
+
+/**
+ *  @brief Sets up a further sensor and selects it
+ *
+ *  Clears dev, sets its transport and runs adxl345_init on it.  A sensor
+ *  used without adxl345_open is the built in default one.
+ *
+ *  @code
+ *  adxl345_bus_i2c_init( &bus_a, ADXL345_I2C_ADDRESS );      // ALT ADDRESS high
+ *  adxl345_bus_i2c_init( &bus_b, ADXL345_I2C_ADDRESS_ALT );  // ALT ADDRESS low
+ *  adxl345_open( &accel_a, &bus_a );
+ *  adxl345_open( &accel_b, &bus_b );
+ *  @endcode
+ *
+ *  @param[out] dev - sensor state
+ *  @param bus - transport of this sensor
+ */
+void adxl345_open( adxl345_t* dev, adxl345_bus_t* bus );
+
+/**
+ *  @brief Picks the sensor all other functions work on
+ *
+ *  @param dev - sensor set up by adxl345_open, NULL for the default one
+ *
+ *  @returns adxl345_t* - sensor selected before, to restore it
+ */
+adxl345_t* adxl345_select( adxl345_t* dev );
+
+/**
+ *  @brief Sensor currently selected
+ */
+adxl345_t* adxl345_selected( void );
+
+/**
+ *  @brief Reads one sample from each of several sensors
+ *
+ *  The data registers of all sensors are read back to back, one burst
+ *  each, so the samples are taken within the same short window.  The
+ *  selection is left unchanged.
+ *
+ *  @param devs - sensors, in read order
+ *  @param count - number of sensors
+ *  @param[out] samples - one sample per sensor, same order as devs
+ */
+void adxl345_read_group( adxl345_t** devs, uint8_t count, adxl345_sample_t* samples );
+
+/**
+ *  @brief Starts reading one sample in the background
+ *
+ *  With an SPI transport and a DMA channel the call returns at once and
+ *  done runs from the DMA complete interrupt.  Other transports read
+ *  blocking and call done before returning.
+ *
+ *  @param done - called with the sample, the sample is only valid during the call
+ *
+ *  @returns bool
+ *    @retval true read started
+ *    @retval false previous read still running or no transport
+ */
+bool adxl345_readSampleAsync( void ( *done )( adxl345_sample_t* sample ) );
+
 /**
  *  @brief Reads the acceleration into an array of 3 ints
  *
@@ -202,6 +344,275 @@ void adxl345_readAccel( int* x, int* y, int* z );
  */
 void adxl345_get_Gxyz( double* xyz );
 
+/**
+ *  @brief Reads one sample as signed 16 bit counts
+ *
+ *  @param[out] sample - x, y and z counts
+ */
+void adxl345_readSample( adxl345_sample_t* sample );
+
+/**
+ *  @brief Reads a register
+ *
+ *  Writable registers come from the register cache.
+ *
+ *  @param reg - register address, see @ref Registers
+ *
+ *  @returns uint8_t - register value
+ */
+uint8_t adxl345_readRegister( uint8_t reg );
+
+/**
+ *  @brief Writes a register
+ *
+ *  Goes through the register cache, inside a batch the write is deferred
+ *  to adxl345_batch_commit.
+ *
+ *  @param reg - register address, see @ref Registers
+ *  @param val - value to write
+ */
+void adxl345_writeRegister( uint8_t reg, uint8_t val );
+
+/**@}*/
+
+/**
+ *  @defgroup FIFO_Functions
+ *  @{
+ */
+
+/**
+ *  @brief Configures the FIFO and its watermark interrupt
+ *
+ *  Sets mode and watermark, maps the watermark interrupt to the given pin
+ *  and enables it.  In trigger mode the trigger event is taken from the
+ *  same pin.
+ *
+ *  @param[in] mode - @ref FIFO_Modes
+ *  @param[in] watermark - number of entries (1 - 31) that raises WATERMARK
+ *  @param[in] interruptPin - ADXL345_INT1_PIN or ADXL345_INT2_PIN
+ *
+ *  @code
+ *  adxl345_set_bw( ADXL345_BW_400 );
+ *  adxl345_fifo_init( ADXL345_FIFO_STREAM, 24, ADXL345_INT2_PIN );
+ *  @endcode
+ */
+void adxl345_fifo_init( uint8_t mode, uint8_t watermark, int interruptPin );
+
+/**
+ *  @brief Sets FIFO mode
+ *  @param[in] mode - @ref FIFO_Modes
+ */
+void adxl345_setFifoMode( uint8_t mode );
+
+/**
+ *  @brief Gets FIFO mode
+ *  @returns uint8_t - @ref FIFO_Modes
+ */
+uint8_t adxl345_getFifoMode( void );
+
+/**
+ *  @brief Sets the samples bits of FIFO_CTL
+ *
+ *  @param[in] samples - 0 - 31, watermark level in FIFO and stream mode,
+ *  samples kept before the trigger event in trigger mode
+ */
+void adxl345_setFifoSamples( uint8_t samples );
+
+/**
+ *  @brief Gets the samples bits of FIFO_CTL
+ */
+uint8_t adxl345_getFifoSamples( void );
+
+/**
+ *  @brief Selects which interrupt pin triggers trigger mode
+ *  @param[in] interruptPin - ADXL345_INT1_PIN or ADXL345_INT2_PIN
+ */
+void adxl345_setFifoTriggerPin( int interruptPin );
+
+/**
+ *  @brief Number of samples stored in the FIFO
+ *  @returns uint8_t - 0 - 32
+ */
+uint8_t adxl345_getFifoEntries( void );
+
+/**
+ *  @brief Gets the FIFO_TRIG bit
+ *  @returns bool
+ *      @retval 1 trigger event occurred
+ *      @retval 0 no trigger event
+ */
+bool adxl345_isFifoTriggered( void );
+
+/**
+ *  @brief Drains the FIFO into a ring buffer
+ *
+ *  FIFO_STATUS is read once and all entries present are read out back to
+ *  back, one 6 byte burst each.  Call when the watermark interrupt fires,
+ *  but not from the ISR itself as the bus is used.
+ *
+ *  @param[in,out] ring - destination, samples that do not fit are counted
+ *  in ring->overflow and dropped
+ *
+ *  @returns uint8_t - number of entries read from the FIFO
+ */
+uint8_t adxl345_fifo_drain( adxl345_ring_t* ring );
+
+/**
+ *  @brief Initializes a sample ring
+ *
+ *  @param[out] ring - ring to initialize
+ *  @param[in] buffer - array of size samples
+ *  @param[in] size - number of samples in buffer, at most 255
+ */
+void adxl345_ring_init( adxl345_ring_t* ring, adxl345_sample_t* buffer, uint8_t size );
+
+/**
+ *  @brief Takes the oldest sample from a ring
+ *
+ *  @returns bool
+ *      @retval 1 sample copied
+ *      @retval 0 ring empty
+ */
+bool adxl345_ring_get( adxl345_ring_t* ring, adxl345_sample_t* sample );
+
+/**
+ *  @brief Number of samples waiting in a ring
+ */
+uint8_t adxl345_ring_count( adxl345_ring_t* ring );
+
+/**@}*/
+
+/**
+ *  @defgroup Conversion_Functions
+ *  @{
+ *  Integer conversion of counts to milli-g.  Each axis has a scale in
+ *  mg/LSB at full resolution as Q12 (3.9 mg/LSB = 15974) and a bias in
+ *  mg.  In 10-bit mode the counts are shifted by the range first, so one
+ *  scale serves every range.  The product fits 32 bits and no floating
+ *  point code is linked.
+ *
+ *  Scale and shift follow adxl345_setRangeSetting and
+ *  adxl345_setFullResBit, the left justified format is not supported.
+ *  Converted samples reuse adxl345_sample_t with values in mg.
+ */
+
+#define ADXL345_SCALE_NOMINAL  15974  /**< 3.9 mg/LSB in Q12 */
+
+/**
+ *  @brief Derives the count shift from DATA_FORMAT
+ *
+ *  Called by adxl345_init, adxl345_setRangeSetting and
+ *  adxl345_setFullResBit.  Call it after writing DATA_FORMAT directly.
+ */
+void adxl345_conv_update( void );
+
+/**
+ *  @brief Sets per axis scale
+ *
+ *  @param[in] scale - array of 3, mg/LSB at full resolution in Q12
+ */
+void adxl345_setAxisScale( uint16_t* scale );
+
+/**
+ *  @brief Gets per axis scale
+ *
+ *  @param[out] scale - array of 3, mg/LSB at full resolution in Q12
+ */
+void adxl345_getAxisScale( uint16_t* scale );
+
+/**
+ *  @brief Sets per axis bias subtracted after scaling
+ *
+ *  @param[in] bias - array of 3, mg
+ */
+void adxl345_setAxisBias( int16_t* bias );
+
+/**
+ *  @brief Gets per axis bias
+ *
+ *  @param[out] bias - array of 3, mg
+ */
+void adxl345_getAxisBias( int16_t* bias );
+
+/**
+ *  @brief Reads one sample in milli-g
+ *
+ *  Integer replacement for adxl345_get_Gxyz.
+ *
+ *  @param[out] xyz - array of 3, mg
+ */
+void adxl345_get_mGxyz( int16_t* xyz );
+
+/**
+ *  @brief Converts samples from counts to milli-g in place
+ *
+ *  @param[in,out] samples - array of samples
+ *  @param count - number of samples
+ */
+void adxl345_convert_mg( adxl345_sample_t* samples, uint8_t count );
+
+/**
+ *  @brief Takes up to max samples from a ring converted to milli-g
+ *
+ *  @code
+ *  adxl345_fifo_drain( &ring );
+ *  n = adxl345_ring_get_mg( &ring, block, 32 );
+ *  @endcode
+ *
+ *  @returns uint8_t - number of samples stored in out
+ */
+uint8_t adxl345_ring_get_mg( adxl345_ring_t* ring, adxl345_sample_t* out, uint8_t max );
+
+/**@}*/
+
+/**
+ *  @defgroup Register_Cache
+ *  @{
+ *  The writable registers 0x1d - 0x38 are shadowed in RAM.  Reads of those
+ *  registers are served from the shadow and bit changes no longer need a
+ *  read-modify-write on the bus.  The shadow is loaded by adxl345_init.
+ */
+
+/**
+ *  @brief Starts a batch of configuration writes
+ *
+ *  Until adxl345_batch_commit is called, writes to shadowed registers
+ *  only change RAM.
+ *
+ *  @code
+ *  adxl345_batch_begin();
+ *  adxl345_setTapThreshold( 50 );
+ *  adxl345_setTapDuration( 15 );
+ *  adxl345_setInterrupt( ADXL345_INT_SINGLE_TAP_BIT, 1 );
+ *  adxl345_batch_commit();      // one burst plus one INT_ENABLE write
+ *  @endcode
+ */
+void adxl345_batch_begin( void );
+
+/**
+ *  @brief Writes all registers changed since adxl345_batch_begin
+ *
+ *  Changed registers go out as multi-byte burst writes, POWER_CTL and
+ *  INT_ENABLE are written last.
+ */
+void adxl345_batch_commit( void );
+
+/**
+ *  @brief Drops the register shadow
+ *
+ *  Call after the sensor was power cycled or written by other means.
+ */
+void adxl345_cache_invalidate( void );
+
+/**
+ *  @brief Number of bus transactions issued since last reset
+ */
+uint32_t adxl345_getBusTransactions( void );
+
+/**
+ *  @brief Resets bus transaction counter
+ */
+void adxl345_resetBusTransactions( void );
 /**@}*/
 
 /**
@@ -225,7 +636,13 @@ uint8_t adxl345_getTapThreshold( void );
 
 /**
  *  @brief Set the axis gain
- *  @param[in,out] _gains - 
+ *
+ *  Sets the milli-g scale of each axis as well, so call it after the
+ *  range and resolution are set.  Scales above 16 mg per full
+ *  resolution count are clamped.
+ *
+ *  @param[in] _gains - array of 3, g per count in the current range and
+ *  resolution
  */
 void adxl345_setAxisGains( double *_gains );
 
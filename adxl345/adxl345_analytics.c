@@ -0,0 +1,252 @@
+#include <stddef.h>
+#include <string.h>
+#include "adxl345_analytics.h"
+
+#define CORDIC_STEPS  15
+#define CORDIC_SHIFT  14          // inputs scaled up, room for a gain of 1.65
+#define CORDIC_INV_K  19898       // 1 / 1.64676 in Q15
+#define DEG_180       180000L     // millidegrees
+
+#define STEP_WINDOW_S 1           // threshold window, seconds
+#define STEP_MIN_S    5           // 0.2 s between steps at least, 1 / x
+#define STEP_MAX_S    2           // 2 s between steps at most
+
+#define AXIS( s, a )  ( ( &( s )->x )[a] )
+
+// atan( 2^-i ) in millidegrees
+static const int32_t cordic_angle[ CORDIC_STEPS ] =
+{
+    45000, 26565, 14036, 7125, 3576, 1790, 895, 448,
+    224, 112, 56, 28, 14, 7, 3
+};
+
+//private:
+static int32_t cordic( int32_t* x, int32_t y );
+static uint16_t uabs( int16_t v );
+
+// Vectoring mode, turns ( x, y ) onto the positive x axis.  Returns the
+// angle turned in millidegrees, x ends up as the length times 1.64676.
+static int32_t cordic( int32_t* px, int32_t y )
+{
+    int32_t x = *px, t, angle = 0;
+    uint8_t i;
+
+    if( x < 0 )
+    {
+        angle = ( y < 0 ) ? -DEG_180 : DEG_180;
+        x = -x;
+        y = -y;
+    }
+
+    for( i = 0; i < CORDIC_STEPS; i++ )
+    {
+        t = x;
+
+        if( y > 0 )
+        {
+            x += y >> i;
+            y -= t >> i;
+            angle += cordic_angle[i];
+        }
+        else
+        {
+            x -= y >> i;
+            y += t >> i;
+            angle -= cordic_angle[i];
+        }
+    }
+
+    *px = x;
+    return angle;
+}
+
+static uint16_t uabs( int16_t v )
+{
+    return ( v < 0 ) ? ( uint16_t )-v : ( uint16_t )v;
+}
+
+int16_t adxl345_atan2( int16_t y, int16_t x )
+{
+    int32_t cx = ( int32_t )x << CORDIC_SHIFT;
+    int32_t angle = cordic( &cx, ( int32_t )y << CORDIC_SHIFT );
+
+    angle += ( angle < 0 ) ? -5 : 5;
+    return ( int16_t )( angle / 10 );
+}
+
+// Roll from ( z, y ).  The length of that turn is scaled back by 1 / K
+// and used as x of the pitch turn.
+void adxl345_tilt( adxl345_sample_t* sample, adxl345_tilt_t* tilt )
+{
+    int32_t x = ( int32_t )sample->z << CORDIC_SHIFT;
+    int32_t angle;
+
+    angle = cordic( &x, ( int32_t )sample->y << CORDIC_SHIFT );
+    tilt->roll = ( int16_t )( ( angle + ( ( angle < 0 ) ? -5 : 5 ) ) / 10 );
+
+    x = ( x >> 15 ) * CORDIC_INV_K + ( ( ( x & 0x7FFF ) * CORDIC_INV_K ) >> 15 );
+    angle = cordic( &x, -( ( int32_t )sample->x << CORDIC_SHIFT ) );
+    tilt->pitch = ( int16_t )( ( angle + ( ( angle < 0 ) ? -5 : 5 ) ) / 10 );
+}
+
+uint16_t adxl345_magnitude( adxl345_sample_t* sample )
+{
+    uint16_t a = uabs( sample->x ), b = uabs( sample->y ), c = uabs( sample->z ), t;
+
+    // a >= b >= c
+    if( a < b ) { t = a; a = b; b = t; }
+    if( b < c ) { t = b; b = c; c = t; }
+    if( a < b ) { t = a; a = b; b = t; }
+
+    return ( uint16_t )( ( 30UL * a + 13UL * b + 9UL * c ) >> 5 );
+}
+
+void adxl345_orient_init( adxl345_orient_t* o, int16_t hysteresis, uint8_t debounce )
+{
+    o->face       = ADXL345_FACE_UNKNOWN;
+    o->candidate  = ADXL345_FACE_UNKNOWN;
+    o->count      = 0;
+    o->debounce   = debounce ? debounce : 1;
+    o->hysteresis = hysteresis;
+}
+
+// The strongest axis is the candidate.  It has to beat the component
+// along the current face by the hysteresis for debounce samples in a row.
+bool adxl345_orient_process( adxl345_orient_t* o, adxl345_sample_t* in, uint8_t count )
+{
+    uint8_t a, axis, face;
+    int16_t v, current;
+    bool changed = false;
+
+    while( count-- )
+    {
+        axis = 0;
+        for( a = 1; a < 3; a++ )
+        {
+            if( uabs( AXIS( in, a ) ) > uabs( AXIS( in, axis ) ) )
+                axis = a;
+        }
+
+        v = AXIS( in, axis );
+        face = axis * 2 + ( ( v < 0 ) ? 1 : 0 );
+
+        if( face == o->face )
+        {
+            o->count = 0;
+        }
+        else
+        {
+            current = 0;
+            if( o->face != ADXL345_FACE_UNKNOWN )
+            {
+                current = AXIS( in, o->face / 2 );
+                if( o->face & 1 )
+                    current = -current;
+            }
+
+            if( ( int32_t )uabs( v ) - current <= o->hysteresis )
+            {
+                o->count = 0;
+            }
+            else
+            {
+                if( face != o->candidate )
+                {
+                    o->candidate = face;
+                    o->count = 0;
+                }
+
+                if( ++o->count >= o->debounce )
+                {
+                    o->face  = face;
+                    o->count = 0;
+                    changed  = true;
+                }
+            }
+        }
+
+        in++;
+    }
+
+    return changed;
+}
+
+int adxl345_pedometer_init( adxl345_pedometer_t* p, uint8_t rate, uint16_t sensitivity )
+{
+    if( rate < 10 || rate > 100 )
+        return -1;
+
+    memset( p, 0, sizeof( adxl345_pedometer_t ) );
+    p->window      = rate * STEP_WINDOW_S;
+    p->min_gap     = rate / STEP_MIN_S;
+    p->max_gap     = rate * STEP_MAX_S;
+    p->sensitivity = sensitivity;
+    p->min         = 0xFFFF;
+    p->since       = 0xFF;
+
+    return 0;
+}
+
+// Smoothed magnitude against the middle of the previous window.  A step
+// is a downward crossing at least min_gap after the last one.  Steps more
+// than max_gap apart start over, the first ADXL345_STEP_REGULATE of a
+// walk are only counted once they turn out regular.
+uint8_t adxl345_pedometer_process( adxl345_pedometer_t* p, adxl345_sample_t* in,
+                                   uint8_t count )
+{
+    uint16_t m;
+    uint8_t n = 0;
+
+    while( count-- )
+    {
+        m = adxl345_magnitude( in++ );
+
+        p->sum -= p->history[ p->index ];
+        p->sum += m;
+        p->history[ p->index ] = m;
+        p->index = ( p->index + 1 ) & ( ADXL345_STEP_SMOOTH - 1 );
+        m = p->sum / ADXL345_STEP_SMOOTH;
+
+        if( m > p->max ) p->max = m;
+        if( m < p->min ) p->min = m;
+
+        if( ++p->filled == p->window )
+        {
+            p->threshold = ( p->max + p->min ) / 2;
+            p->valid     = ( p->max - p->min ) >= p->sensitivity;
+            p->max       = 0;
+            p->min       = 0xFFFF;
+            p->filled    = 0;
+        }
+
+        if( p->since < 0xFF )
+            p->since++;
+
+        if( p->since > p->max_gap )
+            p->pending = 0;
+
+        if( p->valid && p->prev > p->threshold && m <= p->threshold
+            && p->since >= p->min_gap )
+        {
+            p->since = 0;
+
+            if( p->pending < ADXL345_STEP_REGULATE )
+            {
+                if( ++p->pending == ADXL345_STEP_REGULATE )
+                {
+                    p->steps += ADXL345_STEP_REGULATE;
+                    n += ADXL345_STEP_REGULATE;
+                }
+            }
+            else
+            {
+                p->steps++;
+                n++;
+            }
+        }
+
+        p->prev = m;
+    }
+
+    return n;
+}
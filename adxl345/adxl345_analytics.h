@@ -0,0 +1,171 @@
+/**
+ * @file adxl345_analytics.h
+ *
+ * @brief Tilt, orientation and step counting on integer samples
+ *
+ * Works on blocks of raw samples as they come from the FIFO, the ring or
+ * a filter stage, without floating point.  Angles come from a CORDIC
+ * atan2 of shifts and adds, magnitude from a weighted sum of the sorted
+ * axes.  Orientation changes only after a margin and a number of agreeing
+ * samples, so a board held near 45 degrees does not toggle.  The
+ * pedometer counts crossings of a dynamic threshold of the magnitude and
+ * only commits steps once they come at a regular pace.
+ *
+ * @author Richard Lowe
+ * @copyright AlphaLoewe
+ *
+ * @date 18/10/2026
+ *
+ * @version .01 - Initial
+ *
+ * @details
+ *
+ * Status: <XX% completed.>
+ *
+ * @note
+ * Test configuration:
+ *   MCU:             ATMega32
+ *   Dev.Board:       EasyAVR v7
+ *   Oscillator:      8Mhz
+ *   Ext. Modules:    x
+ *   SW:              MikroC v6.0
+ *
+ * @par
+ *   Angles are in 0.01 degree, within 0.02 degree of atan2 for inputs
+ *   of 16 or more counts.  The magnitude is within 6.3 % of the true
+ *   length, good for thresholds, not for measurement.  Thresholds are in
+ *   the unit of the samples, counts or mg after adxl345_convert_mg.
+ */
+
+#ifndef ADXL345_ANALYTICS_H
+#define ADXL345_ANALYTICS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "adxl345.h"
+
+/**
+ *  @defgroup Orientation_Faces
+ *  @{
+ *  Axis pointing up, same order as @ref Calibration_Orientation
+ */
+#define ADXL345_FACE_X_UP     0
+#define ADXL345_FACE_X_DOWN   1
+#define ADXL345_FACE_Y_UP     2
+#define ADXL345_FACE_Y_DOWN   3
+#define ADXL345_FACE_Z_UP     4
+#define ADXL345_FACE_Z_DOWN   5
+#define ADXL345_FACE_UNKNOWN  6
+/**@}*/
+
+#define ADXL345_STEP_SMOOTH    4   /**< Magnitude samples averaged, power of 2 */
+#define ADXL345_STEP_REGULATE  4   /**< Regular steps needed before counting */
+
+/**
+ *  @struct Tilt of one sample
+ */
+typedef struct
+{
+    int16_t roll;       /**< Around x, atan2( y, z ), 0.01 degree */
+    int16_t pitch;      /**< Around y, atan2( -x, sqrt( y y + z z ) ), 0.01 degree */
+} adxl345_tilt_t;
+
+/**
+ *  @struct Orientation detector
+ */
+typedef struct
+{
+    uint8_t face;           /**< Current face, @ref Orientation_Faces */
+    uint8_t candidate;      /**< Face waiting for debounce */
+    uint8_t count;          /**< Samples the candidate held */
+    uint8_t debounce;       /**< Samples a new face has to hold */
+    int16_t hysteresis;     /**< Margin over the current axis */
+} adxl345_orient_t;
+
+/**
+ *  @struct Pedometer
+ */
+typedef struct
+{
+    uint16_t steps;         /**< Steps counted */
+    uint16_t history[ ADXL345_STEP_SMOOTH ];
+    uint32_t sum;
+    uint8_t index;
+    uint16_t prev;          /**< Last smoothed magnitude */
+    uint16_t max, min;      /**< Extremes of the running window */
+    uint16_t threshold;     /**< Middle of the last window */
+    bool valid;             /**< Last window swung more than sensitivity */
+    uint8_t window;         /**< Samples per window */
+    uint8_t filled;         /**< Samples in the running window */
+    uint16_t sensitivity;   /**< Smallest swing of a step */
+    uint8_t min_gap;        /**< Samples between steps, lower bound */
+    uint8_t max_gap;        /**< Samples between steps, upper bound */
+    uint8_t since;          /**< Samples since the last step */
+    uint8_t pending;        /**< Steps seen while not yet regular */
+} adxl345_pedometer_t;
+
+/**
+ *  @brief atan2 by CORDIC
+ *
+ *  @returns int16_t - angle of ( x, y ), -18000 .. 18000 in 0.01 degree
+ */
+int16_t adxl345_atan2( int16_t y, int16_t x );
+
+/**
+ *  @brief Roll and pitch of one sample
+ */
+void adxl345_tilt( adxl345_sample_t* sample, adxl345_tilt_t* tilt );
+
+/**
+ *  @brief Approximate length of a sample
+ *
+ *  ( 30 max + 13 mid + 9 min ) / 32 of the absolute axis values.
+ */
+uint16_t adxl345_magnitude( adxl345_sample_t* sample );
+
+/**
+ *  @brief Sets up orientation detection
+ *
+ *  @param[out] o - detector, starts at ADXL345_FACE_UNKNOWN
+ *  @param hysteresis - how much the new axis has to exceed the current
+ *  one, e.g. 0.2 g in counts
+ *  @param debounce - samples the new face has to hold, 1 .. 255
+ */
+void adxl345_orient_init( adxl345_orient_t* o, int16_t hysteresis, uint8_t debounce );
+
+/**
+ *  @brief Runs orientation detection over a block
+ *
+ *  @returns bool
+ *    @retval true face changed, see o->face
+ *    @retval false face unchanged
+ */
+bool adxl345_orient_process( adxl345_orient_t* o, adxl345_sample_t* in, uint8_t count );
+
+/**
+ *  @brief Sets up the pedometer
+ *
+ *  @code
+ *  // 50 Hz after the CIC, full resolution counts
+ *  adxl345_pedometer_init( &pedo, 50, 40 );    // 0.16 g swing
+ *  @endcode
+ *
+ *  @param[out] p - pedometer, zero steps
+ *  @param rate - sample rate in Hz, 10 .. 100
+ *  @param sensitivity - smallest swing of the magnitude that is a step
+ *
+ *  @returns int
+ *    @retval 0 OK
+ *    @retval -1 rate out of range
+ */
+int adxl345_pedometer_init( adxl345_pedometer_t* p, uint8_t rate, uint16_t sensitivity );
+
+/**
+ *  @brief Runs the pedometer over a block
+ *
+ *  @returns uint8_t - steps committed by this block
+ */
+uint8_t adxl345_pedometer_process( adxl345_pedometer_t* p, adxl345_sample_t* in,
+                                   uint8_t count );
+
+#endif
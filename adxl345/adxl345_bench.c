@@ -0,0 +1,416 @@
+/**
+ * @file adxl345_bench.c
+ *
+ * @brief Host benchmark of the ADXL345 conversion and filter paths
+ *
+ * Runs the driver on the mock transport and compares the double gains of
+ * adxl345_get_Gxyz with the fixed point milli-g path: largest deviation
+ * over every count of each range, with the default gains and with gains
+ * set in 10-bit mode, and time per sample.  Each filter stage
+ * is run block wise over a synthetic 800 Hz signal and checked against a
+ * floating point model of the same filter.  The integer tilt and
+ * magnitude are compared with atan2 and sqrt over a grid of vectors, and
+ * the pedometer and orientation detector run on a synthetic walk.  Host
+ * timings are
+ * taken with a hardware FPU, on AVR every double multiply is a soft-float
+ * library call of several hundred cycles.  The fixed path time includes
+ * copying each block, as the conversion runs in place.
+ *
+ * @code
+ *   gcc -O2 -DADXL345_HOST -o adxl345_bench adxl345_bench.c adxl345.c adxl345_bus.c \
+ *       adxl345_filter.c adxl345_analytics.c -lm
+ *   adxl345_bench [samples]
+ * @endcode
+ *
+ * @author Richard Lowe
+ * @copyright AlphaLoewe
+ *
+ * @date 18/10/2026
+ *
+ * @version .01 - Initial
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include "adxl345.h"
+#include "adxl345_filter.h"
+#include "adxl345_analytics.h"
+
+#define BLOCK  ADXL345_FIFO_SIZE
+#define SIGNAL_LENGTH  8000       // 10 s at 800 Hz
+#define SIGNAL_RATE    800.0
+
+static adxl345_bus_t bus;
+static adxl345_mock_t mock;
+
+static volatile double sink_g;
+static volatile int16_t sink_mg;
+
+static adxl345_sample_t signal[ SIGNAL_LENGTH ];
+static adxl345_sample_t filtered[ SIGNAL_LENGTH ];
+static double model[ SIGNAL_LENGTH ];
+
+static double seconds( clock_t start )
+{
+    return ( double )( clock() - start ) / CLOCKS_PER_SEC;
+}
+
+// Largest difference between both paths over all counts of one setting
+static double max_error( int range, bool full_res )
+{
+    double gains[3];
+    double err, worst = 0;
+    int shift, limit, raw, i;
+    adxl345_sample_t s;
+
+    adxl345_setFullResBit( full_res );
+    adxl345_setRangeSetting( range );
+    adxl345_getAxisGains( gains );
+
+    for( shift = 0; !full_res && ( 2 << shift ) < range; shift++ )
+        ;
+    limit = full_res ? range * 256 : 512;
+
+    for( raw = -limit; raw < limit; raw++ )
+    {
+        s.x = s.y = s.z = raw;
+        adxl345_convert_mg( &s, 1 );
+
+        for( i = 0; i < 3; i++ )
+        {
+            err = ( &s.x )[i] - raw * gains[i] * ( 1 << shift ) * 1000.0;
+            if( err < 0 )
+                err = -err;
+            if( err > worst )
+                worst = err;
+        }
+    }
+
+    return worst;
+}
+
+// Gains set in a 10-bit range are per count of that range, the milli-g
+// path has to match raw * gain over all counts
+static double gain_error( int range, double gain )
+{
+    double gains[3], saved[3];
+    uint16_t scale[3];
+    double err, worst = 0;
+    int raw, i;
+    adxl345_sample_t s;
+
+    adxl345_getAxisGains( saved );
+    adxl345_getAxisScale( scale );
+
+    adxl345_setFullResBit( false );
+    adxl345_setRangeSetting( range );
+    gains[0] = gains[1] = gains[2] = gain;
+    adxl345_setAxisGains( gains );
+
+    for( raw = -512; raw < 512; raw++ )
+    {
+        s.x = s.y = s.z = raw;
+        adxl345_convert_mg( &s, 1 );
+
+        for( i = 0; i < 3; i++ )
+        {
+            err = fabs( ( &s.x )[i] - raw * gain * 1000.0 );
+            if( err > worst )
+                worst = err;
+        }
+    }
+
+    adxl345_setAxisGains( saved );
+    adxl345_setAxisScale( scale );
+
+    return worst;
+}
+
+// 5 Hz motion, 120 Hz vibration and noise, on each axis with an offset
+static void make_signal()
+{
+    int n, a;
+    double t;
+
+    srand( 2 );
+    for( n = 0; n < SIGNAL_LENGTH; n++ )
+    {
+        t = n / SIGNAL_RATE;
+        for( a = 0; a < 3; a++ )
+        {
+            ( &signal[n].x )[a] = ( int16_t )( 256 * ( a == 2 ) + 400 * sin( 2 * M_PI * 5 * t + a )
+                                  + 100 * sin( 2 * M_PI * 120 * t ) + rand() % 41 - 20 );
+        }
+    }
+}
+
+// Largest difference of one axis of filtered against model
+static double compare( int count, int axis, int* rms_out )
+{
+    int n;
+    double d, worst = 0, sq = 0;
+
+    for( n = 0; n < count; n++ )
+    {
+        d = fabs( ( &filtered[n].x )[axis] - model[n] );
+        sq += d * d;
+        if( d > worst )
+            worst = d;
+    }
+
+    *rms_out = ( int )( sqrt( sq / count ) * 1000 );
+    return worst;
+}
+
+static void report( const char* name, int count, int axis, double t )
+{
+    int rms;
+    double worst = compare( count, axis, &rms );
+
+    printf( "%-14s %5d out  max %5.2f LSB  rms %5.3f LSB  %7.2f ns/sample\n",
+            name, count, worst, rms / 1000.0, t * 1e9 / SIGNAL_LENGTH );
+}
+
+// Runs process block wise, as a FIFO drain would deliver the samples
+#define RUN( call, count ) \
+    do { int _n; clock_t _s = clock(); count = 0; \
+         for( _n = 0; _n < SIGNAL_LENGTH; _n += BLOCK ) \
+             count += call; \
+         t = seconds( _s ); } while( 0 )
+
+static void bench_filters( int axis_model )
+{
+    static const int16_t lp[5] = ADXL345_LP_FS_16;
+    adxl345_biquad_t bq;
+    adxl345_ma_t ma;
+    adxl345_cic_t cic;
+    double b[5], x1, x2, y1, y2, acc, st[ ADXL345_CIC_MAX ][ 16 ];
+    int n, i, s, a, count, order = 3, ratio = 16, length = 8;
+    double t;
+
+    printf( "\nstage          output vs float model, %d samples\n", SIGNAL_LENGTH );
+
+    // biquad, float model uses the same quantized coefficients
+    adxl345_biquad_init( &bq, lp );
+    RUN( ( adxl345_biquad_process( &bq, &signal[_n], &filtered[_n], BLOCK ), BLOCK ), count );
+
+    for( i = 0; i < 5; i++ )
+        b[i] = lp[i] / 16384.0;
+
+    for( a = 0; a < 3; a++ )
+    {
+        x1 = x2 = y1 = y2 = 0;
+        for( n = 0; n < SIGNAL_LENGTH; n++ )
+        {
+            acc = b[0] * ( &signal[n].x )[a] + b[1] * x1 + b[2] * x2 - b[3] * y1 - b[4] * y2;
+            x2 = x1; x1 = ( &signal[n].x )[a];
+            y2 = y1; y1 = acc;
+            if( a == axis_model )
+                model[n] = acc;
+        }
+    }
+    report( "biquad fs/16", count, axis_model, t );
+
+    // moving average
+    adxl345_ma_init( &ma, length );
+    RUN( ( adxl345_ma_process( &ma, &signal[_n], &filtered[_n], BLOCK ), BLOCK ), count );
+
+    for( n = 0; n < SIGNAL_LENGTH; n++ )
+    {
+        acc = 0;
+        for( i = 0; i < length && i <= n; i++ )
+            acc += ( &signal[ n - i ].x )[ axis_model ];
+        model[n] = acc / length;
+    }
+    report( "moving avg 8", count, axis_model, t );
+
+    // CIC, model is N cascaded moving sums of R taken every R-th sample
+    adxl345_cic_init( &cic, order, 4 );
+    RUN( adxl345_cic_process( &cic, &signal[_n], &filtered[ count ], BLOCK ), count );
+
+    for( s = 0; s < order; s++ )
+        for( i = 0; i < ratio; i++ )
+            st[s][i] = 0;
+
+    i = 0;
+    for( n = 0; n < SIGNAL_LENGTH; n++ )
+    {
+        acc = ( &signal[n].x )[ axis_model ];
+        for( s = 0; s < order; s++ )
+        {
+            st[s][ n % ratio ] = acc;
+            acc = 0;
+            for( a = 0; a < ratio; a++ )
+                acc += st[s][a];
+        }
+        if( n % ratio == ratio - 1 )
+            model[ i++ ] = acc / ( ratio * ratio * ratio );
+    }
+    report( "CIC 3 / 16", count, axis_model, t );
+}
+
+// Integer tilt and magnitude against libm, then a 2 Hz walk at 50 Hz
+// that turns the board from lying flat onto its side halfway
+static void bench_analytics()
+{
+    static adxl345_sample_t grid[ 4096 ], walk[ 1500 ];
+    adxl345_tilt_t tilt;
+    adxl345_orient_t orient;
+    adxl345_pedometer_t pedo;
+    double d, err_a = 0, err_t = 0, err_m = 0, t_int, t_float, f;
+    clock_t start;
+    int n, r, changes = 0;
+
+    srand( 3 );
+    for( n = 0; n < 4096; n++ )
+    {
+        do
+        {
+            grid[n].x = rand() % 8192 - 4096;
+            grid[n].y = rand() % 8192 - 4096;
+            grid[n].z = rand() % 8192 - 4096;
+        } while( abs( grid[n].x ) < 16 && abs( grid[n].y ) < 16 );
+    }
+
+    for( n = 0; n < 4096; n++ )
+    {
+        d = fabs( adxl345_atan2( grid[n].y, grid[n].x ) / 100.0
+                  - atan2( grid[n].y, grid[n].x ) * 180 / M_PI );
+        if( d > 180 )
+            d = 360 - d;
+        if( d > err_a )
+            err_a = d;
+
+        adxl345_tilt( &grid[n], &tilt );
+        f = atan2( -grid[n].x, hypot( grid[n].y, grid[n].z ) ) * 180 / M_PI;
+        d = fabs( tilt.pitch / 100.0 - f );
+        if( d > err_t )
+            err_t = d;
+
+        f = sqrt( ( double )grid[n].x * grid[n].x + ( double )grid[n].y * grid[n].y
+                  + ( double )grid[n].z * grid[n].z );
+        d = fabs( adxl345_magnitude( &grid[n] ) / f - 1 );
+        if( d > err_m )
+            err_m = d;
+    }
+
+    start = clock();
+    for( r = 0; r < 100; r++ )
+        for( n = 0; n < 4096; n++ )
+        {
+            adxl345_tilt( &grid[n], &tilt );
+            sink_mg = tilt.pitch + adxl345_magnitude( &grid[n] );
+        }
+    t_int = seconds( start );
+
+    start = clock();
+    for( r = 0; r < 100; r++ )
+        for( n = 0; n < 4096; n++ )
+        {
+            sink_g = atan2( grid[n].y, grid[n].z )
+                     + atan2( -grid[n].x, hypot( grid[n].y, grid[n].z ) )
+                     + sqrt( ( double )grid[n].x * grid[n].x + ( double )grid[n].y * grid[n].y
+                             + ( double )grid[n].z * grid[n].z );
+        }
+    t_float = seconds( start );
+
+    printf( "\natan2          max error %.3f deg\n", err_a );
+    printf( "pitch          max error %.3f deg\n", err_t );
+    printf( "magnitude      max error %.2f %%\n", err_m * 100 );
+    printf( "tilt + magnitude  integer %6.2f ns/sample, double %6.2f ns/sample\n",
+            t_int * 1e9 / 409600, t_float * 1e9 / 409600 );
+
+    for( n = 0; n < 1500; n++ )
+    {
+        f = 60 * sin( 2 * M_PI * 2 * n / 50.0 ) + rand() % 21 - 10;
+        walk[n].x = ( int16_t )( rand() % 21 - 10 );
+        walk[n].y = ( int16_t )( ( n < 750 ) ? f / 4 : 256 + f );
+        walk[n].z = ( int16_t )( ( n < 750 ) ? 256 + f : f / 4 );
+    }
+
+    adxl345_pedometer_init( &pedo, 50, 40 );
+    adxl345_orient_init( &orient, 51, 10 );
+    for( n = 0; n < 1500; n += 30 )
+    {
+        adxl345_pedometer_process( &pedo, &walk[n], 30 );
+        changes += adxl345_orient_process( &orient, &walk[n], 30 );
+    }
+
+    printf( "walk 30 s at 2 Hz  %u steps, %d orientation changes, face %u\n",
+            pedo.steps, changes, orient.face );
+}
+
+int main( int argc, char** argv )
+{
+    long samples = ( argc > 1 ) ? atol( argv[1] ) : 1000000L;
+    static adxl345_sample_t raw[ BLOCK ], work[ BLOCK ];
+    double gains[3];
+    double t_double, t_fixed;
+    clock_t start;
+    long n;
+    int i, range;
+
+    adxl345_bus_mock_init( &bus, &mock );
+    adxl345_setBus( &bus );
+    adxl345_init();
+
+    printf( "range  mode      max error\n" );
+    for( range = 2; range <= 16; range *= 2 )
+    {
+        printf( "+-%-4d 10-bit    %.2f mg\n", range, max_error( range, false ) );
+        printf( "+-%-4d full res  %.2f mg\n", range, max_error( range, true ) );
+    }
+
+    printf( "\ngains set in 10-bit mode, datasheet typical\n" );
+    for( range = 4; range <= 16; range *= 2 )
+    {
+        printf( "+-%-4d 10-bit    %.2f mg at %.1f mg/LSB\n", range,
+                gain_error( range, 0.0039 * range / 2 ), 3.9 * range / 2 );
+    }
+
+    srand( 1 );
+    for( i = 0; i < BLOCK; i++ )
+    {
+        raw[i].x = rand() % 1024 - 512;
+        raw[i].y = rand() % 1024 - 512;
+        raw[i].z = rand() % 1024 - 512;
+    }
+
+    adxl345_getAxisGains( gains );
+
+    start = clock();
+    for( n = 0; n < samples; n += BLOCK )
+    {
+        for( i = 0; i < BLOCK; i++ )
+        {
+            sink_g = raw[i].x * gains[0];
+            sink_g = raw[i].y * gains[1];
+            sink_g = raw[i].z * gains[2];
+        }
+    }
+    t_double = seconds( start );
+
+    start = clock();
+    for( n = 0; n < samples; n += BLOCK )
+    {
+        for( i = 0; i < BLOCK; i++ )
+            work[i] = raw[i];
+
+        adxl345_convert_mg( work, BLOCK );
+        sink_mg = work[ BLOCK - 1 ].z;
+    }
+    t_fixed = seconds( start );
+
+    printf( "\n%ld samples\n", samples );
+    printf( "double gains  %8.2f ns/sample\n", t_double * 1e9 / samples );
+    printf( "fixed mg      %8.2f ns/sample\n", t_fixed * 1e9 / samples );
+    printf( "bus transactions %lu\n", ( unsigned long )mock.transactions );
+
+    make_signal();
+    bench_filters( 0 );
+    bench_analytics();
+
+    return 0;
+}
@@ -0,0 +1,250 @@
+#include <stddef.h>
+#include <string.h>
+#include "adxl345_bus.h"
+
+#define ACKNOWLEDGE 1
+#define NO_ACKNOWLEDGE 0
+
+#define REG_DEVID       0x00
+#define REG_BW_RATE     0x2c
+#define REG_INT_SOURCE  0x30
+
+// SPI transport whose DMA read is running, all SPI transports share the
+// one SPI peripheral and its chip selects
+static adxl345_bus_t* volatile spi_active;
+
+//private:
+static bool read_async_blocking( adxl345_bus_t* bus, uint8_t reg, uint8_t* buff, uint8_t num,
+                                 adxl345_done_t done );
+static void spi_write( adxl345_bus_t* bus, uint8_t reg, uint8_t* buff, uint8_t num );
+static void spi_read( adxl345_bus_t* bus, uint8_t reg, uint8_t* buff, uint8_t num );
+static bool spi_read_async( adxl345_bus_t* bus, uint8_t reg, uint8_t* buff, uint8_t num,
+                            adxl345_done_t done );
+static void mock_write( adxl345_bus_t* bus, uint8_t reg, uint8_t* buff, uint8_t num );
+static void mock_read( adxl345_bus_t* bus, uint8_t reg, uint8_t* buff, uint8_t num );
+
+// Backends without background transfers read and complete in one go
+static bool read_async_blocking( adxl345_bus_t* bus, uint8_t reg, uint8_t* buff, uint8_t num,
+                                 adxl345_done_t done )
+{
+    if( bus->busy )
+    {
+        return false;
+    }
+
+    bus->busy = true;
+    bus->read( bus, reg, buff, num );
+    bus->busy = false;
+
+    if( done != NULL )
+    {
+        done( bus, buff, num );
+    }
+
+    return true;
+}
+
+#ifndef ADXL345_HOST
+// Writes num bytes starting at reg, register address auto increments
+static void i2c_write( adxl345_bus_t* bus, uint8_t reg, uint8_t* buff, uint8_t num )
+{
+    TWI_Start();              // issue I2C start signal
+    TWI_Write( bus->address );  // send byte via I2C  (device address + W)
+    TWI_Write( reg );         // send byte (address of the location)
+
+    while( num-- )
+    {
+        TWI_Write( *buff++ );     // send data (data to be written)
+    }
+
+    TWI_Stop();               // issue I2C stop signal
+}
+
+// Reads num bytes starting at reg, last byte is not acknowledged
+static void i2c_read( adxl345_bus_t* bus, uint8_t reg, uint8_t* buff, uint8_t num )
+{
+    TWI_Start();              // issue I2C start signal
+    TWI_Write( bus->address );  // send byte via I2C (device address + W)
+    TWI_Write( reg );         // send byte (data address)
+
+    TWI_Start();              // issue I2C signal repeated start
+    TWI_Write( bus->address | 1 );  // send byte (device address + R)
+
+    while( num-- )
+    {
+        *buff++ = TWI_Read( num ? ACKNOWLEDGE : NO_ACKNOWLEDGE );
+    }
+
+    TWI_Stop();
+}
+
+void adxl345_bus_i2c_init( adxl345_bus_t* bus, uint8_t address )
+{
+    memset( bus, 0, sizeof( adxl345_bus_t ) );
+
+    bus->write      = i2c_write;
+    bus->read       = i2c_read;
+    bus->read_async = read_async_blocking;
+    bus->address    = address;
+}
+#endif
+
+// Command byte, then data.  MB is needed for more than one byte, without
+// it the register address does not increment.  Blocking transfers wait
+// for a running DMA read, they would drive CS and SPI under it.
+static void spi_write( adxl345_bus_t* bus, uint8_t reg, uint8_t* buff, uint8_t num )
+{
+    while( spi_active != NULL )
+        ;
+
+    bus->spi_select( true );
+    bus->spi_xfer( ( num > 1 ) ? ( reg | ADXL345_SPI_MB ) : reg );
+
+    while( num-- )
+    {
+        bus->spi_xfer( *buff++ );
+    }
+
+    bus->spi_select( false );
+}
+
+static void spi_read( adxl345_bus_t* bus, uint8_t reg, uint8_t* buff, uint8_t num )
+{
+    while( spi_active != NULL )
+        ;
+
+    bus->spi_select( true );
+    bus->spi_xfer( ( num > 1 ) ? ( reg | ADXL345_SPI_READ | ADXL345_SPI_MB )
+                               : ( reg | ADXL345_SPI_READ ) );
+
+    while( num-- )
+    {
+        *buff++ = bus->spi_xfer( 0x00 );
+    }
+
+    bus->spi_select( false );
+}
+
+// Whole read goes out as one DMA transfer, command byte first.  CS stays
+// low until adxl345_bus_complete.
+static bool spi_read_async( adxl345_bus_t* bus, uint8_t reg, uint8_t* buff, uint8_t num,
+                            adxl345_done_t done )
+{
+    if( bus->spi_dma == NULL || num > ADXL345_BUS_ASYNC_MAX )
+    {
+        return read_async_blocking( bus, reg, buff, num, done );
+    }
+
+    if( bus->busy || spi_active != NULL )
+    {
+        return false;
+    }
+
+    bus->busy  = true;
+    spi_active = bus;
+    bus->done  = done;
+    bus->dest  = buff;
+    bus->count = num;
+
+    memset( bus->dma_tx, 0, num + 1 );
+    bus->dma_tx[0] = ( num > 1 ) ? ( reg | ADXL345_SPI_READ | ADXL345_SPI_MB )
+                                 : ( reg | ADXL345_SPI_READ );
+
+    bus->spi_select( true );
+
+    if( !bus->spi_dma( bus->dma_tx, bus->dma_rx, num + 1 ) )
+    {
+        // channel refused, do it the slow way
+        bus->spi_select( false );
+        bus->busy  = false;
+        spi_active = NULL;
+        return read_async_blocking( bus, reg, buff, num, done );
+    }
+
+    return true;
+}
+
+void adxl345_bus_spi_init( adxl345_bus_t* bus, uint8_t ( *xfer )( uint8_t b ),
+                           void ( *select )( bool active ),
+                           bool ( *dma )( uint8_t* tx, uint8_t* rx, uint8_t len ) )
+{
+    memset( bus, 0, sizeof( adxl345_bus_t ) );
+
+    bus->write      = spi_write;
+    bus->read       = spi_read;
+    bus->read_async = spi_read_async;
+    bus->spi_xfer   = xfer;
+    bus->spi_select = select;
+    bus->spi_dma    = dma;
+}
+
+void adxl345_bus_complete( adxl345_bus_t* bus )
+{
+    if( !bus->busy )
+    {
+        return;
+    }
+
+    bus->spi_select( false );
+    memcpy( bus->dest, &bus->dma_rx[1], bus->count );
+    bus->busy  = false;
+    spi_active = NULL;
+
+    if( bus->done != NULL )
+    {
+        bus->done( bus, bus->dest, bus->count );
+    }
+}
+
+static void mock_write( adxl345_bus_t* bus, uint8_t reg, uint8_t* buff, uint8_t num )
+{
+    adxl345_mock_t* mock = ( adxl345_mock_t* )bus->user;
+
+    mock->transactions++;
+    mock->bytes += num;
+
+    while( num-- )
+    {
+        if( mock->on_write != NULL )
+            mock->on_write( mock->model, reg, *buff );
+        else
+            mock->regs[ reg & 0x3F ] = *buff;
+
+        buff++;
+        reg++;
+    }
+}
+
+static void mock_read( adxl345_bus_t* bus, uint8_t reg, uint8_t* buff, uint8_t num )
+{
+    adxl345_mock_t* mock = ( adxl345_mock_t* )bus->user;
+
+    mock->transactions++;
+    mock->bytes += num;
+
+    while( num-- )
+    {
+        if( mock->on_read != NULL )
+            *buff = mock->on_read( mock->model, reg );
+        else
+            *buff = mock->regs[ reg & 0x3F ];
+
+        buff++;
+        reg++;
+    }
+}
+
+void adxl345_bus_mock_init( adxl345_bus_t* bus, adxl345_mock_t* mock )
+{
+    memset( bus, 0, sizeof( adxl345_bus_t ) );
+    memset( mock, 0, sizeof( adxl345_mock_t ) );
+
+    mock->regs[ REG_DEVID ]      = 0xE5;
+    mock->regs[ REG_BW_RATE ]    = 0x0A;
+    mock->regs[ REG_INT_SOURCE ] = 0x02;
+
+    bus->write      = mock_write;
+    bus->read       = mock_read;
+    bus->read_async = read_async_blocking;
+    bus->user       = mock;
+}
@@ -0,0 +1,180 @@
+/**
+ * @file adxl345_bus.h
+ *
+ * @brief Transports for the ADXL345 driver
+ *
+ * The driver talks to the sensor only through an adxl345_bus_t.  Backends
+ * are provided for I2C (TWI), 4-wire SPI and a RAM mock for host builds.
+ * Every backend offers a blocking register read / write and a read that
+ * completes through a callback, which the SPI backend hands to a DMA
+ * channel when the application supplies one.
+ *
+ * @author Richard Lowe
+ * @copyright AlphaLoewe
+ *
+ * @date 18/10/2026
+ *
+ * @version .01 - Initial
+ *
+ * @details
+ *
+ * Status: <XX% completed.>
+ *
+ * @note
+ * Test configuration:
+ *   MCU:             ATMega32
+ *   Dev.Board:       EasyAVR v7
+ *   Oscillator:      8Mhz
+ *   Ext. Modules:    x
+ *   SW:              MikroC v6.0
+ *
+ * @par
+ *   SPI runs in mode 3 (CPOL = 1, CPHA = 1) at up to 5 MHz.  Leave the
+ *   SPI bit of DATA_FORMAT cleared for 4-wire mode.  A 6 byte sample takes
+ *   about 11 us at 5 MHz against about 600 us on 100 kHz I2C, which is
+ *   what makes 3200 Hz sampling possible.
+ *
+ * @par
+ *   While a DMA read runs, blocking SPI reads and writes, e.g. a register
+ *   cache miss or the event dispatcher, wait for adxl345_bus_complete, on
+ *   any SPI transport as they share the SPI lines.  A second read_async
+ *   returns false.  Blocking calls must not be made from an interrupt
+ *   that keeps the DMA complete interrupt from running.
+ */
+
+#ifndef ADXL345_BUS_H
+#define ADXL345_BUS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//#define ADXL345_HOST          // Host builds, no TWI, mock transport
+
+#define ADXL345_I2C_ADDRESS      0x3A  /**< 8 bit write address, SDO / ALT ADDRESS high */
+#define ADXL345_I2C_ADDRESS_ALT  0xA6  /**< 8 bit write address, SDO / ALT ADDRESS low */
+
+#define ADXL345_SPI_READ         0x80  /**< R/W bit of SPI command byte */
+#define ADXL345_SPI_MB           0x40  /**< Multi-byte bit of SPI command byte */
+
+#define ADXL345_BUS_ASYNC_MAX    8     /**< Largest read handled by read_async */
+
+typedef struct adxl345_bus_s adxl345_bus_t;
+
+/**
+ *  @brief Completion of an asynchronous read
+ *
+ *  @param bus - bus the read was issued on
+ *  @param buff - buffer passed to read_async, now holding the data
+ *  @param num - number of bytes read
+ */
+typedef void ( *adxl345_done_t )( adxl345_bus_t* bus, uint8_t* buff, uint8_t num );
+
+/**
+ *  @struct Transport used by the driver
+ *
+ *  Fill with one of the adxl345_bus_*_init functions, the members after
+ *  read_async belong to the backend.
+ */
+struct adxl345_bus_s
+{
+    /** Writes num bytes from register reg on, register address increments */
+    void ( *write )( adxl345_bus_t* bus, uint8_t reg, uint8_t* buff, uint8_t num );
+    /** Reads num bytes from register reg on, register address increments */
+    void ( *read )( adxl345_bus_t* bus, uint8_t reg, uint8_t* buff, uint8_t num );
+    /** Starts a read, done is called when buff holds the data.
+     *  Returns false while a previous read is still running */
+    bool ( *read_async )( adxl345_bus_t* bus, uint8_t reg, uint8_t* buff, uint8_t num,
+                          adxl345_done_t done );
+
+    uint8_t address;                    /**< I2C 8 bit write address */
+
+    uint8_t ( *spi_xfer )( uint8_t b );  /**< SPI byte exchange, e.g. SPI1_Read */
+    void ( *spi_select )( bool active ); /**< Drives CS, true pulls it low */
+    /** Optional, exchanges len bytes in the background.  The DMA complete
+     *  interrupt has to call adxl345_bus_complete */
+    bool ( *spi_dma )( uint8_t* tx, uint8_t* rx, uint8_t len );
+
+    volatile bool busy;                 /**< Asynchronous read running */
+    adxl345_done_t done;                /**< Pending completion */
+    uint8_t* dest;                      /**< Destination of pending read */
+    uint8_t count;                      /**< Bytes of pending read */
+    uint8_t dma_tx[ ADXL345_BUS_ASYNC_MAX + 1 ];
+    uint8_t dma_rx[ ADXL345_BUS_ASYNC_MAX + 1 ];
+
+    void* user;                         /**< Mock state, free for application use otherwise */
+    void* owner;                        /**< Driver handle of the running asynchronous read */
+};
+
+#ifndef ADXL345_HOST
+/**
+ *  @brief Sets up an I2C transport
+ *
+ *  @param[out] bus - transport to initialize
+ *  @param address - ADXL345_I2C_ADDRESS or ADXL345_I2C_ADDRESS_ALT
+ *
+ *  @pre TWI_Init needs to be called before.
+ *
+ *  @note
+ *   mikroC has no interrupt driven TWI, read_async completes before it
+ *   returns.
+ */
+void adxl345_bus_i2c_init( adxl345_bus_t* bus, uint8_t address );
+#endif
+
+/**
+ *  @brief Sets up a 4-wire SPI transport
+ *
+ *  @param[out] bus - transport to initialize
+ *  @param xfer - exchanges one byte on the SPI bus
+ *  @param select - drives chip select of the sensor
+ *  @param dma - starts a background transfer, NULL to read blocking
+ *
+ *  @code
+ *  void accel_cs( bool active ) { ACCEL_CS = !active; }
+ *
+ *  SPI1_Init_Advanced( _SPI_MASTER, _SPI_FCY_DIV2, _SPI_CLK_HI_TRAILING );
+ *  adxl345_bus_spi_init( &accel_bus, SPI1_Read, accel_cs, NULL );
+ *  adxl345_setBus( &accel_bus );
+ *  adxl345_init();
+ *  @endcode
+ */
+void adxl345_bus_spi_init( adxl345_bus_t* bus, uint8_t ( *xfer )( uint8_t b ),
+                           void ( *select )( bool active ),
+                           bool ( *dma )( uint8_t* tx, uint8_t* rx, uint8_t len ) );
+
+/**
+ *  @brief Finishes a background SPI transfer
+ *
+ *  Call from the DMA transfer complete interrupt.  Releases CS and calls
+ *  the completion of the read.
+ */
+void adxl345_bus_complete( adxl345_bus_t* bus );
+
+/**
+ *  @struct State of the mock transport
+ */
+typedef struct
+{
+    uint8_t regs[ 64 ];                 /**< Register file, indexed by address */
+    uint32_t transactions;              /**< Reads and writes issued */
+    uint32_t bytes;                     /**< Data bytes moved */
+    /** Optional, supplies the value of a register read, NULL reads regs */
+    uint8_t ( *on_read )( void* model, uint8_t reg );
+    /** Optional, sees every register written, NULL stores to regs */
+    void ( *on_write )( void* model, uint8_t reg, uint8_t val );
+    void* model;                        /**< Passed to on_read / on_write */
+} adxl345_mock_t;
+
+/**
+ *  @brief Sets up a mock transport on a register file in RAM
+ *
+ *  @param[out] bus - transport to initialize
+ *  @param mock - register file and counters, loaded with reset values
+ *
+ *  @note
+ *   Registers behave as plain memory unless hooks are set after init,
+ *   read_async completes immediately.
+ */
+void adxl345_bus_mock_init( adxl345_bus_t* bus, adxl345_mock_t* mock );
+
+#endif
@@ -0,0 +1,144 @@
+#include <stddef.h>
+#include "adxl345_calib.h"
+
+#define ONE_G          256         // counts at full resolution
+#define COUNTS_PER_OFS 4           // 15.6 mg / 3.9 mg
+#define CHECK_SEED     0xA5
+
+#define FORMAT_KEEP    0b01100000  // SPI and INT_INVERT bits stay as they are
+#define FORMAT_CAL     0b00001011  // FULL_RES, +-16g
+#define RATE_CAL       ADXL345_BW_100
+#define FIFO_CAL       ( ( ADXL345_FIFO_FIFO << 6 ) | 31 )
+#define MEASURE        0x08        // POWER_CTL measure bit
+
+//private:
+static uint8_t cal_check( adxl345_cal_t* cal );
+static int8_t to_offset( int32_t error, int32_t scale );
+
+static uint8_t cal_check( adxl345_cal_t* cal )
+{
+    return ~( uint8_t )( CHECK_SEED + ( uint8_t )cal->offset[0]
+                         + ( uint8_t )cal->offset[1] + ( uint8_t )cal->offset[2] );
+}
+
+// Summed counts off target to offset register steps, rounded once and
+// clamped.  scale is counts per step times number of samples.
+static int8_t to_offset( int32_t error, int32_t scale )
+{
+    int32_t ofs;
+
+    ofs = -( error + ( ( error < 0 ) ? -( scale / 2 ) : ( scale / 2 ) ) ) / scale;
+
+    if( ofs > 127 )
+        return 127;
+    if( ofs < -128 )
+        return -128;
+    return ( int8_t )ofs;
+}
+
+int adxl345_calibrate( uint8_t orientation, uint8_t samples, adxl345_cal_t* cal,
+                       void ( *wait )( void ) )
+{
+    uint8_t format, rate, fifo, int_enable, power, ofs[3];
+    uint8_t entries, settle, idle, taken, a;
+    int32_t sum[3], expect[3];
+    adxl345_sample_t s;
+
+    if( orientation > ADXL345_CAL_Z_DOWN || samples == 0 || cal == NULL )
+        return -1;
+
+    format     = adxl345_readRegister( ADXL345_DATA_FORMAT );
+    rate       = adxl345_readRegister( ADXL345_BW_RATE );
+    fifo       = adxl345_readRegister( ADXL345_FIFO_CTL );
+    int_enable = adxl345_readRegister( ADXL345_INT_ENABLE );
+    power      = adxl345_readRegister( ADXL345_POWER_CTL );
+    ofs[0]     = adxl345_readRegister( ADXL345_OFSX );
+    ofs[1]     = adxl345_readRegister( ADXL345_OFSY );
+    ofs[2]     = adxl345_readRegister( ADXL345_OFSZ );
+
+    // measure without old offsets, no interrupts, empty FIFO
+    adxl345_batch_begin();
+    adxl345_writeRegister( ADXL345_OFSX, 0 );
+    adxl345_writeRegister( ADXL345_OFSY, 0 );
+    adxl345_writeRegister( ADXL345_OFSZ, 0 );
+    adxl345_writeRegister( ADXL345_DATA_FORMAT, ( format & FORMAT_KEEP ) | FORMAT_CAL );
+    adxl345_writeRegister( ADXL345_BW_RATE, RATE_CAL );
+    adxl345_writeRegister( ADXL345_FIFO_CTL, ADXL345_FIFO_BYPASS << 6 );
+    adxl345_writeRegister( ADXL345_INT_ENABLE, 0 );
+    adxl345_writeRegister( ADXL345_POWER_CTL, MEASURE );
+    adxl345_batch_commit();
+    adxl345_writeRegister( ADXL345_FIFO_CTL, FIFO_CAL );
+
+    sum[0] = sum[1] = sum[2] = 0;
+    settle = ADXL345_CAL_SETTLE;
+    taken  = 0;
+    idle   = 0;
+
+    while( taken < samples && idle < ADXL345_CAL_MAX_IDLE )
+    {
+        entries = adxl345_getFifoEntries();
+
+        if( entries == 0 )
+        {
+            idle++;
+            if( wait != NULL )
+                wait();
+            continue;
+        }
+
+        idle = 0;
+        while( entries-- && taken < samples )
+        {
+            adxl345_readSample( &s );
+
+            if( settle )
+            {
+                settle--;
+                continue;
+            }
+
+            sum[0] += s.x;
+            sum[1] += s.y;
+            sum[2] += s.z;
+            taken++;
+        }
+    }
+
+    // restore, FIFO goes through bypass to drop what is left
+    adxl345_batch_begin();
+    adxl345_writeRegister( ADXL345_FIFO_CTL, ADXL345_FIFO_BYPASS << 6 );
+    adxl345_writeRegister( ADXL345_DATA_FORMAT, format );
+    adxl345_writeRegister( ADXL345_BW_RATE, rate );
+    adxl345_writeRegister( ADXL345_INT_ENABLE, int_enable );
+    adxl345_writeRegister( ADXL345_POWER_CTL, power );
+    adxl345_batch_commit();
+    adxl345_writeRegister( ADXL345_FIFO_CTL, fifo );
+
+    if( taken < samples )
+    {
+        adxl345_setAxisOffset( ( int8_t )ofs[0], ( int8_t )ofs[1], ( int8_t )ofs[2] );
+        return -2;
+    }
+
+    expect[0] = expect[1] = expect[2] = 0;
+    expect[ orientation / 2 ] = ( orientation & 1 ) ? -ONE_G : ONE_G;
+
+    for( a = 0; a < 3; a++ )
+    {
+        cal->offset[a] = to_offset( sum[a] - expect[a] * samples,
+                                    ( int32_t )COUNTS_PER_OFS * samples );
+    }
+    cal->check = cal_check( cal );
+
+    return adxl345_cal_apply( cal );
+}
+
+int adxl345_cal_apply( adxl345_cal_t* cal )
+{
+    if( cal == NULL || cal->check != cal_check( cal ) )
+        return -1;
+
+    adxl345_setAxisOffset( cal->offset[0], cal->offset[1], cal->offset[2] );
+
+    return 0;
+}
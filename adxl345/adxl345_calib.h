@@ -0,0 +1,103 @@
+/**
+ * @file adxl345_calib.h
+ *
+ * @brief Offset calibration for the ADXL345
+ *
+ * Averages a number of samples of the sensor lying still, works out the
+ * offsets for OFSX, OFSY and OFSZ and writes them.  The sensor subtracts
+ * them from every sample itself, nothing has to be corrected in software.
+ * The result is kept in an adxl345_cal_t the application stores, e.g. in
+ * EEPROM, and hands back to adxl345_cal_apply after each power up.
+ *
+ * @author Richard Lowe
+ * @copyright AlphaLoewe
+ *
+ * @date 18/10/2026
+ *
+ * @version .01 - Initial
+ *
+ * @details
+ *
+ * Status: <XX% completed.>
+ *
+ * @note
+ * Test configuration:
+ *   MCU:             ATMega32
+ *   Dev.Board:       EasyAVR v7
+ *   Oscillator:      8Mhz
+ *   Ext. Modules:    x
+ *   SW:              MikroC v6.0
+ *
+ * @par
+ *   Samples are taken at 100 Hz, full resolution (3.9 mg/LSB) through the
+ *   FIFO in FIFO mode.  The offset registers have 15.6 mg/LSB, so each
+ *   step is 4 counts.  The axis facing up has to read +1 g, 256 counts.
+ *   Data format, rate, FIFO and interrupt settings are restored afterwards.
+ *   Only offsets are calibrated, scale needs more than one orientation.
+ */
+
+#ifndef ADXL345_CALIB_H
+#define ADXL345_CALIB_H
+
+#include <stdint.h>
+#include "adxl345.h"
+
+/**
+ *  @defgroup Calibration_Orientation
+ *  @{
+ *  Axis pointing up, away from earth, while calibrating
+ */
+#define ADXL345_CAL_X_UP     0
+#define ADXL345_CAL_X_DOWN   1
+#define ADXL345_CAL_Y_UP     2
+#define ADXL345_CAL_Y_DOWN   3
+#define ADXL345_CAL_Z_UP     4   /**< Board lying flat, components up */
+#define ADXL345_CAL_Z_DOWN   5
+/**@}*/
+
+#define ADXL345_CAL_SETTLE   4   /**< Samples dropped after changing rate */
+#define ADXL345_CAL_MAX_IDLE 100 /**< Empty FIFO polls before giving up */
+
+/**
+ *  @struct Calibration result, stored by the application
+ */
+typedef struct
+{
+    int8_t offset[3];       /**< OFSX, OFSY, OFSZ in 15.6 mg/LSB */
+    uint8_t check;          /**< Guards against blank or damaged storage */
+} adxl345_cal_t;
+
+/**
+ *  @brief Calibrates offsets
+ *
+ *  @param orientation - axis facing up, see @ref Calibration_Orientation
+ *  @param samples - number of samples averaged, 1 .. 255
+ *  @param[out] cal - result, also written to the sensor
+ *  @param wait - called on every poll that finds the FIFO empty, e.g. a
+ *  10 ms delay, may be NULL
+ *
+ *  @code
+ *  void wait_10ms() { Delay_ms( 10 ); }
+ *
+ *  if( adxl345_calibrate( ADXL345_CAL_Z_UP, 64, &cal, wait_10ms ) == 0 )
+ *      EEPROM_store( CAL_ADDRESS, &cal, sizeof( cal ) );
+ *  @endcode
+ *
+ *  @returns int
+ *    @retval 0 OK
+ *    @retval -1 bad argument
+ *    @retval -2 sensor delivered no samples, settings are restored
+ */
+int adxl345_calibrate( uint8_t orientation, uint8_t samples, adxl345_cal_t* cal,
+                       void ( *wait )( void ) );
+
+/**
+ *  @brief Writes a stored calibration to the sensor
+ *
+ *  @returns int
+ *    @retval 0 OK
+ *    @retval -1 check failed, sensor left unchanged
+ */
+int adxl345_cal_apply( adxl345_cal_t* cal );
+
+#endif
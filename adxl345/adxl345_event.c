@@ -0,0 +1,153 @@
+#include <stddef.h>
+#include "adxl345_event.h"
+
+// order sources are handled in, most urgent first
+static const uint8_t dispatch_order[8] =
+{
+    ADXL345_FREE_FALL,
+    ADXL345_SINGLE_TAP,
+    ADXL345_DOUBLE_TAP,
+    ADXL345_ACTIVITY,
+    ADXL345_INACTIVITY,
+    ADXL345_DATA_READY,
+    ADXL345_WATERMARK,
+    ADXL345_OVERRUNY
+};
+
+static adxl345_handler_t handlers[8];
+static volatile bool pending;
+
+static uint8_t queue[ ADXL345_EVENT_QUEUE_SIZE ];
+static uint8_t queue_head;
+static uint8_t queue_tail;
+static uint16_t queue_overflow;
+
+//private:
+static void post( uint8_t event );
+
+// One slot stays free to tell a full queue from an empty one
+static void post( uint8_t event )
+{
+    uint8_t next = queue_head + 1;
+
+    if( next == ADXL345_EVENT_QUEUE_SIZE )
+    {
+        next = 0;
+    }
+
+    if( next == queue_tail )
+    {
+        queue_overflow++;
+        return;
+    }
+
+    queue[ queue_head ] = event;
+    queue_head = next;
+}
+
+void adxl345_event_init()
+{
+    uint8_t i;
+
+    for( i = 0; i < 8; i++ )
+    {
+        handlers[i] = NULL;
+    }
+
+    pending = false;
+    queue_head = queue_tail = 0;
+    queue_overflow = 0;
+}
+
+void adxl345_event_on( uint8_t event, adxl345_handler_t handler )
+{
+    if( event < 8 )
+    {
+        handlers[ event ] = handler;
+    }
+}
+
+void adxl345_event_isr()
+{
+    pending = true;
+}
+
+bool adxl345_event_pending()
+{
+    return pending;
+}
+
+// INT is edge triggered and stays high while any enabled source is set,
+// so a source latching while the handlers run gives no new edge.
+// INT_SOURCE is read again until nothing enabled is left; sources still
+// set after ADXL345_EVENT_PASSES reads leave the flag set for the next call
+uint8_t adxl345_event_dispatch()
+{
+    uint8_t source, i, event, pass, count = 0;
+
+    if( !pending )
+    {
+        return 0;
+    }
+
+    pending = false;
+
+    for( pass = 0; pass < ADXL345_EVENT_PASSES; pass++ )
+    {
+        // INT_ENABLE comes from the register cache, only INT_SOURCE is read
+        source  = adxl345_readRegister( ADXL345_INT_SOURCE );
+        source &= adxl345_readRegister( ADXL345_INT_ENABLE );
+
+        if( !source )
+        {
+            return count;
+        }
+
+        for( i = 0; i < 8 && source; i++ )
+        {
+            event = dispatch_order[i];
+
+            if( !( source & ( 1 << event ) ) )
+            {
+                continue;
+            }
+
+            source &= ~( 1 << event );
+            count++;
+
+            if( handlers[ event ] != NULL )
+                handlers[ event ]( event );
+            else
+                post( event );
+        }
+    }
+
+    pending = true;
+
+    return count;
+}
+
+bool adxl345_event_get( uint8_t* event )
+{
+    uint8_t tail = queue_tail;
+
+    if( tail == queue_head )
+    {
+        return false;
+    }
+
+    *event = queue[ tail ];
+
+    if( ++tail == ADXL345_EVENT_QUEUE_SIZE )
+    {
+        tail = 0;
+    }
+    queue_tail = tail;
+
+    return true;
+}
+
+uint16_t adxl345_event_overflow()
+{
+    return queue_overflow;
+}
@@ -0,0 +1,117 @@
+/**
+ * @file adxl345_event.h
+ *
+ * @brief Interrupt driven event dispatch for the ADXL345
+ *
+ * The interrupt pin ISR only marks the sensor as pending.  The main loop
+ * calls adxl345_event_dispatch, which reads INT_SOURCE until no enabled
+ * source is left, and each one that is set goes to its handler, or to the
+ * event queue when no handler is registered.  Without an interrupt there is no bus
+ * traffic at all, and an event waits at most one main loop pass.
+ *
+ * @author Richard Lowe
+ * @copyright AlphaLoewe
+ *
+ * @date 18/10/2026
+ *
+ * @version .01 - Initial
+ *
+ * @details
+ *
+ * Status: <XX% completed.>
+ *
+ * @note
+ * Test configuration:
+ *   MCU:             ATMega32
+ *   Dev.Board:       EasyAVR v7
+ *   Oscillator:      8Mhz
+ *   Ext. Modules:    x
+ *   SW:              MikroC v6.0
+ *
+ * @par
+ *   Reading INT_SOURCE clears the tap, activity, inactivity and free fall
+ *   latches.  DATA_READY, WATERMARK and OVERRUN only clear once the data
+ *   is read, so their handlers have to read it, e.g. adxl345_fifo_drain.
+ *   Otherwise the pin stays active, no further edge arrives and every
+ *   dispatch call reports them again.
+ */
+
+#ifndef ADXL345_EVENT_H
+#define ADXL345_EVENT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "adxl345.h"
+
+#define ADXL345_EVENT_QUEUE_SIZE  8   /**< Events held for adxl345_event_get */
+#define ADXL345_EVENT_PASSES      4   /**< INT_SOURCE reads per dispatch call */
+
+/**
+ *  @brief Event handler
+ *
+ *  @param event - one of @ref Interrupt_Sources
+ */
+typedef void ( *adxl345_handler_t )( uint8_t event );
+
+/**
+ *  @brief Clears handlers, queue and pending flag
+ */
+void adxl345_event_init( void );
+
+/**
+ *  @brief Registers the handler of one event
+ *
+ *  @param event - one of @ref Interrupt_Sources
+ *  @param handler - called from adxl345_event_dispatch, NULL queues the
+ *  event instead
+ */
+void adxl345_event_on( uint8_t event, adxl345_handler_t handler );
+
+/**
+ *  @brief Marks the sensor as pending, call from the pin ISR
+ *
+ *  @code
+ *  void accel_ISR() iv IVT_ADDR_INT0 ics ICS_AUTO
+ *  {
+ *      adxl345_event_isr();
+ *  }
+ *  @endcode
+ */
+void adxl345_event_isr( void );
+
+/**
+ *  @brief Whether an interrupt waits for dispatch
+ */
+bool adxl345_event_pending( void );
+
+/**
+ *  @brief Handles a pending interrupt
+ *
+ *  Reads INT_SOURCE until no enabled source is set, at most
+ *  ADXL345_EVENT_PASSES times, and stays pending when sources are left.
+ *  Free fall goes first, then single and double tap, activity,
+ *  inactivity, data ready, watermark and overrun.  Sources not enabled in
+ *  INT_ENABLE are ignored.
+ *
+ *  @returns uint8_t - number of events handled or queued, 0 when nothing
+ *  was pending
+ */
+uint8_t adxl345_event_dispatch( void );
+
+/**
+ *  @brief Takes the oldest queued event
+ *
+ *  @param[out] event - one of @ref Interrupt_Sources
+ *
+ *  @returns bool
+ *    @retval true event taken
+ *    @retval false queue empty
+ */
+bool adxl345_event_get( uint8_t* event );
+
+/**
+ *  @brief Number of events lost because the queue was full
+ */
+uint16_t adxl345_event_overflow( void );
+
+#endif
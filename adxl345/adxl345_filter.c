@@ -0,0 +1,178 @@
+#include <stddef.h>
+#include <string.h>
+#include "adxl345_filter.h"
+
+#define CIC_MAX_LOG2  7           // R up to 128, phase is 8 bit
+
+#define AXIS( s, a )  ( ( &( s )->x )[a] )
+
+//private:
+static int16_t saturate( int32_t v );
+
+static int16_t saturate( int32_t v )
+{
+    if( v > 32767 )
+        return 32767;
+    if( v < -32768 )
+        return -32768;
+    return ( int16_t )v;
+}
+
+void adxl345_biquad_init( adxl345_biquad_t* f, const int16_t* coeff )
+{
+    memset( f, 0, sizeof( adxl345_biquad_t ) );
+
+    f->b0 = coeff[0];
+    f->b1 = coeff[1];
+    f->b2 = coeff[2];
+    f->a1 = coeff[3];
+    f->a2 = coeff[4];
+}
+
+// y = b0 x + b1 x1 + b2 x2 - a1 y1 - a2 y2, accumulated in 32 bits.  The
+// fraction cut off by the shift is fed into the next output, which keeps
+// rounding noise out of the low frequencies.
+void adxl345_biquad_process( adxl345_biquad_t* f, adxl345_sample_t* in,
+                             adxl345_sample_t* out, uint8_t count )
+{
+    uint8_t a;
+    int16_t x, y;
+    int32_t acc;
+
+    while( count-- )
+    {
+        for( a = 0; a < 3; a++ )
+        {
+            x = AXIS( in, a );
+
+            acc = f->rem[a];                    // fraction dropped last time
+            acc += ( int32_t )f->b0 * x;
+            acc += ( int32_t )f->b1 * f->x1[a];
+            acc += ( int32_t )f->b2 * f->x2[a];
+            acc -= ( int32_t )f->a1 * f->y1[a];
+            acc -= ( int32_t )f->a2 * f->y2[a];
+
+            y = saturate( acc >> 14 );
+            f->rem[a] = ( int16_t )( acc & 0x3FFF );
+
+            f->x2[a] = f->x1[a];
+            f->x1[a] = x;
+            f->y2[a] = f->y1[a];
+            f->y1[a] = y;
+
+            AXIS( out, a ) = y;
+        }
+
+        in++;
+        out++;
+    }
+}
+
+int adxl345_ma_init( adxl345_ma_t* f, uint8_t length )
+{
+    if( length == 0 || length > ADXL345_MA_MAX )
+        return -1;
+
+    memset( f, 0, sizeof( adxl345_ma_t ) );
+    f->length = length;
+
+    return 0;
+}
+
+// Running sum, the oldest sample leaves as the new one enters
+void adxl345_ma_process( adxl345_ma_t* f, adxl345_sample_t* in,
+                         adxl345_sample_t* out, uint8_t count )
+{
+    uint8_t a;
+    int16_t x;
+    int32_t sum;
+
+    while( count-- )
+    {
+        for( a = 0; a < 3; a++ )
+        {
+            x = AXIS( in, a );
+
+            f->sum[a] += x - f->history[a][ f->index ];
+            f->history[a][ f->index ] = x;
+
+            sum = f->sum[a];
+            sum += ( sum < 0 ) ? -( f->length / 2 ) : ( f->length / 2 );
+            AXIS( out, a ) = ( int16_t )( sum / f->length );
+        }
+
+        if( ++f->index == f->length )
+        {
+            f->index = 0;
+        }
+
+        in++;
+        out++;
+    }
+}
+
+int adxl345_cic_init( adxl345_cic_t* f, uint8_t order, uint8_t log2_ratio )
+{
+    if( order == 0 || order > ADXL345_CIC_MAX || log2_ratio > CIC_MAX_LOG2
+        || order * log2_ratio > 16 )
+        return -1;
+
+    memset( f, 0, sizeof( adxl345_cic_t ) );
+    f->order      = order;
+    f->log2_ratio = log2_ratio;
+    f->shift      = order * log2_ratio;
+
+    return 0;
+}
+
+// Integrators run at the input rate, combs only on every R-th sample.
+// Unsigned arithmetic makes the wrap around well defined.
+uint8_t adxl345_cic_process( adxl345_cic_t* f, adxl345_sample_t* in,
+                             adxl345_sample_t* out, uint8_t count )
+{
+    uint8_t a, s, n = 0;
+    uint32_t v, t;
+    bool emit;
+
+    while( count-- )
+    {
+        emit = ( ++f->phase == ( 1 << f->log2_ratio ) );
+        if( emit )
+        {
+            f->phase = 0;
+        }
+
+        for( a = 0; a < 3; a++ )
+        {
+            v = ( uint32_t )( int32_t )AXIS( in, a );
+
+            for( s = 0; s < f->order; s++ )
+            {
+                f->integ[a][s] += v;
+                v = f->integ[a][s];
+            }
+
+            if( emit )
+            {
+                for( s = 0; s < f->order; s++ )
+                {
+                    t = v;
+                    v -= f->comb[a][s];
+                    f->comb[a][s] = t;
+                }
+
+                // out may alias in, it is never ahead of the input
+                AXIS( &out[n], a ) = saturate( ( int32_t )v >> f->shift );
+            }
+        }
+
+        if( emit )
+        {
+            n++;
+        }
+
+        in++;
+    }
+
+    return n;
+}
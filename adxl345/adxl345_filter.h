@@ -0,0 +1,181 @@
+/**
+ * @file adxl345_filter.h
+ *
+ * @brief Integer filter and decimation stages for ADXL345 samples
+ *
+ * Stages work on blocks of adxl345_sample_t, e.g. a FIFO drain, and keep
+ * separate state for each axis.  Input and output may be the same buffer.
+ * Sampling fast for anti-aliasing and decimating here leaves the rest of
+ * the application a fraction of the samples to process and queue.
+ *
+ * @author Richard Lowe
+ * @copyright AlphaLoewe
+ *
+ * @date 18/10/2026
+ *
+ * @version .01 - Initial
+ *
+ * @details
+ *
+ * Status: <XX% completed.>
+ *
+ * @note
+ * Test configuration:
+ *   MCU:             ATMega32
+ *   Dev.Board:       EasyAVR v7
+ *   Oscillator:      8Mhz
+ *   Ext. Modules:    x
+ *   SW:              MikroC v6.0
+ *
+ * @par
+ *   Biquad coefficients are Q14, so each must lie in -2 .. 2.  Below a
+ *   cut-off of about fs / 40 the b coefficients get too coarse, decimate
+ *   with the CIC first.  Outputs saturate
+ *   at the int16_t limits.  The adxl345_bench host tool compares every
+ *   stage with a floating point model.
+ */
+
+#ifndef ADXL345_FILTER_H
+#define ADXL345_FILTER_H
+
+#include <stdint.h>
+#include "adxl345.h"
+
+/**
+ *  @defgroup Biquad_Coefficients
+ *  @{
+ *  Butterworth low pass, { b0, b1, b2, a1, a2 } in Q14, a0 = 1.  Named by
+ *  cut-off as a fraction of the sample rate, DC gain is exactly 1.
+ */
+#define ADXL345_LP_FS_8      {  1600,  3198,  1600, -15447,  5461 } /**< fc = fs / 8, e.g. 800 Hz -> 100 Hz */
+#define ADXL345_LP_FS_10     {  1105,  2210,  1105, -18727,  6763 } /**< fc = fs / 10 */
+#define ADXL345_LP_FS_16     {   491,   981,   491, -23826,  9405 } /**< fc = fs / 16, e.g. 800 Hz -> 50 Hz */
+#define ADXL345_LP_FS_32     {   138,   278,   138, -28242, 12412 } /**< fc = fs / 32 */
+/**@}*/
+
+#define ADXL345_MA_MAX       16   /**< Longest moving average */
+#define ADXL345_CIC_MAX      3    /**< Highest CIC order */
+
+/**
+ *  @struct Biquad section, direct form I
+ */
+typedef struct
+{
+    int16_t b0, b1, b2;         /**< Feed forward, Q14 */
+    int16_t a1, a2;             /**< Feedback, Q14, a0 = 1 */
+    int16_t x1[3], x2[3];       /**< Input history per axis */
+    int16_t y1[3], y2[3];       /**< Output history per axis */
+    int16_t rem[3];             /**< Fraction carried to next output */
+} adxl345_biquad_t;
+
+/**
+ *  @struct Moving average
+ */
+typedef struct
+{
+    int16_t history[3][ ADXL345_MA_MAX ];
+    int32_t sum[3];
+    uint8_t length;             /**< Window length */
+    uint8_t index;              /**< Oldest entry */
+} adxl345_ma_t;
+
+/**
+ *  @struct CIC decimator, differential delay 1
+ *
+ *  Gain R^N is removed by a shift, so R is a power of two.  Arithmetic
+ *  wraps in 32 bits, which is harmless as long as 16 + N * log2( R ) does
+ *  not exceed 32.
+ */
+typedef struct
+{
+    uint32_t integ[3][ ADXL345_CIC_MAX ];  /**< Integrator per axis and stage */
+    uint32_t comb[3][ ADXL345_CIC_MAX ];   /**< Comb delay per axis and stage */
+    uint8_t order;              /**< N, number of stages */
+    uint8_t log2_ratio;         /**< log2( R ) */
+    uint8_t shift;              /**< N * log2( R ) */
+    uint8_t phase;              /**< Input samples since last output */
+} adxl345_cic_t;
+
+/**
+ *  @brief Sets up a biquad
+ *
+ *  @param f - filter to set up, history is cleared
+ *  @param coeff - { b0, b1, b2, a1, a2 } in Q14
+ *
+ *  @code
+ *  static const int16_t lp50[5] = ADXL345_LP_FS_16;
+ *
+ *  adxl345_biquad_init( &lp, lp50 );
+ *  @endcode
+ */
+void adxl345_biquad_init( adxl345_biquad_t* f, const int16_t* coeff );
+
+/**
+ *  @brief Filters a block of samples
+ *
+ *  @param f - filter
+ *  @param in - input samples
+ *  @param out - output samples, may be in
+ *  @param count - number of samples
+ */
+void adxl345_biquad_process( adxl345_biquad_t* f, adxl345_sample_t* in,
+                             adxl345_sample_t* out, uint8_t count );
+
+/**
+ *  @brief Sets up a moving average
+ *
+ *  @param f - filter to set up, history is cleared
+ *  @param length - window length, 1 .. ADXL345_MA_MAX
+ *
+ *  @returns int
+ *    @retval 0 OK
+ *    @retval -1 length out of range
+ */
+int adxl345_ma_init( adxl345_ma_t* f, uint8_t length );
+
+/**
+ *  @brief Averages a block of samples
+ *
+ *  @param f - filter
+ *  @param in - input samples
+ *  @param out - output samples, may be in
+ *  @param count - number of samples
+ */
+void adxl345_ma_process( adxl345_ma_t* f, adxl345_sample_t* in,
+                         adxl345_sample_t* out, uint8_t count );
+
+/**
+ *  @brief Sets up a CIC decimator
+ *
+ *  @param f - decimator to set up, state is cleared
+ *  @param order - N, 1 .. ADXL345_CIC_MAX
+ *  @param log2_ratio - log2 of decimation ratio R
+ *
+ *  @code
+ *  adxl345_set_bw( ADXL345_BW_400 );
+ *  adxl345_cic_init( &cic, 3, 4 );      // 800 Hz / 16 = 50 Hz
+ *  @endcode
+ *
+ *  @returns int
+ *    @retval 0 OK
+ *    @retval -1 order out of range, R above 128 or more than 16 bits of growth
+ */
+int adxl345_cic_init( adxl345_cic_t* f, uint8_t order, uint8_t log2_ratio );
+
+/**
+ *  @brief Decimates a block of samples
+ *
+ *  Phase carries over between calls, block size does not need to be a
+ *  multiple of R.
+ *
+ *  @param f - decimator
+ *  @param in - input samples
+ *  @param out - output samples, may be in
+ *  @param count - number of input samples
+ *
+ *  @returns uint8_t - number of output samples
+ */
+uint8_t adxl345_cic_process( adxl345_cic_t* f, adxl345_sample_t* in,
+                             adxl345_sample_t* out, uint8_t count );
+
+#endif
@@ -0,0 +1,119 @@
+#include <stddef.h>
+#include "adxl345_power.h"
+#include "adxl345_event.h"
+
+#define LINK          0x20        // POWER_CTL link bit
+#define AUTO_SLEEP    0x10        // POWER_CTL auto sleep bit
+#define MEASURE       0x08        // POWER_CTL measure bit
+#define LOW_POWER     0x10        // BW_RATE low power bit
+#define ACT_INACT_AC  0xFF        // ac coupled, all axes, both functions
+#define SAMPLES_MASK  0x1F        // FIFO_CTL samples bits
+
+static const adxl345_power_cfg_t* config;
+static void ( *on_change )( bool active );
+static bool active;
+static uint16_t changes;
+
+//private:
+static void apply( uint8_t rate, uint8_t watermark );
+static void power_activity( uint8_t event );
+static void power_inactivity( uint8_t event );
+
+// Rate and watermark go out as one burst each, FIFO content is kept
+static void apply( uint8_t rate, uint8_t watermark )
+{
+    uint8_t fifo = adxl345_readRegister( ADXL345_FIFO_CTL );
+
+    adxl345_batch_begin();
+    adxl345_writeRegister( ADXL345_BW_RATE, rate );
+    adxl345_writeRegister( ADXL345_FIFO_CTL, ( fifo & ~SAMPLES_MASK ) | watermark );
+    adxl345_batch_commit();
+}
+
+// Link mode reports activity only after inactivity, the check guards
+// against a stray one after init
+static void power_activity( uint8_t event )
+{
+    ( void )event;
+
+    if( active )
+        return;
+
+    apply( config->active_rate, config->active_watermark );
+    active = true;
+    changes++;
+
+    if( on_change != NULL )
+        on_change( true );
+}
+
+// With autosleep the sensor lowers its rate itself, only the watermark
+// changes.  Otherwise it keeps sampling at the idle rate in low power mode.
+static void power_inactivity( uint8_t event )
+{
+    uint8_t rate = config->active_rate;
+
+    ( void )event;
+
+    if( !active )
+        return;
+
+    if( config->sleep == ADXL345_SLEEP_OFF )
+        rate = config->idle_rate | LOW_POWER;
+
+    apply( rate, config->idle_watermark );
+    active = false;
+    changes++;
+
+    if( on_change != NULL )
+        on_change( false );
+}
+
+int adxl345_power_init( const adxl345_power_cfg_t* cfg, int interruptPin,
+                        void ( *changed )( bool active ) )
+{
+    uint8_t power = LINK | MEASURE;
+
+    if( cfg == NULL || cfg->active_rate > ADXL345_BW_1600
+        || cfg->idle_rate < ADXL345_BW_6 || cfg->idle_rate > ADXL345_BW_200
+        || cfg->active_watermark == 0 || cfg->active_watermark > SAMPLES_MASK
+        || cfg->idle_watermark == 0 || cfg->idle_watermark > SAMPLES_MASK
+        || ( cfg->sleep > ADXL345_SLEEP_1HZ && cfg->sleep != ADXL345_SLEEP_OFF ) )
+        return -1;
+
+    config    = cfg;
+    on_change = changed;
+    active    = true;
+    changes   = 0;
+
+    if( cfg->sleep != ADXL345_SLEEP_OFF )
+        power |= AUTO_SLEEP | cfg->sleep;
+
+    adxl345_event_on( ADXL345_ACTIVITY, power_activity );
+    adxl345_event_on( ADXL345_INACTIVITY, power_inactivity );
+
+    adxl345_batch_begin();
+    adxl345_setActivityThreshold( cfg->act_threshold );
+    adxl345_setInactivityThreshold( cfg->inact_threshold );
+    adxl345_setTimeInactivity( cfg->inact_time );
+    adxl345_writeRegister( ADXL345_ACT_INACT_CTL, ACT_INACT_AC );
+    adxl345_setInterruptMapping( ADXL345_INT_ACTIVITY_BIT, interruptPin );
+    adxl345_setInterruptMapping( ADXL345_INT_INACTIVITY_BIT, interruptPin );
+    adxl345_setInterrupt( ADXL345_INT_ACTIVITY_BIT, 1 );
+    adxl345_setInterrupt( ADXL345_INT_INACTIVITY_BIT, 1 );
+    adxl345_writeRegister( ADXL345_POWER_CTL, power );
+    apply( cfg->active_rate, cfg->active_watermark );
+    adxl345_batch_commit();
+
+    return 0;
+}
+
+bool adxl345_power_active()
+{
+    return active;
+}
+
+uint16_t adxl345_power_changes()
+{
+    return changes;
+}
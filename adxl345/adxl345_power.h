@@ -0,0 +1,119 @@
+/**
+ * @file adxl345_power.h
+ *
+ * @brief Activity driven power management for the ADXL345
+ *
+ * The sensor runs in link mode, so activity and inactivity alternate and
+ * each reports a change of state exactly once.  On inactivity the sensor
+ * either goes to sleep by itself (autosleep) or drops to a low power
+ * idle rate, and the FIFO watermark follows so the MCU is woken less
+ * often.  On activity full rate and the normal watermark come back.  The
+ * application hears about each change through a callback and can adjust
+ * its own polling to match.
+ *
+ * @author Richard Lowe
+ * @copyright AlphaLoewe
+ *
+ * @date 18/10/2026
+ *
+ * @version .01 - Initial
+ *
+ * @details
+ *
+ * Status: <XX% completed.>
+ *
+ * @note
+ * Test configuration:
+ *   MCU:             ATMega32
+ *   Dev.Board:       EasyAVR v7
+ *   Oscillator:      8Mhz
+ *   Ext. Modules:    x
+ *   SW:              MikroC v6.0
+ *
+ * @par
+ *   Activity and inactivity are taken over from the event dispatcher,
+ *   adxl345_event_init has to be called before adxl345_power_init.  While
+ *   asleep the sensor puts nothing into the FIFO and raises no data
+ *   interrupts, only activity wakes it.  Low power mode is only valid for
+ *   rates of 12.5 Hz to 400 Hz (ADXL345_BW_6 - ADXL345_BW_200).
+ */
+
+#ifndef ADXL345_POWER_H
+#define ADXL345_POWER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "adxl345.h"
+
+/**
+ *  @defgroup Sleep_Rates
+ *  @{
+ *  Sample rate while asleep, POWER_CTL wakeup bits
+ */
+#define ADXL345_SLEEP_8HZ   0x00
+#define ADXL345_SLEEP_4HZ   0x01
+#define ADXL345_SLEEP_2HZ   0x02
+#define ADXL345_SLEEP_1HZ   0x03
+#define ADXL345_SLEEP_OFF   0xFF  /**< Keep sampling at the idle rate instead */
+/**@}*/
+
+/**
+ *  @struct Active and idle settings
+ */
+typedef struct
+{
+    uint8_t active_rate;        /**< BW_RATE code while active, e.g. ADXL345_BW_400 */
+    uint8_t active_watermark;   /**< FIFO watermark while active, 1 - 31 */
+    uint8_t idle_rate;          /**< BW_RATE code while idle, run in low power mode */
+    uint8_t idle_watermark;     /**< FIFO watermark while idle, 1 - 31 */
+    uint8_t sleep;              /**< @ref Sleep_Rates */
+    uint8_t act_threshold;      /**< 62.5 mg/LSB, ac coupled */
+    uint8_t inact_threshold;    /**< 62.5 mg/LSB, ac coupled */
+    uint8_t inact_time;         /**< Seconds below inact_threshold before idle */
+} adxl345_power_cfg_t;
+
+/**
+ *  @brief Starts managed power mode
+ *
+ *  Writes thresholds, ac coupled activity and inactivity on all axes, the
+ *  active rate and watermark and link mode in one batch, and enables the
+ *  activity and inactivity interrupts on interruptPin.  Starts active.
+ *
+ *  @code
+ *  static const adxl345_power_cfg_t power =
+ *  {
+ *      ADXL345_BW_400, 24,         // 800 Hz, 30 ms per watermark
+ *      ADXL345_BW_6, 31,           // 12.5 Hz, 2.5 s per watermark
+ *      ADXL345_SLEEP_OFF,
+ *      16, 4, 30                   // 1 g, 250 mg, 30 s
+ *  };
+ *
+ *  adxl345_event_init();
+ *  adxl345_event_on( ADXL345_WATERMARK, fifo_watermark );
+ *  adxl345_fifo_init( ADXL345_FIFO_STREAM, 24, ADXL345_INT2_PIN );
+ *  adxl345_power_init( &power, ADXL345_INT2_PIN, power_changed );
+ *  @endcode
+ *
+ *  @param cfg - settings, kept by reference
+ *  @param interruptPin - ADXL345_INT1_PIN or ADXL345_INT2_PIN
+ *  @param changed - called from adxl345_event_dispatch on every change,
+ *  true when active, may be NULL
+ *
+ *  @returns int
+ *    @retval 0 OK
+ *    @retval -1 bad setting, nothing written
+ */
+int adxl345_power_init( const adxl345_power_cfg_t* cfg, int interruptPin,
+                        void ( *changed )( bool active ) );
+
+/**
+ *  @brief Whether the sensor runs at the active settings
+ */
+bool adxl345_power_active( void );
+
+/**
+ *  @brief Number of changes between active and idle since init
+ */
+uint16_t adxl345_power_changes( void );
+
+#endif
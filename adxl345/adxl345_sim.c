@@ -0,0 +1,528 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "adxl345_sim.h"
+
+#define REG( r )         ( sim->mock.regs[ r ] )
+#define BIT( b )         ( 1 << ( b ) )
+
+#define FIFO_MODE        ( REG( ADXL345_FIFO_CTL ) >> 6 )
+#define FIFO_SAMPLES     ( REG( ADXL345_FIFO_CTL ) & 0x1F )
+#define FIFO_TRIGGER_PIN ( REG( ADXL345_FIFO_CTL ) & 0x20 )
+
+#define MEASURE          0x08        // POWER_CTL measure bit
+#define FULL_RES         0x08        // DATA_FORMAT full resolution bit
+
+// bits cleared by reading INT_SOURCE
+#define LATCHED          ( BIT( ADXL345_SINGLE_TAP ) | BIT( ADXL345_DOUBLE_TAP ) \
+                         | BIT( ADXL345_ACTIVITY ) | BIT( ADXL345_INACTIVITY ) \
+                         | BIT( ADXL345_FREE_FALL ) )
+
+//private:
+static uint32_t period_us( adxl345_sim_t* sim );
+static void update_flags( adxl345_sim_t* sim );
+static void update_pins( adxl345_sim_t* sim );
+static int16_t to_counts( adxl345_sim_t* sim, int16_t mg );
+static uint8_t detect( adxl345_sim_t* sim, int16_t* mg );
+static void store( adxl345_sim_t* sim, adxl345_sample_t* s );
+static void produce( adxl345_sim_t* sim );
+static uint8_t sim_read( void* model, uint8_t reg );
+static void sim_write( void* model, uint8_t reg, uint8_t val );
+
+// Output data rate is 3200 Hz for rate code 15 and halves with each step down
+static uint32_t period_us( adxl345_sim_t* sim )
+{
+    uint8_t code = REG( ADXL345_BW_RATE ) & 0x0F;
+
+    return ( 3125UL << ( 15 - code ) ) / 10;
+}
+
+// Data ready, watermark follow the FIFO / data register state
+static void update_flags( adxl345_sim_t* sim )
+{
+    uint8_t src = REG( ADXL345_INT_SOURCE );
+    bool ready  = ( FIFO_MODE == ADXL345_FIFO_BYPASS ) ? sim->data_new : ( sim->fifo_count > 0 );
+
+    src &= ~( BIT( ADXL345_DATA_READY ) | BIT( ADXL345_WATERMARK ) );
+
+    if( ready )
+        src |= BIT( ADXL345_DATA_READY );
+    if( sim->fifo_count >= FIFO_SAMPLES )
+        src |= BIT( ADXL345_WATERMARK );
+
+    REG( ADXL345_INT_SOURCE ) = src;
+}
+
+// Pins are active high, INT_MAP bit set routes a source to INT2
+static void update_pins( adxl345_sim_t* sim )
+{
+    uint8_t level = REG( ADXL345_INT_SOURCE ) & REG( ADXL345_INT_ENABLE );
+    uint8_t pins = 0, rising;
+
+    if( level & ~REG( ADXL345_INT_MAP ) )
+        pins |= ADXL345_SIM_INT1;
+    if( level & REG( ADXL345_INT_MAP ) )
+        pins |= ADXL345_SIM_INT2;
+
+    rising = pins & ~sim->pins;
+    sim->pins = pins;
+
+    if( sim->on_edge != NULL )
+    {
+        if( rising & ADXL345_SIM_INT1 )
+            sim->on_edge( sim->edge_ctx, ADXL345_SIM_INT1 );
+        if( rising & ADXL345_SIM_INT2 )
+            sim->on_edge( sim->edge_ctx, ADXL345_SIM_INT2 );
+    }
+}
+
+// mg to counts at the DATA_FORMAT resolution, rounded and clipped
+static int16_t to_counts( adxl345_sim_t* sim, int16_t mg )
+{
+    uint8_t fmt = REG( ADXL345_DATA_FORMAT );
+    uint8_t range = fmt & 0x03;
+    int32_t lsb_x10, limit, c;
+
+    if( fmt & FULL_RES )
+    {
+        lsb_x10 = 39;
+        limit   = 512L << range;
+    }
+    else
+    {
+        lsb_x10 = 39L << range;
+        limit   = 512;
+    }
+
+    c = ( int32_t )mg * 10;
+    c = ( c + ( ( c < 0 ) ? -lsb_x10 / 2 : lsb_x10 / 2 ) ) / lsb_x10;
+
+    if( c >= limit )
+        c = limit - 1;
+    if( c < -limit )
+        c = -limit;
+
+    return ( int16_t )c;
+}
+
+// Tap, free fall, activity and inactivity on one sample, returns new sources
+static uint8_t detect( adxl345_sim_t* sim, int16_t* mg )
+{
+    uint8_t events = 0, axes, ctl, a, above = 0;
+    int32_t thr, d;
+    uint32_t dt = period_us( sim );
+    bool all_below;
+
+    if( !sim->ref_valid )
+    {
+        memcpy( sim->ref, mg, sizeof( sim->ref ) );
+        sim->ref_valid = true;
+    }
+
+    // tap, axis bits are X = 2, Y = 1, Z = 0 in TAP_AXES and ACT_TAP_STATUS
+    thr  = REG( ADXL345_THRESH_TAP ) * 625L / 10;
+    axes = REG( ADXL345_TAP_AXES ) & 0x07;
+
+    if( thr && axes && REG( ADXL345_DUR ) )
+    {
+        for( a = 0; a < 3; a++ )
+        {
+            if( ( axes & BIT( 2 - a ) ) && labs( mg[a] ) > thr )
+                above |= BIT( 2 - a );
+        }
+
+        if( above && !sim->tap_above )
+        {
+            sim->tap_above    = true;
+            sim->tap_start_us = sim->now_us;
+            sim->tap_axis     = above;
+        }
+        else if( above )
+        {
+            sim->tap_axis |= above;
+        }
+        else if( sim->tap_above )
+        {
+            sim->tap_above = false;
+
+            if( sim->now_us - sim->tap_start_us <= REG( ADXL345_DUR ) * 625UL )
+            {
+                if( sim->tap_first
+                    && sim->tap_start_us - sim->tap_end_us >= REG( ADXL345_LATENT ) * 1250UL
+                    && sim->now_us - sim->tap_end_us
+                       <= ( REG( ADXL345_LATENT ) + REG( ADXL345_WINDOW ) ) * 1250UL )
+                {
+                    events |= BIT( ADXL345_DOUBLE_TAP );
+                    sim->tap_first = false;
+                }
+                else
+                {
+                    events |= BIT( ADXL345_SINGLE_TAP );
+                    sim->tap_first  = REG( ADXL345_LATENT ) && REG( ADXL345_WINDOW );
+                    sim->tap_end_us = sim->now_us;
+                }
+
+                REG( ADXL345_ACT_TAP_STATUS ) = ( REG( ADXL345_ACT_TAP_STATUS ) & ~0x07 )
+                                                | sim->tap_axis;
+            }
+        }
+    }
+
+    // free fall, all axes below threshold for TIME_FF * 5 ms
+    thr = REG( ADXL345_THRESH_FF ) * 625L / 10;
+
+    if( thr && REG( ADXL345_TIME_FF ) )
+    {
+        all_below = labs( mg[0] ) < thr && labs( mg[1] ) < thr && labs( mg[2] ) < thr;
+
+        if( all_below )
+        {
+            sim->ff_us += dt;
+            if( !sim->ff_done && sim->ff_us >= REG( ADXL345_TIME_FF ) * 5000UL )
+            {
+                events |= BIT( ADXL345_FREE_FALL );
+                sim->ff_done = true;
+            }
+        }
+        else
+        {
+            sim->ff_us   = 0;
+            sim->ff_done = false;
+        }
+    }
+
+    // activity, axis bits X = 6, Y = 5, Z = 4, ac coupled with bit 7
+    ctl  = REG( ADXL345_ACT_INACT_CTL );
+    thr  = REG( ADXL345_THRESH_ACT ) * 625L / 10;
+    axes = ( ctl >> 4 ) & 0x07;
+
+    if( thr && axes )
+    {
+        for( a = 0; a < 3; a++ )
+        {
+            d = ( ctl & 0x80 ) ? mg[a] - sim->ref[a] : mg[a];
+
+            if( ( axes & BIT( 2 - a ) ) && labs( d ) > thr )
+            {
+                events |= BIT( ADXL345_ACTIVITY );
+                REG( ADXL345_ACT_TAP_STATUS ) |= BIT( 6 - a );
+            }
+        }
+
+        if( events & BIT( ADXL345_ACTIVITY ) )
+        {
+            sim->inact_us   = 0;
+            sim->inact_done = false;
+            if( ctl & 0x80 )
+                memcpy( sim->ref, mg, sizeof( sim->ref ) );
+        }
+    }
+
+    // inactivity, axis bits X = 2, Y = 1, Z = 0, ac coupled with bit 3
+    thr  = REG( ADXL345_THRESH_INACT ) * 625L / 10;
+    axes = ctl & 0x07;
+
+    if( thr && axes )
+    {
+        all_below = true;
+        for( a = 0; a < 3; a++ )
+        {
+            d = ( ctl & 0x08 ) ? mg[a] - sim->ref[a] : mg[a];
+
+            if( ( axes & BIT( 2 - a ) ) && labs( d ) >= thr )
+                all_below = false;
+        }
+
+        if( !all_below )
+        {
+            sim->inact_us   = 0;
+            sim->inact_done = false;
+        }
+        else
+        {
+            sim->inact_us += dt;
+            if( !sim->inact_done && sim->inact_us >= REG( ADXL345_TIME_INACT ) * 1000000UL )
+            {
+                events |= BIT( ADXL345_INACTIVITY );
+                sim->inact_done = true;
+                if( ctl & 0x08 )
+                    memcpy( sim->ref, mg, sizeof( sim->ref ) );
+            }
+        }
+    }
+
+    return events;
+}
+
+// Puts one sample into the data registers or the FIFO
+static void store( adxl345_sim_t* sim, adxl345_sample_t* s )
+{
+    uint8_t mode = FIFO_MODE;
+
+    if( mode == ADXL345_FIFO_BYPASS )
+    {
+        if( sim->data_new )
+            REG( ADXL345_INT_SOURCE ) |= BIT( ADXL345_OVERRUNY );
+
+        sim->data     = *s;
+        sim->data_new = true;
+        return;
+    }
+
+    if( sim->fifo_count == ADXL345_FIFO_SIZE )
+    {
+        REG( ADXL345_INT_SOURCE ) |= BIT( ADXL345_OVERRUNY );
+
+        // FIFO mode and a fired trigger keep the oldest, stream the newest
+        if( mode == ADXL345_FIFO_FIFO || ( mode == ADXL345_FIFO_TRIGGER && sim->triggered ) )
+            return;
+
+        sim->fifo_head = ( sim->fifo_head + 1 ) % ADXL345_FIFO_SIZE;
+        sim->fifo_count--;
+    }
+
+    sim->fifo[ ( sim->fifo_head + sim->fifo_count ) % ADXL345_FIFO_SIZE ] = *s;
+    sim->fifo_count++;
+}
+
+static void produce( adxl345_sim_t* sim )
+{
+    int16_t mg[3] = { 0, 0, 0 };
+    adxl345_sample_t s;
+    uint32_t row;
+    uint8_t events, a, pin_map;
+
+    if( sim->motion != NULL )
+    {
+        sim->motion( sim->motion_ctx, sim->now_us, mg );
+    }
+    else if( sim->trace != NULL )
+    {
+        row = ( uint32_t )( ( uint64_t )sim->now_us * sim->trace_rate / 1000000UL );
+        if( row >= sim->trace_rows )
+            row = sim->trace_rows - 1;
+        memcpy( mg, &sim->trace[ row * 3 ], sizeof( mg ) );
+    }
+
+    // offset registers add 15.6 mg per LSB before detection and output
+    for( a = 0; a < 3; a++ )
+    {
+        mg[a] += ( int8_t )REG( ADXL345_OFSX + a ) * 156 / 10;
+    }
+
+    events = detect( sim, mg );
+    REG( ADXL345_INT_SOURCE ) |= events;
+
+    // trigger mode keeps FIFO_SAMPLES entries from before the event
+    pin_map = FIFO_TRIGGER_PIN ? REG( ADXL345_INT_MAP ) : ~REG( ADXL345_INT_MAP );
+    if( FIFO_MODE == ADXL345_FIFO_TRIGGER && !sim->triggered
+        && ( events & REG( ADXL345_INT_ENABLE ) & pin_map ) )
+    {
+        sim->triggered = true;
+        while( sim->fifo_count > FIFO_SAMPLES )
+        {
+            sim->fifo_head = ( sim->fifo_head + 1 ) % ADXL345_FIFO_SIZE;
+            sim->fifo_count--;
+        }
+    }
+
+    s.x = to_counts( sim, mg[0] );
+    s.y = to_counts( sim, mg[1] );
+    s.z = to_counts( sim, mg[2] );
+    store( sim, &s );
+    sim->samples++;
+
+    update_flags( sim );
+    update_pins( sim );
+}
+
+// Reading DATAZ1 completes a sample, the next FIFO entry moves up
+static uint8_t sim_read( void* model, uint8_t reg )
+{
+    adxl345_sim_t* sim = ( adxl345_sim_t* )model;
+    adxl345_sample_t* s;
+    uint8_t val;
+    int16_t v;
+
+    reg &= 0x3F;
+
+    switch( reg )
+    {
+        case ADXL345_DATAX0: case ADXL345_DATAX1:
+        case ADXL345_DATAY0: case ADXL345_DATAY1:
+        case ADXL345_DATAZ0: case ADXL345_DATAZ1:
+            s = ( FIFO_MODE != ADXL345_FIFO_BYPASS && sim->fifo_count )
+                ? &sim->fifo[ sim->fifo_head ] : &sim->data;
+            v = ( &s->x )[ ( reg - ADXL345_DATAX0 ) / 2 ];
+            val = ( reg & 1 ) ? ( uint8_t )( ( uint16_t )v >> 8 ) : ( uint8_t )v;
+
+            if( reg == ADXL345_DATAZ1 )
+            {
+                if( FIFO_MODE == ADXL345_FIFO_BYPASS )
+                {
+                    sim->data_new = false;
+                }
+                else if( sim->fifo_count )
+                {
+                    sim->data = *s;
+                    sim->fifo_head = ( sim->fifo_head + 1 ) % ADXL345_FIFO_SIZE;
+                    sim->fifo_count--;
+                }
+
+                REG( ADXL345_INT_SOURCE ) &= ~BIT( ADXL345_OVERRUNY );
+                update_flags( sim );
+                update_pins( sim );
+            }
+            return val;
+
+        case ADXL345_INT_SOURCE:
+            val = REG( reg );
+            REG( reg ) &= ~LATCHED;
+            update_pins( sim );
+            return val;
+
+        case ADXL345_FIFO_STATUS:
+            return sim->fifo_count | ( sim->triggered ? 0x80 : 0 );
+
+        default:
+            return REG( reg );
+    }
+}
+
+static void sim_write( void* model, uint8_t reg, uint8_t val )
+{
+    adxl345_sim_t* sim = ( adxl345_sim_t* )model;
+    uint8_t old;
+
+    reg &= 0x3F;
+
+    // read only and reserved registers
+    if( reg < ADXL345_THRESH_TAP || reg == ADXL345_ACT_TAP_STATUS || reg == ADXL345_INT_SOURCE
+        || ( reg >= ADXL345_DATAX0 && reg <= ADXL345_DATAZ1 ) || reg > ADXL345_FIFO_CTL )
+        return;
+
+    old = REG( reg );
+    REG( reg ) = val;
+
+    switch( reg )
+    {
+        case ADXL345_FIFO_CTL:
+            if( ( old >> 6 ) != ( val >> 6 ) )
+            {
+                sim->fifo_count = 0;
+                sim->triggered  = false;
+            }
+            break;
+
+        case ADXL345_POWER_CTL:
+            if( ( val & MEASURE ) && !( old & MEASURE ) )
+                sim->next_us = sim->now_us + period_us( sim );
+            // detection starts over
+            // fall through
+        case ADXL345_ACT_INACT_CTL:
+            sim->ref_valid  = false;
+            sim->inact_us   = 0;
+            sim->inact_done = false;
+            break;
+    }
+
+    update_flags( sim );
+    update_pins( sim );
+}
+
+void adxl345_sim_init( adxl345_sim_t* sim, adxl345_bus_t* bus )
+{
+    memset( sim, 0, sizeof( adxl345_sim_t ) );
+
+    adxl345_bus_mock_init( bus, &sim->mock );
+    sim->mock.on_read  = sim_read;
+    sim->mock.on_write = sim_write;
+    sim->mock.model    = sim;
+}
+
+void adxl345_sim_set_motion( adxl345_sim_t* sim, adxl345_motion_t motion, void* ctx )
+{
+    adxl345_sim_free( sim );
+    sim->motion     = motion;
+    sim->motion_ctx = ctx;
+}
+
+int32_t adxl345_sim_load_csv( adxl345_sim_t* sim, const char* path, uint16_t rate )
+{
+    FILE* fp;
+    char line[ 128 ];
+    int x, y, z;
+    uint32_t size = 0;
+    int16_t* grown;
+
+    if( rate == 0 || ( fp = fopen( path, "r" ) ) == NULL )
+        return -1;
+
+    adxl345_sim_set_motion( sim, NULL, NULL );
+
+    while( fgets( line, sizeof( line ), fp ) != NULL )
+    {
+        if( sscanf( line, " %d , %d , %d", &x, &y, &z ) != 3 )
+            continue;
+
+        if( sim->trace_rows == size )
+        {
+            size  = size ? size * 2 : 1024;
+            grown = realloc( sim->trace, size * 3 * sizeof( int16_t ) );
+            if( grown == NULL )
+                break;
+            sim->trace = grown;
+        }
+
+        sim->trace[ sim->trace_rows * 3 ]     = ( int16_t )x;
+        sim->trace[ sim->trace_rows * 3 + 1 ] = ( int16_t )y;
+        sim->trace[ sim->trace_rows * 3 + 2 ] = ( int16_t )z;
+        sim->trace_rows++;
+    }
+
+    fclose( fp );
+
+    if( sim->trace_rows == 0 )
+    {
+        adxl345_sim_free( sim );
+        return -1;
+    }
+
+    sim->trace_rate = rate;
+    return ( int32_t )sim->trace_rows;
+}
+
+void adxl345_sim_advance( adxl345_sim_t* sim, uint32_t us )
+{
+    uint32_t end = sim->now_us + us;
+
+    while( ( REG( ADXL345_POWER_CTL ) & MEASURE ) && ( int32_t )( end - sim->next_us ) >= 0 )
+    {
+        sim->now_us = sim->next_us;
+        produce( sim );
+        sim->next_us += period_us( sim );
+    }
+
+    sim->now_us = end;
+    if( !( REG( ADXL345_POWER_CTL ) & MEASURE ) )
+        sim->next_us = end;
+}
+
+void adxl345_sim_on_edge( adxl345_sim_t* sim, void ( *cb )( void* ctx, uint8_t pin ),
+                          void* ctx )
+{
+    sim->on_edge  = cb;
+    sim->edge_ctx = ctx;
+}
+
+uint8_t adxl345_sim_pins( adxl345_sim_t* sim )
+{
+    return sim->pins;
+}
+
+void adxl345_sim_free( adxl345_sim_t* sim )
+{
+    free( sim->trace );
+    sim->trace      = NULL;
+    sim->trace_rows = 0;
+}
@@ -0,0 +1,156 @@
+/**
+ * @file adxl345_sim.h
+ *
+ * @brief Register level ADXL345 model for host builds
+ *
+ * Sits behind the mock transport and answers the driver like the sensor
+ * would.  Acceleration in mg comes from a motion callback or a CSV trace
+ * and is sampled at the output rate set in BW_RATE, scaled by
+ * DATA_FORMAT and shifted by OFSX - OFSZ.  Samples go to the data
+ * registers or the FIFO in bypass, FIFO, stream and trigger mode.  Data
+ * ready, watermark, overrun, single and double tap, activity, inactivity
+ * and free fall are latched in INT_SOURCE and routed to the INT1 / INT2
+ * pins through INT_ENABLE and INT_MAP.  The mock counts every bus
+ * transaction and byte.
+ *
+ * @code
+ *   gcc -O2 -DADXL345_HOST -o adxl345_sim_demo adxl345_sim_demo.c adxl345_sim.c \
+ *       adxl345.c adxl345_bus.c adxl345_event.c -lm
+ * @endcode
+ *
+ * @author Richard Lowe
+ * @copyright AlphaLoewe
+ *
+ * @date 18/10/2026
+ *
+ * @version .01 - Initial
+ *
+ * @details
+ *
+ * Status: <XX% completed.>
+ *
+ * @par
+ *   Detection follows the datasheet description, not the silicon.  Taps
+ *   are measured on the enabled tap axes against THRESH_TAP and DUR, a
+ *   second tap after LATENT and within WINDOW is a double tap.  Free fall
+ *   needs all axes below THRESH_FF for TIME_FF.  Activity and inactivity
+ *   use the dc or ac coupled reference of ACT_INACT_CTL.  Low power,
+ *   sleep and link modes and the justify bit are not modelled.
+ */
+
+#ifndef ADXL345_SIM_H
+#define ADXL345_SIM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "adxl345.h"
+
+#define ADXL345_SIM_INT1   0x01   /**< INT1 pin bit of adxl345_sim_pins */
+#define ADXL345_SIM_INT2   0x02   /**< INT2 pin bit of adxl345_sim_pins */
+
+/**
+ *  @brief Supplies the acceleration at a point in time
+ *
+ *  @param ctx - context given to adxl345_sim_set_motion
+ *  @param t_us - simulated time in microseconds
+ *  @param[out] mg - x, y and z in mg
+ */
+typedef void ( *adxl345_motion_t )( void* ctx, uint32_t t_us, int16_t* mg );
+
+/**
+ *  @struct Model state
+ */
+typedef struct
+{
+    adxl345_mock_t mock;                /**< Registers and bus counters */
+
+    adxl345_sample_t fifo[ ADXL345_FIFO_SIZE ];
+    uint8_t fifo_head;                  /**< Oldest entry */
+    uint8_t fifo_count;                 /**< Entries held */
+    adxl345_sample_t data;              /**< Data registers, last sample read in FIFO modes */
+    bool data_new;                      /**< Data registers not read yet, bypass mode */
+    bool triggered;                     /**< Trigger event seen in trigger mode */
+
+    uint32_t now_us;                    /**< Simulated time */
+    uint32_t next_us;                   /**< Time of next sample */
+    uint32_t samples;                   /**< Samples produced */
+
+    adxl345_motion_t motion;
+    void* motion_ctx;
+    int16_t* trace;                     /**< CSV trace, 3 values per row */
+    uint32_t trace_rows;
+    uint16_t trace_rate;                /**< Rows per second */
+
+    bool tap_above;                     /**< Tap axis above THRESH_TAP */
+    uint32_t tap_start_us;              /**< Time it went above */
+    uint8_t tap_axis;                   /**< ACT_TAP_STATUS bits of tap */
+    bool tap_first;                     /**< Single tap may become a double tap */
+    uint32_t tap_end_us;                /**< End of that single tap */
+    uint32_t ff_us;                     /**< Time below free fall threshold */
+    bool ff_done;
+    uint32_t inact_us;                  /**< Time below inactivity threshold */
+    bool inact_done;
+    int16_t ref[3];                     /**< ac coupled reference, mg */
+    bool ref_valid;
+
+    uint8_t pins;                       /**< Pin levels, ADXL345_SIM_INT1 / INT2 */
+    void ( *on_edge )( void* ctx, uint8_t pin );
+    void* edge_ctx;
+} adxl345_sim_t;
+
+/**
+ *  @brief Sets up the model and a mock transport talking to it
+ *
+ *  @param[out] sim - model, registers get their reset values
+ *  @param[out] bus - transport to hand to adxl345_setBus
+ */
+void adxl345_sim_init( adxl345_sim_t* sim, adxl345_bus_t* bus );
+
+/**
+ *  @brief Sets the motion source, replaces a loaded trace
+ */
+void adxl345_sim_set_motion( adxl345_sim_t* sim, adxl345_motion_t motion, void* ctx );
+
+/**
+ *  @brief Loads a CSV trace of x,y,z rows in mg
+ *
+ *  Lines that do not start with three numbers are skipped, e.g. a
+ *  header.  The last row holds after the trace ends.
+ *
+ *  @param path - file to read
+ *  @param rate - rows per second
+ *
+ *  @returns int32_t - rows loaded, -1 when the file can not be read
+ */
+int32_t adxl345_sim_load_csv( adxl345_sim_t* sim, const char* path, uint16_t rate );
+
+/**
+ *  @brief Lets time pass, producing every sample due
+ *
+ *  @param us - microseconds to advance
+ */
+void adxl345_sim_advance( adxl345_sim_t* sim, uint32_t us );
+
+/**
+ *  @brief Calls cb whenever an interrupt pin goes active
+ *
+ *  @code
+ *  static void edge( void* ctx, uint8_t pin ) { adxl345_event_isr(); }
+ *
+ *  adxl345_sim_on_edge( &sim, edge, NULL );
+ *  @endcode
+ */
+void adxl345_sim_on_edge( adxl345_sim_t* sim, void ( *cb )( void* ctx, uint8_t pin ),
+                          void* ctx );
+
+/**
+ *  @brief Current pin levels, ADXL345_SIM_INT1 | ADXL345_SIM_INT2
+ */
+uint8_t adxl345_sim_pins( adxl345_sim_t* sim );
+
+/**
+ *  @brief Frees a loaded trace
+ */
+void adxl345_sim_free( adxl345_sim_t* sim );
+
+#endif
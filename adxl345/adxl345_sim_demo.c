@@ -0,0 +1,249 @@
+/**
+ * @file adxl345_sim_demo.c
+ *
+ * @brief Runs the ADXL345 driver against the register level model
+ *
+ * The driver is set up like AccelLib: taps, free fall, activity and
+ * inactivity on INT2, 800 Hz into the FIFO in stream mode with a
+ * watermark of 24, handled by the event dispatcher.  The main loop runs
+ * every millisecond of simulated time.  Motion is a board lying flat
+ * with a single tap, a double tap, a drop and the impact, or a CSV trace
+ * of x,y,z rows in mg.  The same motion is then run with DATA_READY
+ * polled every 250 us in bypass mode for comparison.  Events are printed
+ * with the time they were handled, followed by samples, bus transactions
+ * and bytes per sample and host time per sample, model included.
+ *
+ * @code
+ *   gcc -O2 -DADXL345_HOST -o adxl345_sim_demo adxl345_sim_demo.c adxl345_sim.c \
+ *       adxl345.c adxl345_bus.c adxl345_event.c -lm
+ *   adxl345_sim_demo [trace.csv rows_per_second]
+ * @endcode
+ *
+ * @author Richard Lowe
+ * @copyright AlphaLoewe
+ *
+ * @date 18/10/2026
+ *
+ * @version .01 - Initial
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "adxl345.h"
+#include "adxl345_event.h"
+#include "adxl345_sim.h"
+
+#define RUN_US        6000000UL   // 6 s of simulated time
+#define LOOP_US       1000        // main loop period, event mode
+#define POLL_US       250         // poll period, polling mode
+#define RING_SIZE     64
+
+static adxl345_bus_t bus;
+static adxl345_sim_t sim;
+
+static adxl345_sample_t samples[ RING_SIZE ];
+static adxl345_ring_t ring;
+static uint32_t received;
+
+static const char* const names[8] =
+{
+    "overrun", "watermark", "free fall", "inactivity",
+    "activity", "double tap", "single tap", "data ready"
+};
+
+// Board flat on a table, z = 1 g, a little noise
+static void scenario( void* ctx, uint32_t t_us, int16_t* mg )
+{
+    uint32_t t_ms = t_us / 1000;
+    int16_t noise = ( int16_t )( ( uint32_t )( t_us / 1250 * 2654435761UL ) >> 28 ) - 8;
+
+    ( void )ctx;
+    mg[0] = noise;
+    mg[1] = -noise / 2;
+    mg[2] = 1000 + noise;
+
+    // single tap at 1 s, double tap at 2 s, 5 ms spikes
+    if( ( t_ms >= 1000 && t_ms < 1005 ) || ( t_ms >= 2000 && t_ms < 2005 )
+        || ( t_ms >= 2150 && t_ms < 2155 ) )
+        mg[2] += 3500;
+
+    // dropped at 3 s, lands at 3.35 s
+    if( t_ms >= 3000 && t_ms < 3350 )
+        mg[0] = mg[1] = mg[2] = noise;
+    else if( t_ms >= 3350 && t_ms < 3370 )
+        mg[2] = 3000;
+}
+
+static void edge( void* ctx, uint8_t pin )
+{
+    ( void )ctx;
+    ( void )pin;
+    adxl345_event_isr();
+}
+
+static void fifo_watermark( uint8_t event )
+{
+    ( void )event;
+    received += adxl345_fifo_drain( &ring );
+}
+
+static void print_event( uint8_t event )
+{
+    printf( "  %7.3f s  %s\n", sim.now_us / 1e6, names[ event & 7 ] );
+}
+
+static void setup( void )
+{
+    adxl345_init();
+
+    adxl345_batch_begin();
+    adxl345_setTapDetectionOnZ( 1 );
+    adxl345_setTapThreshold( 50 );          // 3.1 g
+    adxl345_setTapDuration( 15 );           // 9.4 ms
+    adxl345_setDoubleTapLatency( 80 );      // 100 ms
+    adxl345_setDoubleTapWindow( 200 );      // 250 ms
+    adxl345_setFreeFallThreshold( 7 );      // 440 mg
+    adxl345_setFreeFallDuration( 45 );      // 225 ms
+    adxl345_setActivityAc( 1 );
+    adxl345_setActivityThreshold( 24 );     // 1.5 g from reference
+    adxl345_setActivityX( 1 );
+    adxl345_setActivityY( 1 );
+    adxl345_setActivityZ( 1 );
+    adxl345_setInactivityAc( 1 );
+    adxl345_setInactivityThreshold( 4 );    // 250 mg
+    adxl345_setTimeInactivity( 2 );
+    adxl345_setInactivityX( 1 );
+    adxl345_setInactivityY( 1 );
+    adxl345_setInactivityZ( 1 );
+    adxl345_setInterruptMapping( ADXL345_INT_SINGLE_TAP_BIT, ADXL345_INT2_PIN );
+    adxl345_setInterruptMapping( ADXL345_INT_DOUBLE_TAP_BIT, ADXL345_INT2_PIN );
+    adxl345_setInterruptMapping( ADXL345_INT_FREE_FALL_BIT, ADXL345_INT2_PIN );
+    adxl345_setInterruptMapping( ADXL345_INT_ACTIVITY_BIT, ADXL345_INT2_PIN );
+    adxl345_setInterruptMapping( ADXL345_INT_INACTIVITY_BIT, ADXL345_INT2_PIN );
+    adxl345_setInterrupt( ADXL345_INT_SINGLE_TAP_BIT, 1 );
+    adxl345_setInterrupt( ADXL345_INT_DOUBLE_TAP_BIT, 1 );
+    adxl345_setInterrupt( ADXL345_INT_FREE_FALL_BIT, 1 );
+    adxl345_setInterrupt( ADXL345_INT_ACTIVITY_BIT, 1 );
+    adxl345_setInterrupt( ADXL345_INT_INACTIVITY_BIT, 1 );
+    adxl345_set_bw( ADXL345_BW_400 );       // 800 Hz output rate
+    adxl345_batch_commit();
+}
+
+static void report( const char* mode, clock_t start )
+{
+    double host = ( double )( clock() - start ) / CLOCKS_PER_SEC;
+
+    printf( "  %u of %u samples, %u transactions, %.2f per sample, %.1f bytes per sample\n",
+            received, sim.samples, sim.mock.transactions,
+            ( double )sim.mock.transactions / received,
+            ( double )sim.mock.bytes / received );
+    printf( "  %s: %.0f ns host time per sample\n\n", mode, host * 1e9 / received );
+}
+
+static void run_events( void )
+{
+    uint8_t event;
+    adxl345_sample_t s;
+    clock_t start;
+
+    printf( "event dispatch, FIFO stream, watermark 24\n" );
+
+    setup();
+    adxl345_ring_init( &ring, samples, RING_SIZE );
+    adxl345_fifo_init( ADXL345_FIFO_STREAM, 24, ADXL345_INT2_PIN );
+    adxl345_event_init();
+    adxl345_event_on( ADXL345_WATERMARK, fifo_watermark );
+    adxl345_sim_on_edge( &sim, edge, NULL );
+
+    received = 0;
+    sim.mock.transactions = 0;
+    sim.mock.bytes = 0;
+    start = clock();
+
+    while( sim.now_us < RUN_US )
+    {
+        adxl345_sim_advance( &sim, LOOP_US );
+        adxl345_event_dispatch();
+
+        while( adxl345_event_get( &event ) )
+        {
+            print_event( event );
+        }
+        while( adxl345_ring_get( &ring, &s ) )
+        {
+        }
+    }
+
+    report( "event", start );
+}
+
+static void run_polling( void )
+{
+    uint8_t src, bit;
+    adxl345_sample_t s;
+    clock_t start;
+
+    printf( "DATA_READY polled every %u us, FIFO bypass\n", POLL_US );
+
+    setup();
+    adxl345_sim_on_edge( &sim, NULL, NULL );
+
+    received = 0;
+    sim.mock.transactions = 0;
+    sim.mock.bytes = 0;
+    start = clock();
+
+    while( sim.now_us < RUN_US )
+    {
+        adxl345_sim_advance( &sim, POLL_US );
+        src = ( uint8_t )adxl345_getInterruptSource();
+
+        for( bit = ADXL345_SINGLE_TAP; bit >= ADXL345_FREE_FALL; bit-- )
+        {
+            if( src & adxl345_readRegister( ADXL345_INT_ENABLE ) & ( 1 << bit ) )
+                print_event( bit );
+        }
+
+        if( src & ( 1 << ADXL345_DATA_READY ) )
+        {
+            adxl345_readSample( &s );
+            received++;
+        }
+    }
+
+    report( "polling", start );
+}
+
+int main( int argc, char** argv )
+{
+    adxl345_sim_init( &sim, &bus );
+    adxl345_setBus( &bus );
+
+    if( argc > 2 )
+    {
+        if( adxl345_sim_load_csv( &sim, argv[1], ( uint16_t )atoi( argv[2] ) ) < 0 )
+        {
+            fprintf( stderr, "can not read %s\n", argv[1] );
+            return 1;
+        }
+    }
+    else
+    {
+        adxl345_sim_set_motion( &sim, scenario, NULL );
+    }
+
+    run_events();
+
+    // same motion from the start, sensor back to reset values
+    adxl345_sim_on_edge( &sim, NULL, NULL );
+    sim.now_us = sim.next_us = 0;
+    sim.samples = 0;
+    adxl345_writeRegister( ADXL345_POWER_CTL, 0 );
+    adxl345_writeRegister( ADXL345_FIFO_CTL, 0 );
+    adxl345_writeRegister( ADXL345_INT_ENABLE, 0 );
+    run_polling();
+
+    adxl345_sim_free( &sim );
+    return 0;
+}
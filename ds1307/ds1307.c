@@ -43,9 +43,13 @@
 #define DS1307_ACK       1
 #define DS1307_NO_ACK    0
 
-#define DS1307_24_12_BIT 6
+#define DS1307_24_12_BIT 6      // set selects 12 hour mode
 #define DS1307_OSC_BIT   7
-#define DS1307_AMPM_BIT  0x20
+#define DS1307_AMPM_BIT  0x20    // set is PM in 12 hour mode
+
+#ifndef DS1307_SYNC_PERIOD
+#define DS1307_SYNC_PERIOD 1     // SQW seconds between RTC reads
+#endif
 
 #ifdef DS1307_I2C_INTERFACE
 #define RTC_ADDR         0x68
@@ -62,55 +66,29 @@
 /*********************
  *  Globals
  ********************/
-static const code uint8_t* days_week[] =
-{      
-    "Sun","Mon","Tue","Wed","Thu","Fri","Sat"
-};
-
-static const code uint8_t* months_year[] = 
-{
-    "NULL","Jan","Feb","Mar","Apr","May","Jun","Jul","Aug","Sep","Oct","Nov","Dec"
-};
-
-
 static uint8_t hour24_enable;
-static uint8_t dst_enable;
-static int8_t  time_zone;
+static ds1307_tz_t zone;
+
+// Time service, GMT time kept in RAM between RTC reads
+static TimeStruct gmt_cache;
+static uint8_t cache_valid;
+static uint8_t cache_enable;         // SQW runs at 1 Hz
+static volatile uint8_t sqw_count;   // edges seen by ds1307_sqw_isr
+static uint8_t sqw_seen;             // edges already counted
+static uint8_t since_sync;           // seconds counted since last RTC read
 
 
 /****************************************
  *  Private Prototypes
  ***************************************/
-static void ds1307_set_dst( uint16_t year );
 static void rtc_write( uint8_t address, uint8_t value );
 static uint8_t rtc_read( uint8_t address );
 static void rtc_write_time( TimeStruct* time );
 static void rtc_read_time( TimeStruct* time );
-
-
-/*
- * USA starting in 2007, extended DST to begin
- * on the 2nd Sunday in March (Day of month = 14 - (1+Y*5/4)mod 7) and
- * end on the 1st Sunday in November (Day of month = 7 - (1 + 5*Y/4) mod 7).
- */
-static void ds1307_set_dst( uint16_t year, TimeStruct* start, TimeStruct* end )
-{
-    start->ss = 0;
-    start->mn = 0;
-    start->hh = 2;
-    start->wd = SUNDAY;
-    start->md = 14 - ( ( 1 + ( ( year * 5 ) / 4 ) ) % 7 );
-    start->mo = MARCH;
-    start->yy = year;
-
-    end->ss  = 0;
-    end->mn  = 0;
-    end->hh  = 2;
-    end->wd  = SUNDAY;
-    end->md  = 7 - ( ( 1 + ( ( year * 5 ) / 4 ) ) % 7 );
-    end->mo  = NOVEMBER;
-    end->yy  = year;
-}
+static uint8_t rtc_decode_hours( uint8_t hours );
+static uint8_t rtc_encode_hours( uint8_t hh, uint8_t mode24 );
+static void cache_sync( void );
+static void cache_get( TimeStruct* ts );
 
 
 static void rtc_write( uint8_t address, uint8_t value )
@@ -170,7 +148,7 @@ static void rtc_write_time( TimeStruct* time )
     TWI_Write( time->hh );
     TWI_Write( time->wd );
     TWI_Write( time->md );
-    TWI_Write( time->mn );
+    TWI_Write( time->mo );
     TWI_Write( ( uint8_t )time->yy );
     TWI_Stop();
     #endif
@@ -195,12 +173,107 @@ static void rtc_read_time( TimeStruct* time )
     time->hh = TWI_Read( DS1307_ACK );
     time->wd = TWI_Read( DS1307_ACK );
     time->md = TWI_Read( DS1307_ACK );
-    time->mn = TWI_Read( DS1307_ACK );
+    time->mo = TWI_Read( DS1307_ACK );
     time->yy = TWI_Read( DS1307_NO_ACK );
     TWI_Stop();
     #endif
 }
 
+// Hours register to 0 - 23, the register tells which mode it is in
+static uint8_t rtc_decode_hours( uint8_t hours )
+{
+    uint8_t hh;
+
+    if( !( hours & ( 1 << DS1307_24_12_BIT ) ) )
+    {
+        return ( uint8_t )Bcd2Dec( hours & HOURS );
+    }
+
+    hh = ( uint8_t )Bcd2Dec( hours & 0x1F );
+
+    if( hh == 12 )
+    {
+        hh = 0;
+    }
+
+    if( hours & DS1307_AMPM_BIT )
+    {
+        hh += 12;
+    }
+
+    return hh;
+}
+
+// 0 - 23 to the hours register in 12 or 24 hour mode
+static uint8_t rtc_encode_hours( uint8_t hh, uint8_t mode24 )
+{
+    if( mode24 )
+    {
+        return Dec2Bcd( hh ) & HOURS;
+    }
+
+    // bit 5 is the AM/PM bit with logic high being PM
+    if( hh >= 12 )
+    {
+        return Dec2Bcd( ( hh == 12 ) ? 12 : hh - 12 ) | DS1307_AMPM_BIT
+               | ( 1 << DS1307_24_12_BIT );
+    }
+
+    return Dec2Bcd( ( hh == 0 ) ? 12 : hh ) | ( 1 << DS1307_24_12_BIT );
+}
+
+// One burst read of the time registers into the cache
+static void cache_sync()
+{
+    TimeStruct time;
+
+    rtc_read_time( &time );
+
+    gmt_cache.ss = ( uint8_t )Bcd2Dec( time.ss & SECONDS );
+    gmt_cache.mn = ( uint8_t )Bcd2Dec( time.mn & MINUTES );
+    gmt_cache.hh = rtc_decode_hours( time.hh );
+    gmt_cache.wd = ( uint8_t )Bcd2Dec( time.wd & DAY ) - 1;
+    gmt_cache.md = ( uint8_t )Bcd2Dec( time.md & DATE );
+    gmt_cache.mo = ( uint8_t )Bcd2Dec( time.mo & MONTH );
+    gmt_cache.yy = ( uint16_t )Bcd2Dec( time.yy & YEAR ) + 2000;
+
+    cache_valid = 1;
+    since_sync  = 0;
+}
+
+/*
+ * Counts SQW seconds into the cache.  The RTC is read when the cache is
+ * empty, every DS1307_SYNC_PERIOD seconds and when a minute would roll
+ * over, so no date arithmetic is needed.  Without the 1 Hz output every
+ * call reads the RTC.
+ */
+static void cache_get( TimeStruct* ts )
+{
+    uint8_t n = sqw_count - sqw_seen;
+
+    sqw_seen += n;
+
+    if( !cache_enable || !cache_valid )
+    {
+        cache_sync();
+    }
+    else if( n )
+    {
+        since_sync += n;
+
+        if( since_sync >= DS1307_SYNC_PERIOD || gmt_cache.ss + n >= 60 )
+        {
+            cache_sync();
+        }
+        else
+        {
+            gmt_cache.ss += n;
+        }
+    }
+
+    *ts = gmt_cache;
+}
+
 
 
 
@@ -212,13 +285,11 @@ static void rtc_read_time( TimeStruct* time )
 // Initialization
 void ds1307_init( ds1307_config_t* rtc_config )
 {
-    if( rtc_config->time_zone >= -16 && rtc_config->time_zone <= 16 )
+    if( ds1307_tz_set( &zone, rtc_config->tz_offset, rtc_config->dst_rule ) == 0 )
     {
         char config = 0, hours = 0;
 
         hour24_enable = rtc_config->hour24_enable;
-        dst_enable    = rtc_config->dst_enable;
-        time_zone     = rtc_config->time_zone;
         
         config = rtc_read( DS1307_SECONDS_ADDR );
         hours  = rtc_read( DS1307_HOURS_ADDR );
@@ -243,24 +314,34 @@ void ds1307_init( ds1307_config_t* rtc_config )
         }
         
         /*
-          This checks the 24 hour bit is set and the mode is set to 12 hour
-          setting will change.
+          When the register is in the other 12 / 24 hour mode the hour is
+          converted, not only the mode bit flipped.
         */
-        if( hours & ( 1 << DS1307_24_12_BIT ) && !hour24_enable )
-        {
-            hours &= ~( 1 << DS1307_24_12_BIT );
-            rtc_write( DS1307_HOURS_ADDR, hours );
-        } 
-        else if( ( !( hours & ( 1 << DS1307_24_12_BIT ) ) ) && hour24_enable )
+        if( ( ( hours & ( 1 << DS1307_24_12_BIT ) ) != 0 ) == ( hour24_enable != 0 ) )
         {
-            hours |= ( 1 << DS1307_24_12_BIT );
-            rtc_write( DS1307_HOURS_ADDR, hours );
+            rtc_write( DS1307_HOURS_ADDR,
+                       rtc_encode_hours( rtc_decode_hours( hours ), hour24_enable ) );
         }
         
         if( rtc_config->output_mode )
         {
             rtc_write( DS1307_CONFIG_ADDR, rtc_config->output_mode );
         }
+
+        cache_enable = ( rtc_config->output_mode == DS1307_SQW_1HZ );
+        cache_valid  = 0;
+    }
+}
+
+
+// Counts one second, SQW edges are only counted here.  Stops at 255
+// unread seconds so the count cannot wrap past sqw_seen, cache_get then
+// sees at least a minute and reads the RTC.
+void ds1307_sqw_isr()
+{
+    if( ( uint8_t )( sqw_count - sqw_seen ) != 255 )
+    {
+        sqw_count++;
     }
 }
 
@@ -274,7 +355,7 @@ void ds1307_set_time_GMT( uint32_t GMTTime )
 {
     TimeStruct ts;
     
-    Time_epochToDate( GMTTime, &ts );
+    Time_epochToDateU( GMTTime, &ts );
     ds1307_set_time_GMT_ts( &ts );
 }
 
@@ -283,30 +364,7 @@ void ds1307_set_time_GMT_ts( TimeStruct* set_time )
 {
     TimeStruct time;
 
-    if( !hour24_enable )
-    {
-        // bit 5 is the AM/PM bit with logic high being PM
-        if( set_time->hh >= 12 )
-        {
-            if( set_time->hh == 12 )
-            {
-                time.hh = ( Dec2Bcd( set_time->hh ) | ( 1 << DS1307_AMPM_BIT ) );
-            }
-            else
-            {
-                time.hh = ( Dec2Bcd( set_time->hh - 12 ) | ( 1 << DS1307_AMPM_BIT ) );
-            }
-        }
-        else
-        {
-            time.hh = ( Dec2Bcd( set_time->hh ) & HOURS );
-            time.hh &= ~( 1 << DS1307_AMPM_BIT );
-        }
-    }
-    else
-    {
-        time.hh = Dec2Bcd( set_time->hh ) & HOURS;
-    }
+    time.hh = rtc_encode_hours( set_time->hh, hour24_enable );
     
     /* We need to add one to the day that is stored in the TimeStruct
        because the TimeStruct count begins at 0 while the DS1307 starts
@@ -317,47 +375,17 @@ void ds1307_set_time_GMT_ts( TimeStruct* set_time )
     
     time.wd = ( Dec2Bcd( set_time->wd ) & DAY ) + 1;
     time.md = Dec2Bcd( set_time->md ) & DATE;
-    time.mn = Dec2Bcd( set_time->mo ) & MONTH;
-    time.yy = ( uint16_t )Dec2Bcd( ( uint8_t )set_time->yy - 2000 ) & YEAR;
+    time.mo = Dec2Bcd( set_time->mo ) & MONTH;
+    time.yy = ( uint16_t )Dec2Bcd( ( uint8_t )( set_time->yy - 2000 ) ) & YEAR;
     
     rtc_write_time( &time );
+    cache_valid = 0;
 }
 
 // Get GMT time and returns TimeStruct
 void ds1307_get_GMT_time( TimeStruct* ts )
 {
-    TimeStruct time;
-
-    rtc_read_time( &time );
-
-    // When high, the 12-hour mode is selected.
-    if( !hour24_enable )
-    {
-        if( rtc_read( DS1307_HOURS_ADDR ) & ( 1 << DS1307_AMPM_BIT ) )
-        {
-           ts->hh = ( uint8_t )Bcd2Dec( time.hh & 0x1F );
-           ts->hh += 12;
-        }
-        else
-        {
-           ts->hh = ( uint8_t )Bcd2Dec( time.hh & 0x1F );
-
-           if( ts->hh == 12 )
-           {
-               ts->hh = 0;
-           }
-
-        }
-    }
-
-    ts->ss = ( uint8_t )Bcd2Dec( time.ss & SECONDS );
-    ts->mn = ( uint8_t )Bcd2Dec( time.mn & MINUTES );
-    ts->wd = ( uint8_t )Bcd2Dec( time.wd & DAY ) - 1;
-    ts->md = ( uint8_t )Bcd2Dec( time.wd & DATE );
-    ts->mo = ( uint8_t )Bcd2Dec( time.mn & MONTH );
-    ts->yy = ( uint16_t )Bcd2Dec( time.yy & YEAR ) + 2000;
-
-    return;
+    cache_get( ts );
 }
 
 /*
@@ -369,7 +397,7 @@ int32_t ds1307_get_GMT_unix_time()
     
     ds1307_get_GMT_time( &ts );
 
-    return Time_dateToEpoch( &ts );
+    return ( int32_t )Time_dateToEpochU( &ts );
 }
 
 
@@ -382,54 +410,26 @@ int32_t ds1307_get_GMT_unix_time()
 
 void ds1307_set_time_local( uint32_t localTime )
 {
-    TimeStruct set_time;
-    
-    Time_epochToDate( localTime, &set_time );
-    ds1307_set_time_local_ts( &set_time );
+    ds1307_set_time_GMT( ds1307_tz_gmt( &zone, localTime ) );
 }
 
 
 void ds1307_set_time_local_ts( TimeStruct* set_time )
 {
-    TimeStruct time;
-
-    //TODO need to compensate for daylight savings time
-    if( dst_enable )
-    {
-
-    }
-    else
-    {
-    
-    }
-    
-    rtc_write_time( &time );
-
+    ds1307_set_time_local( Time_dateToEpochU( set_time ) );
 }
 
 
 void ds1307_get_local_time( TimeStruct* ts )
 {
-    uint32_t time = ds1307_get_GMT_unix_time();
-    
-    
-    if( dst_enable )
-    {
-    
-    }
-    
-    time += time_zone * Time_secInH;
-    
-    return;
+    Time_epochToDateU( ( uint32_t )ds1307_get_local_unix_time(), ts );
 }
 
 
+// Zone offset from the cached interval, one compare and one add
 int32_t ds1307_get_local_unix_time()
 {
-   TimeStruct ts;
-   ds1307_get_local_time( &ts );
-   
-   return Time_dateToEpoch( &ts );
+    return ( int32_t )ds1307_tz_local( &zone, ( uint32_t )ds1307_get_GMT_unix_time() );
 }
 
 
@@ -446,56 +446,11 @@ int32_t ds1307_get_local_unix_time()
 char* ds1307_get_local_time_str( int mode )
 {
     static char formated_local_time[20];
-    TimeStruct tmp_time;
-
-    ds1307_get_local_time( &tmp_time );
 
-    if( mode == MODE12HOUR )
-    {
-        uint8_t x;
-
-        x = tmp_time.hh;
-
-        if( x == 0 )
-        {
-            x += 12;
-        }
-
-        else if( x >= 13 )
-        {
-            x -= 12;
-        }
-
-        formated_local_time[0] = ( x / 10 ) + 48;
-        formated_local_time[1] = ( x % 10 ) + 48;
-    }
-    else
-    {
-        formated_local_time[0] = ( tmp_time.hh / 10 ) + 48;
-        formated_local_time[1] = ( tmp_time.hh % 10 ) + 48;
-    }
-
-    formated_local_time[2] = ':';
-    formated_local_time[3] = ( tmp_time.mn / 10 ) + 48;
-    formated_local_time[4] = ( tmp_time.mn % 10 ) + 48;
-    formated_local_time[5] = ':';
-    formated_local_time[6] = ( tmp_time.ss / 10 ) + 48;
-    formated_local_time[7] = ( tmp_time.ss % 10 ) + 48;
-    formated_local_time[8] = ' ';
-    formated_local_time[9] = ( tmp_time.mo / 10 ) + 48;
-    formated_local_time[10] = ( tmp_time.mo % 10 ) + 48;
-    formated_local_time[11] = '/';
-    formated_local_time[12] = ( tmp_time.md / 10 ) + 48;
-    formated_local_time[13] = ( tmp_time.md % 10 ) + 48;
-    formated_local_time[14] = '/';
-    formated_local_time[15] = ( tmp_time.yy / 1000 ) + 48;
-    formated_local_time[16] = ( ( tmp_time.yy % 1000 ) / 100 ) + 48;
-    formated_local_time[17] = ( ( tmp_time.yy % 100 ) / 10 ) + 48;
-    formated_local_time[18] = ( tmp_time.yy % 10 ) + 48;
-    formated_local_time[19] = '\0';
+    ds1307_get_local_time_fmt( formated_local_time,
+                               ( mode == MODE12HOUR ) ? DS1307_FMT_12H : DS1307_FMT_24H );
 
     return formated_local_time;
-
 }
 
 /*
@@ -503,55 +458,30 @@ char* ds1307_get_local_time_str( int mode )
 char* ds1307_get_GMT_time_str( int mode )
 {
     static char formated_gmt_time[20];
-    TimeStruct tmp_time;
 
-    ds1307_get_GMT_time( &tmp_time );
+    ds1307_get_GMT_time_fmt( formated_gmt_time,
+                             ( mode == MODE12HOUR ) ? DS1307_FMT_12H : DS1307_FMT_24H );
 
-    if( mode == MODE12HOUR )
-    {
-        uint8_t x;
+    return formated_gmt_time;
+}
 
-        x = tmp_time.hh;
+// Formats into the buffer of the caller
+uint8_t ds1307_get_local_time_fmt( char* buff, const char* prog )
+{
+    TimeStruct ts;
 
-        if( x == 0 )
-        {
-            x += 12;
-        }
+    ds1307_get_local_time( &ts );
 
-        else if( x >= 13 )
-        {
-            x -= 12;
-        }
+    return ds1307_format( buff, prog, &ts );
+}
 
-        formated_gmt_time[0] = ( x / 10 ) + 48;
-        formated_gmt_time[1] = ( x % 10 ) + 48;
-    }
-    else
-    {
-        formated_gmt_time[0] = ( tmp_time.hh / 10 ) + 48;
-        formated_gmt_time[1] = ( tmp_time.hh % 10 ) + 48;
-    }
+uint8_t ds1307_get_GMT_time_fmt( char* buff, const char* prog )
+{
+    TimeStruct ts;
 
-    formated_gmt_time[2] = ':';
-    formated_gmt_time[3] = ( tmp_time.mn / 10 ) + 48;
-    formated_gmt_time[4] = ( tmp_time.mn % 10 ) + 48;
-    formated_gmt_time[5] = ':';
-    formated_gmt_time[6] = ( tmp_time.ss / 10 ) + 48;
-    formated_gmt_time[7] = ( tmp_time.ss % 10 ) + 48;
-    formated_gmt_time[8] = ' ';
-    formated_gmt_time[9] = ( tmp_time.mo / 10 ) + 48;
-    formated_gmt_time[10] = ( tmp_time.mo % 10 ) + 48;
-    formated_gmt_time[11] = '/';
-    formated_gmt_time[12] = ( tmp_time.md / 10 ) + 48;
-    formated_gmt_time[13] = ( tmp_time.md % 10 ) + 48;
-    formated_gmt_time[14] = '/';
-    formated_gmt_time[15] = ( tmp_time.yy / 1000 ) + 48;
-    formated_gmt_time[16] = ( ( tmp_time.yy % 1000 ) / 100 ) + 48;
-    formated_gmt_time[17] = ( ( tmp_time.yy % 100 ) / 10 ) + 48;
-    formated_gmt_time[18] = ( tmp_time.yy % 10 ) + 48;
-    formated_gmt_time[19] = '\0';
+    ds1307_get_GMT_time( &ts );
 
-    return formated_gmt_time;
+    return ds1307_format( buff, prog, &ts );
 }
 
 /*
@@ -584,7 +514,13 @@ void ds1307_write_ram( uint8_t addr, uint8_t datam )
 // Bulk write
 void ds1307_write_ram_bulk( void* write_data, uint8_t size )
 {
-    if( size > RAM_SIZE )
+    ds1307_write_ram_at( RAM_START, write_data, size );
+}
+
+// Burst write from any RAM address
+void ds1307_write_ram_at( uint8_t addr, void* write_data, uint8_t size )
+{
+    if( addr < RAM_START || size == 0 || size > RAM_END + 1 - addr )
     {
        return;
     }
@@ -595,13 +531,12 @@ void ds1307_write_ram_bulk( void* write_data, uint8_t size )
         #endif
         
         uint8_t* p_data = ( uint8_t* )write_data;
-        uint8_t start_addr = 0x08;
         
         #ifdef DS1307_TWI_INTERFACE
         
         TWI_Start();
         TWI_Write( DS1307_WRITE );
-        TWI_Write( start_addr );
+        TWI_Write( addr );
         
         while( size-- > 0 )
         {
@@ -614,7 +549,7 @@ void ds1307_write_ram_bulk( void* write_data, uint8_t size )
         
         #ifdef DS1307_I2C_INTERFACE
 
-        write_buffer[0] = start_addr;
+        write_buffer[0] = addr;
         memcpy( &write_buffer[1], p_data, size );
         I2C_Start();
         I2C_Write( RTC_ADDR, write_buffer, ( size + 1 ), END_MODE_STOP );
@@ -634,16 +569,21 @@ uint8_t ds1307_read_ram( uint8_t addr )
 // Bulk read
 void ds1307_read_ram_bulk( void* read_data, uint8_t size )
 {
-    if( size < RAM_SIZE )
+    ds1307_read_ram_at( RAM_START, read_data, size );
+}
+
+// Burst read from any RAM address
+void ds1307_read_ram_at( uint8_t addr, void* read_data, uint8_t size )
+{
+    if( addr >= RAM_START && size > 0 && size <= RAM_END + 1 - addr )
     {
         uint8_t* p_data = ( uint8_t* )read_data;
-        uint8_t start_addr = RAM_START;
 
         #ifdef DS1307_TWI_INTERFACE
         
         TWI_Start();
         TWI_Write( DS1307_WRITE );
-        TWI_Write( start_addr );
+        TWI_Write( addr );
         TWI_Start();
         TWI_Write( DS1307_READ );
 
@@ -660,7 +600,7 @@ void ds1307_read_ram_bulk( void* read_data, uint8_t size )
         #ifdef DS1307_I2C_INTERFACE
 
         I2C_Start();
-        I2C_Write( RTC_ADDR, &start_addr, 1, END_MODE_RESTART );
+        I2C_Write( RTC_ADDR, &addr, 1, END_MODE_RESTART );
         I2C_Read( RTC_ADDR, p_data, size, END_MODE_STOP );
 
         #endif
@@ -671,41 +611,9 @@ void ds1307_read_ram_bulk( void* read_data, uint8_t size )
 char* ds1307_get_http_gmt_str()
 {
     //Tue, 15 Nov 1994 08:12:31 GMT
-    TimeStruct ts1;
     static char gmt_str[30];
 
-    ds1307_get_GMT_time( &ts1 );
-
-    gmt_str[0]  = days_week[ts1.wd][0];
-    gmt_str[1]  = days_week[ts1.wd][1];
-    gmt_str[2]  = days_week[ts1.wd][2];
-    gmt_str[3]  = ',';
-    gmt_str[4]  = ' ';
-    gmt_str[5]  = ( ts1.md / 10 ) + 48;
-    gmt_str[6]  = ( ts1.md % 10 ) + 48;
-    gmt_str[7]  = ' ';
-    gmt_str[8]  = months_year[ts1.mo][0];
-    gmt_str[9]  = months_year[ts1.mo][1];
-    gmt_str[10] = months_year[ts1.mo][2];
-    gmt_str[11] = ' ';
-    gmt_str[12] = ( ts1.yy / 1000 ) + 48;
-    gmt_str[13] = ( ( ts1.yy % 1000 ) / 100 ) + 48;
-    gmt_str[14] = ( ( ts1.yy % 100 ) / 10 ) + 48;
-    gmt_str[15] = ( ts1.yy % 10 ) + 48;
-    gmt_str[16] = ' ';
-    gmt_str[17] = ( ts1.hh / 10 ) + 48;
-    gmt_str[18] = ( ts1.hh % 10 ) + 48;
-    gmt_str[19] = ':';
-    gmt_str[20] = ( ts1.mn / 10 ) + 48;
-    gmt_str[21] = ( ts1.mn % 10 ) + 48;
-    gmt_str[22] = ':';
-    gmt_str[23] = ( ts1.ss / 10 ) + 48;
-    gmt_str[24] = ( ts1.ss % 10 ) + 48;
-    gmt_str[25] = ' ';
-    gmt_str[26] = 'G';
-    gmt_str[27] = 'M';
-    gmt_str[28] = 'T';
-    gmt_str[29] = '\0';
+    ds1307_get_GMT_time_fmt( gmt_str, DS1307_FMT_HTTP );
 
     return gmt_str;
 }
\ No newline at end of file
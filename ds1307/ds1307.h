@@ -48,10 +48,19 @@
 #define _DS1307_H
 
 #include <stdint.h>
-#include "timelib.h"
 
 #define DS1307_TWI_INTERFACE
 //#define DS1307_I2C_INTERFACE
+//#define DS1307_HOST           // Host builds, TWI goes to the ds1307_sim model
+
+#ifdef DS1307_HOST
+#define code                    // one address space on the host
+#include "ds1307_sim.h"
+#endif
+
+#include "timelib.h"
+#include "ds1307_tz.h"
+#include "ds1307_fmt.h"
 
 /**
  * @brief 24 or 12 hour modes
@@ -83,8 +92,8 @@
  */
 typedef struct
 {
-    int8_t  time_zone;         /**< Local time zone                         */
-    uint8_t dst_enable;       /**< Enable or disable daylight savings time */
+    int16_t tz_offset;        /**< Standard time, minutes from GMT         */
+    const code ds1307_tz_rule_t* dst_rule; /**< Daylight saving, DS1307_TZ_NONE */
     uint8_t output_mode;    // Configuration for output pin
     uint8_t hour24_enable;    // Keep time in 24 or 12 hour modes
 } ds1307_config_t;
@@ -97,9 +106,9 @@ typedef struct
  *
  *  @code
  *   ds1307_config_t rtc_config;
- *   rtc_config.time_zone = -8;
- *   rtc_config.dst_enable = true;
- *   rtc_config.config = DS1307_SQW_1HZ;
+ *   rtc_config.tz_offset = -8 * 60;
+ *   rtc_config.dst_rule = &ds1307_tz_us;
+ *   rtc_config.output_mode = DS1307_SQW_1HZ;
  *
  *   ds1307_init( &rtc_config );
  *  @endcode
@@ -110,6 +119,28 @@ typedef struct
  */
 void ds1307_init( ds1307_config_t* rtc_config );
 
+/**
+ *  @brief Counts one SQW second, call from the SQW pin ISR
+ *
+ *  With output_mode DS1307_SQW_1HZ the time is kept in RAM.  The getters
+ *  read the RTC once, then count these edges and only read again every
+ *  DS1307_SYNC_PERIOD seconds or when a minute rolls over.  Several
+ *  getters within one second share one burst read.  In any other output
+ *  mode every getter reads the RTC.
+ *
+ *  @code
+ *  void rtc_sw_ISR() iv IVT_ADDR_INT0 ics ICS_AUTO
+ *  {
+ *      ds1307_sqw_isr();
+ *  }
+ *  @endcode
+ *
+ *  @note
+ *    The seconds register changes on the falling edge of SQW, the ISR
+ *    should trigger on it.
+ */
+void ds1307_sqw_isr( void );
+
 /**
  *  @brief Setting Time with GMT unix timestamp
  *
@@ -210,6 +241,37 @@ char* ds1307_get_local_time_str( int mode );
  */
 char* ds1307_get_GMT_time_str( int mode );
 
+/**
+ *  @brief Formats local time into a buffer
+ *
+ *  Unlike the str functions the buffer belongs to the caller, so calls
+ *  from different contexts do not overwrite each other.
+ *
+ *  @param char* buff - output, DS1307_FMT_MAX + 1 bytes
+ *  @param const char* prog - @ref Format_Programs or compiled pattern
+ *
+ *  @code
+ *   char line[ DS1307_FMT_MAX + 1 ];
+ *
+ *   ds1307_get_local_time_fmt( line, DS1307_FMT_ISO8601 );
+ *  @endcode
+ *
+ *  @returns uint8_t - length of string
+ *
+ */
+uint8_t ds1307_get_local_time_fmt( char* buff, const char* prog );
+
+/**
+ *  @brief Formats GMT time into a buffer
+ *
+ *  @param char* buff - output, DS1307_FMT_MAX + 1 bytes
+ *  @param const char* prog - @ref Format_Programs or compiled pattern
+ *
+ *  @returns uint8_t - length of string
+ *
+ */
+uint8_t ds1307_get_GMT_time_fmt( char* buff, const char* prog );
+
 /**
  *  @brief Get default system time in string format
  *
@@ -238,6 +300,19 @@ void ds1307_write_ram( uint8_t addr, uint8_t datam );
  */
 void ds1307_write_ram_bulk( void* write_data, uint8_t size );
 
+/**
+ *  @brief Burst write from any RAM address
+ *
+ *  Writes all bytes in one transaction.  Nothing is written when the
+ *  range is not inside RAM_START .. RAM_END.
+ *
+ *  @param uint8_t addr - first address, RAM_START .. RAM_END
+ *  @param void* write_data - data to be written
+ *  @param uint8_t size - size of data to be written
+ *
+ */
+void ds1307_write_ram_at( uint8_t addr, void* write_data, uint8_t size );
+
 /**
  *  @brief Reads scratch ram area of ds1307
  *
@@ -262,6 +337,19 @@ uint8_t ds1307_read_ram( uint8_t addr );
  */
 void ds1307_read_ram_bulk( void* read_data, uint8_t size );
 
+/**
+ *  @brief Burst read from any RAM address
+ *
+ *  Reads all bytes in one transaction.  Nothing is read when the range
+ *  is not inside RAM_START .. RAM_END.
+ *
+ *  @param uint8_t addr - first address, RAM_START .. RAM_END
+ *  @param void* read_data - variable to store read area
+ *  @param uint8_t size - size of data to be read
+ *
+ */
+void ds1307_read_ram_at( uint8_t addr, void* read_data, uint8_t size );
+
 /**
  *  @brief Get http get http gmt string
  *
@@ -0,0 +1,226 @@
+#include "ds1307.h"
+
+#define FIELD       0x80    // program bytes from here on are fields
+#define YEAR        0x80
+#define YEAR2       0x81
+#define MONTH       0x82
+#define DAY         0x83
+#define HOUR        0x84
+#define HOUR12      0x85
+#define MINUTE      0x86
+#define SECOND      0x87
+#define AMPM        0x88
+#define WEEKDAY     0x89
+#define MONTHNAME   0x8A
+
+static const code char digits[] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// monday first, as TimeStruct counts
+static const code char weekdays[] = "MonTueWedThuFriSatSun";
+static const code char months[]   = "JanFebMarAprMayJunJulAugSepOctNovDec";
+
+// field letter of the pattern and its code, same order
+static const code char letters[] = "YymdHIMSpab";
+
+static const code uint8_t widths[] = { 4, 2, 2, 2, 2, 2, 2, 2, 2, 3, 3 };
+
+//private:
+static void put2( char* p, uint8_t v );
+static uint8_t put_field( char* p, uint8_t field, TimeStruct* ts );
+static uint8_t changed( uint8_t field, TimeStruct* last, TimeStruct* ts );
+
+static void put2( char* p, uint8_t v )
+{
+    p[0] = digits[ v << 1 ];
+    p[1] = digits[ ( v << 1 ) + 1 ];
+}
+
+// Writes one field, returns its width
+static uint8_t put_field( char* p, uint8_t field, TimeStruct* ts )
+{
+    uint8_t hi, lo, h;
+
+    switch( field )
+    {
+        case YEAR:
+        case YEAR2:
+            // century by compare, years 1900 - 2199
+            hi = 19;
+            lo = ( uint8_t )( ts->yy - 1900 );
+            if( ts->yy >= 2000 )
+            {
+                hi = 20;
+                lo = ( uint8_t )( ts->yy - 2000 );
+                if( lo >= 100 )
+                {
+                    hi = 21;
+                    lo -= 100;
+                }
+            }
+            if( field == YEAR2 )
+            {
+                put2( p, lo );
+                return 2;
+            }
+            put2( p, hi );
+            put2( p + 2, lo );
+            return 4;
+
+        case MONTH:
+            put2( p, ts->mo );
+            return 2;
+
+        case DAY:
+            put2( p, ts->md );
+            return 2;
+
+        case HOUR:
+            put2( p, ts->hh );
+            return 2;
+
+        case HOUR12:
+            h = ts->hh;
+            if( h == 0 )
+                h = 12;
+            else if( h > 12 )
+                h -= 12;
+            put2( p, h );
+            return 2;
+
+        case MINUTE:
+            put2( p, ts->mn );
+            return 2;
+
+        case SECOND:
+            put2( p, ts->ss );
+            return 2;
+
+        case AMPM:
+            p[0] = ( ts->hh < 12 ) ? 'A' : 'P';
+            p[1] = 'M';
+            return 2;
+
+        case WEEKDAY:
+            h = ts->wd * 3;
+            p[0] = weekdays[ h ];
+            p[1] = weekdays[ h + 1 ];
+            p[2] = weekdays[ h + 2 ];
+            return 3;
+
+        default:
+            h = ( ts->mo - 1 ) * 3;
+            p[0] = months[ h ];
+            p[1] = months[ h + 1 ];
+            p[2] = months[ h + 2 ];
+            return 3;
+    }
+}
+
+// Whether the value shown by a field differs
+static uint8_t changed( uint8_t field, TimeStruct* last, TimeStruct* ts )
+{
+    switch( field )
+    {
+        case YEAR:
+        case YEAR2:
+            return last->yy != ts->yy;
+        case MONTH:
+        case MONTHNAME:
+            return last->mo != ts->mo;
+        case DAY:
+            return last->md != ts->md;
+        case MINUTE:
+            return last->mn != ts->mn;
+        case SECOND:
+            return last->ss != ts->ss;
+        case WEEKDAY:
+            return last->wd != ts->wd;
+        default:
+            return last->hh != ts->hh;
+    }
+}
+
+int ds1307_fmt_compile( char* prog, const char* pattern )
+{
+    uint8_t length = 0, f;
+
+    while( *pattern )
+    {
+        if( *pattern != '%' || pattern[1] == '%' )
+        {
+            if( *pattern == '%' )
+                pattern++;
+            if( ( uint8_t )*pattern >= FIELD )
+                return -3;
+            if( length >= DS1307_FMT_MAX )
+                return -2;
+            *prog++ = *pattern++;
+            length++;
+            continue;
+        }
+
+        for( f = 0; letters[ f ] && letters[ f ] != pattern[1]; f++ );
+        if( !letters[ f ] )
+            return -1;
+
+        length += widths[ f ];
+        if( length > DS1307_FMT_MAX )
+            return -2;
+
+        *prog++ = ( char )( FIELD + f );
+        pattern += 2;
+    }
+
+    *prog = '\0';
+    return 0;
+}
+
+uint8_t ds1307_format( char* buff, const char* prog, TimeStruct* ts )
+{
+    char* p = buff;
+    uint8_t op;
+
+    while( ( op = ( uint8_t )*prog++ ) != 0 )
+    {
+        if( op < FIELD )
+            *p++ = ( char )op;
+        else
+            p += put_field( p, op, ts );
+    }
+    *p = '\0';
+
+    return ( uint8_t )( p - buff );
+}
+
+uint8_t ds1307_format_update( char* buff, const char* prog, TimeStruct* last,
+                              TimeStruct* ts )
+{
+    uint8_t col = 0, first = 0xFF, op;
+
+    while( ( op = ( uint8_t )*prog++ ) != 0 )
+    {
+        if( op < FIELD )
+        {
+            col++;
+        }
+        else if( changed( op, last, ts ) )
+        {
+            if( first == 0xFF )
+                first = col;
+            col += put_field( buff + col, op, ts );
+        }
+        else
+        {
+            col += widths[ op - FIELD ];
+        }
+    }
+
+    *last = *ts;
+
+    return ( first == 0xFF ) ? col : first;
+}
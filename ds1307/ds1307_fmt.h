@@ -0,0 +1,131 @@
+/**
+ * @file ds1307_fmt.h
+ *
+ * @brief Time formatting for the DS1307 library
+ *
+ * A pattern is compiled once into a program, a string of literal
+ * characters and field codes, and formatted in a single pass into a
+ * buffer of the caller.  Every field has a fixed width, so after one
+ * second only the fields that changed have to be written again, which
+ * keeps the refresh of an LCD line cheap.  Numbers come from a two digit
+ * table, no division is done.
+ *
+ * @author Richard Lowe
+ * @copyright AlphaLoewe
+ *
+ * @date 18/10/2026
+ *
+ * @version .01 - Initial
+ *
+ * @details
+ *
+ * Status: <XX% completed.>
+ *
+ * @par
+ *   The ready made programs below need no compiling, they are built from
+ *   the field codes by the preprocessor.  Patterns take the strftime
+ *   fields %Y %y %m %d %H %I %M %S %p %a %b and %%, names are English.
+ */
+
+#ifndef DS1307_FMT_H
+#define DS1307_FMT_H
+
+#include <stdint.h>
+#include "timelib.h"
+
+#define DS1307_FMT_MAX      32      /**< Longest output, without terminator */
+
+/**
+ *  @defgroup Format_Fields
+ *  @{
+ *  Field codes of a program, strftime field in brackets
+ */
+#define DS1307_F_YEAR       "\x80"  /**< 2015 ( %Y ) */
+#define DS1307_F_YEAR2      "\x81"  /**< 15 ( %y ) */
+#define DS1307_F_MONTH      "\x82"  /**< 01 - 12 ( %m ) */
+#define DS1307_F_DAY        "\x83"  /**< 01 - 31 ( %d ) */
+#define DS1307_F_HOUR       "\x84"  /**< 00 - 23 ( %H ) */
+#define DS1307_F_HOUR12     "\x85"  /**< 01 - 12 ( %I ) */
+#define DS1307_F_MINUTE     "\x86"  /**< 00 - 59 ( %M ) */
+#define DS1307_F_SECOND     "\x87"  /**< 00 - 59 ( %S ) */
+#define DS1307_F_AMPM       "\x88"  /**< AM, PM ( %p ) */
+#define DS1307_F_WEEKDAY    "\x89"  /**< Mon ( %a ) */
+#define DS1307_F_MONTHNAME  "\x8A"  /**< Jan ( %b ) */
+/**@}*/
+
+/**
+ *  @defgroup Format_Programs
+ *  @{
+ */
+/** 2015-02-01T21:42:05 */
+#define DS1307_FMT_ISO8601  DS1307_F_YEAR "-" DS1307_F_MONTH "-" DS1307_F_DAY "T" \
+                            DS1307_F_HOUR ":" DS1307_F_MINUTE ":" DS1307_F_SECOND
+/** Sun, 01 Feb 2015 21:42:05 GMT, RFC 1123 as used by HTTP */
+#define DS1307_FMT_HTTP     DS1307_F_WEEKDAY ", " DS1307_F_DAY " " DS1307_F_MONTHNAME " " \
+                            DS1307_F_YEAR " " DS1307_F_HOUR ":" DS1307_F_MINUTE ":" \
+                            DS1307_F_SECOND " GMT"
+/** 21:42:05 02/01/2015 */
+#define DS1307_FMT_24H      DS1307_F_HOUR ":" DS1307_F_MINUTE ":" DS1307_F_SECOND " " \
+                            DS1307_F_MONTH "/" DS1307_F_DAY "/" DS1307_F_YEAR
+/** 09:42:05 02/01/2015 */
+#define DS1307_FMT_12H      DS1307_F_HOUR12 ":" DS1307_F_MINUTE ":" DS1307_F_SECOND " " \
+                            DS1307_F_MONTH "/" DS1307_F_DAY "/" DS1307_F_YEAR
+/** 09:42:05 PM */
+#define DS1307_FMT_CLOCK12  DS1307_F_HOUR12 ":" DS1307_F_MINUTE ":" DS1307_F_SECOND " " \
+                            DS1307_F_AMPM
+/**@}*/
+
+/**
+ *  @brief Compiles a strftime like pattern
+ *
+ *  @param[out] prog - program, DS1307_FMT_MAX + 1 bytes at most
+ *  @param pattern - e.g. "%d.%m.%Y %H:%M"
+ *
+ *  @returns int
+ *    @retval 0 OK
+ *    @retval -1 unknown field
+ *    @retval -2 output would be longer than DS1307_FMT_MAX
+ *    @retval -3 literal byte of 0x80 or above, these code the fields
+ */
+int ds1307_fmt_compile( char* prog, const char* pattern );
+
+/**
+ *  @brief Formats a time
+ *
+ *  @param[out] buff - output, terminated
+ *  @param prog - program, @ref Format_Programs or compiled
+ *  @param ts - time
+ *
+ *  @code
+ *  char line[ DS1307_FMT_MAX + 1 ];
+ *
+ *  ds1307_format( line, DS1307_FMT_ISO8601, &ts );
+ *  @endcode
+ *
+ *  @returns uint8_t - length of output
+ */
+uint8_t ds1307_format( char* buff, const char* prog, TimeStruct* ts );
+
+/**
+ *  @brief Writes only the fields that changed
+ *
+ *  buff has to hold the output of the same program for last.
+ *
+ *  @code
+ *  ds1307_get_local_time( &now );
+ *  col = ds1307_format_update( line, DS1307_FMT_24H, &shown, &now );
+ *  if( line[ col ] )
+ *      Lcd_Out( 1, col + 1, line + col );
+ *  @endcode
+ *
+ *  @param[in,out] buff - output of last, becomes output of ts
+ *  @param[in,out] last - time in buff, becomes ts
+ *  @param ts - new time
+ *
+ *  @returns uint8_t - first column that changed, length of output when
+ *  nothing did
+ */
+uint8_t ds1307_format_update( char* buff, const char* prog, TimeStruct* last,
+                              TimeStruct* ts );
+
+#endif
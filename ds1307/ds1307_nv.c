@@ -0,0 +1,206 @@
+#include <string.h>
+#include "ds1307.h"
+#include "ds1307_nv.h"
+
+#define KEY_END     0x00
+#define KEY_BLANK   0xFF
+#define CRC_POLY    0x07
+
+static uint8_t mirror[ RAM_SIZE ];
+static uint8_t used;                // offset of the end of the last record
+static uint8_t dirty_lo = RAM_SIZE; // changed bytes, lo .. hi - 1
+static uint8_t dirty_hi;
+
+//private:
+static uint8_t nv_crc( uint8_t* p, uint8_t len );
+static uint8_t nv_find( uint8_t key );
+static void nv_dirty( uint8_t lo, uint8_t hi );
+static void nv_end( void );
+static void nv_remove( uint8_t off );
+
+// CRC-8, polynomial x^8 + x^2 + x + 1
+static uint8_t nv_crc( uint8_t* p, uint8_t len )
+{
+    uint8_t crc = 0, i;
+
+    while( len-- )
+    {
+        crc ^= *p++;
+        for( i = 0; i < 8; i++ )
+            crc = ( crc & 0x80 ) ? ( crc << 1 ) ^ CRC_POLY : crc << 1;
+    }
+
+    return crc;
+}
+
+// Offset of a record, RAM_SIZE when there is none
+static uint8_t nv_find( uint8_t key )
+{
+    uint8_t off = 0;
+
+    while( off < used )
+    {
+        if( mirror[ off ] == key )
+            return off;
+        off += mirror[ off + 1 ] + DS1307_NV_OVERHEAD;
+    }
+
+    return RAM_SIZE;
+}
+
+static void nv_dirty( uint8_t lo, uint8_t hi )
+{
+    if( lo < dirty_lo )
+        dirty_lo = lo;
+    if( hi > dirty_hi )
+        dirty_hi = hi;
+}
+
+// Marks the end of the list unless the records fill the RAM
+static void nv_end()
+{
+    if( used < RAM_SIZE )
+    {
+        mirror[ used ] = KEY_END;
+        nv_dirty( used, used + 1 );
+    }
+}
+
+static void nv_remove( uint8_t off )
+{
+    uint8_t len = mirror[ off + 1 ] + DS1307_NV_OVERHEAD;
+
+    memmove( &mirror[ off ], &mirror[ off + len ], used - off - len );
+    used -= len;
+    nv_dirty( off, used );
+    nv_end();
+}
+
+uint8_t ds1307_nv_mount()
+{
+    uint8_t off = 0, count = 0, key, len, lost = RAM_SIZE;
+
+    ds1307_read_ram_at( RAM_START, mirror, RAM_SIZE );
+    dirty_lo = RAM_SIZE;
+    dirty_hi = 0;
+
+    while( off + DS1307_NV_OVERHEAD <= RAM_SIZE )
+    {
+        key = mirror[ off ];
+        len = mirror[ off + 1 ];
+
+        if( key == KEY_END || key == KEY_BLANK || len == 0
+            || len > RAM_SIZE - DS1307_NV_OVERHEAD - off )
+            break;
+
+        len += DS1307_NV_OVERHEAD;
+
+        // a record with a bad CRC is cut out, the ones after it move down
+        if( nv_crc( &mirror[ off ], len - 1 ) != mirror[ off + len - 1 ] )
+        {
+            memmove( &mirror[ off ], &mirror[ off + len ], RAM_SIZE - off - len );
+            memset( &mirror[ RAM_SIZE - len ], KEY_END, len );
+            if( off < lost )
+                lost = off;
+            continue;
+        }
+
+        off += len;
+        count++;
+    }
+
+    // an unreadable tail is dropped, the next flush writes the new end
+    used = off;
+    if( lost < used )
+        nv_dirty( lost, used );
+    if( used < RAM_SIZE && ( mirror[ used ] != KEY_END || lost < RAM_SIZE ) )
+        nv_end();
+
+    return count;
+}
+
+int ds1307_nv_get( uint8_t key, void* data, uint8_t size )
+{
+    uint8_t off = nv_find( key ), len;
+
+    if( off == RAM_SIZE )
+        return -1;
+
+    len = mirror[ off + 1 ];
+    memcpy( data, &mirror[ off + 2 ], ( len < size ) ? len : size );
+
+    return len;
+}
+
+int ds1307_nv_put( uint8_t key, const void* data, uint8_t size )
+{
+    uint8_t off, room;
+
+    if( key == KEY_END || key == KEY_BLANK || size == 0
+        || size > RAM_SIZE - DS1307_NV_OVERHEAD )
+        return -1;
+
+    off = nv_find( key );
+
+    if( off != RAM_SIZE && mirror[ off + 1 ] == size )
+    {
+        // same length, only the data and its CRC change
+        if( memcmp( &mirror[ off + 2 ], data, size ) == 0 )
+            return 0;
+    }
+    else
+    {
+        room = RAM_SIZE - used;
+        if( off != RAM_SIZE )
+            room += mirror[ off + 1 ] + DS1307_NV_OVERHEAD;
+        if( room < size + DS1307_NV_OVERHEAD )
+            return -2;
+
+        if( off != RAM_SIZE )
+            nv_remove( off );
+
+        off = used;
+        used += size + DS1307_NV_OVERHEAD;
+        mirror[ off ]     = key;
+        mirror[ off + 1 ] = size;
+        nv_end();
+    }
+
+    memcpy( &mirror[ off + 2 ], data, size );
+    mirror[ off + size + 2 ] = nv_crc( &mirror[ off ], size + 2 );
+    nv_dirty( off, off + size + DS1307_NV_OVERHEAD );
+
+    return 0;
+}
+
+int ds1307_nv_erase( uint8_t key )
+{
+    uint8_t off = nv_find( key );
+
+    if( off == RAM_SIZE )
+        return -1;
+
+    nv_remove( off );
+
+    return 0;
+}
+
+uint8_t ds1307_nv_free()
+{
+    return ( RAM_SIZE - used > DS1307_NV_OVERHEAD ) ? RAM_SIZE - used - DS1307_NV_OVERHEAD : 0;
+}
+
+uint8_t ds1307_nv_flush()
+{
+    uint8_t n;
+
+    if( dirty_lo >= dirty_hi )
+        return 0;
+
+    n = dirty_hi - dirty_lo;
+    ds1307_write_ram_at( RAM_START + dirty_lo, &mirror[ dirty_lo ], n );
+    dirty_lo = RAM_SIZE;
+    dirty_hi = 0;
+
+    return n;
+}
@@ -0,0 +1,106 @@
+/**
+ * @file ds1307_nv.h
+ *
+ * @brief Record store in the battery backed RAM of the DS1307
+ *
+ * Keeps small records, e.g. calibration, counters or radio state, under
+ * a one byte key in the 56 bytes of RTC RAM.  The whole RAM is read once
+ * into a mirror, after that gets never touch the bus.  Puts change the
+ * mirror and widen a dirty range, ds1307_nv_flush writes that range in a
+ * single burst, however many records changed.
+ *
+ * @author Richard Lowe
+ * @copyright AlphaLoewe
+ *
+ * @date 18/10/2026
+ *
+ * @version .01 - Initial
+ *
+ * @details
+ *
+ * Status: <XX% completed.>
+ *
+ * @par
+ *   Records follow each other from RAM_START: key, length, data and a
+ *   CRC-8 of all three, 3 bytes overhead each.  A key of 0 ends the list.
+ *   Mounting drops a record whose CRC fails, e.g. after power was lost
+ *   during a flush, and moves the records after it down.  It stops at the
+ *   first key or length that cannot be a record, e.g. on a new battery,
+ *   and treats the rest of the RAM as free.
+ */
+
+#ifndef DS1307_NV_H
+#define DS1307_NV_H
+
+#include <stdint.h>
+
+#define DS1307_NV_OVERHEAD  3       /**< Bytes added to each record */
+
+/**
+ *  @brief Reads the RTC RAM into the mirror
+ *
+ *  One burst read of all 56 bytes.  Call once after ds1307_init.
+ *
+ *  @returns uint8_t - number of valid records found
+ */
+uint8_t ds1307_nv_mount( void );
+
+/**
+ *  @brief Copies a record from the mirror
+ *
+ *  @param key - 1 .. 254
+ *  @param[out] data - record data
+ *  @param size - room in data, longer records are cut
+ *
+ *  @returns int
+ *    @retval >=0 length of the record
+ *    @retval -1 no such record
+ */
+int ds1307_nv_get( uint8_t key, void* data, uint8_t size );
+
+/**
+ *  @brief Stores a record in the mirror
+ *
+ *  A record of the same length is changed in place, otherwise the old
+ *  one is removed and the new one added at the end.  Nothing reaches the
+ *  RTC before ds1307_nv_flush.
+ *
+ *  @code
+ *  ds1307_nv_put( KEY_BOOTS, &boots, sizeof( boots ) );
+ *  ds1307_nv_put( KEY_CHANNEL, &channel, sizeof( channel ) );
+ *  ds1307_nv_flush();     // one transaction for both
+ *  @endcode
+ *
+ *  @param key - 1 .. 254
+ *  @param data - record data
+ *  @param size - 1 .. 53
+ *
+ *  @returns int
+ *    @retval 0 OK
+ *    @retval -1 bad key or size
+ *    @retval -2 not enough free space, store unchanged
+ */
+int ds1307_nv_put( uint8_t key, const void* data, uint8_t size );
+
+/**
+ *  @brief Removes a record from the mirror
+ *
+ *  @returns int
+ *    @retval 0 OK
+ *    @retval -1 no such record
+ */
+int ds1307_nv_erase( uint8_t key );
+
+/**
+ *  @brief Bytes left for data of one more record
+ */
+uint8_t ds1307_nv_free( void );
+
+/**
+ *  @brief Writes the changed part of the mirror
+ *
+ *  @returns uint8_t - bytes written in one burst, 0 when nothing changed
+ */
+uint8_t ds1307_nv_flush( void );
+
+#endif
@@ -0,0 +1,320 @@
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+#include "ds1307_sim.h"
+
+#define REG( r )        ( sim->regs[ r ] )
+
+#define CH              0x80        // seconds register, oscillator halted
+#define MODE12          0x40        // hours register, 12 hour mode
+#define PM              0x20        // hours register, PM in 12 hour mode
+#define CONTROL         0x07
+#define CONTROL_MASK    0x93        // OUT, SQWE, RS1, RS0
+#define SQWE            0x10
+#define OUT             0x80
+#define RAM_FIRST       0x08
+
+#define US_PER_SECOND   1000000UL
+#define SECONDS_IN_DAY  86400UL
+
+static const uint8_t month_days[ 12 ] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+
+static ds1307_sim_t* bus_sim;       // target of TWI_*
+
+//private:
+static uint8_t dec( uint8_t bcd );
+static uint8_t bcd( uint8_t dec );
+static uint8_t sqw_1hz( ds1307_sim_t* sim );
+static void next_day( ds1307_sim_t* sim );
+static void add_seconds( ds1307_sim_t* sim, uint32_t s );
+static void timer_run( ds1307_sim_t* sim, double us );
+static void tick( ds1307_sim_t* sim );
+static void sim_write( ds1307_sim_t* sim, uint8_t val );
+
+static uint8_t dec( uint8_t b )
+{
+    return ( b >> 4 ) * 10 + ( b & 0x0F );
+}
+
+static uint8_t bcd( uint8_t d )
+{
+    return ( ( d / 10 ) << 4 ) | ( d % 10 );
+}
+
+static uint8_t sqw_1hz( ds1307_sim_t* sim )
+{
+    return ( REG( CONTROL ) & ( SQWE | 0x03 ) ) == SQWE;
+}
+
+// Day of week, date, month and year, years 00 - 99, leap every 4th
+static void next_day( ds1307_sim_t* sim )
+{
+    uint8_t md = dec( REG( 4 ) ), mo = dec( REG( 5 ) ), yy = dec( REG( 6 ) );
+    uint8_t last;
+
+    REG( 3 ) = ( REG( 3 ) & 0x07 ) % 7 + 1;
+
+    last = ( mo >= 1 && mo <= 12 ) ? month_days[ mo - 1 ] : 31;
+    if( mo == 2 && ( yy & 3 ) == 0 )
+        last++;
+
+    if( ++md > last )
+    {
+        md = 1;
+        if( ++mo > 12 )
+        {
+            mo = 1;
+            yy = ( yy + 1 ) % 100;
+        }
+    }
+
+    REG( 4 ) = bcd( md );
+    REG( 5 ) = bcd( mo );
+    REG( 6 ) = bcd( yy );
+}
+
+// Time of day in seconds, day carries walk the calendar a day at a time
+static void add_seconds( ds1307_sim_t* sim, uint32_t s )
+{
+    uint8_t hours = REG( 2 ), hh;
+    uint32_t t, days;
+
+    if( hours & MODE12 )
+    {
+        hh = dec( hours & 0x1F ) % 12;
+        if( hours & PM )
+            hh += 12;
+    }
+    else
+    {
+        hh = dec( hours & 0x3F );
+    }
+
+    days = s / SECONDS_IN_DAY;
+    t = dec( REG( 0 ) & 0x7F ) + dec( REG( 1 ) & 0x7F ) * 60UL + hh * 3600UL
+        + s % SECONDS_IN_DAY;
+    if( t >= SECONDS_IN_DAY )
+    {
+        t -= SECONDS_IN_DAY;
+        days++;
+    }
+
+    while( days-- )
+        next_day( sim );
+
+    hh = ( uint8_t )( t / 3600 );
+    REG( 0 ) = bcd( t % 60 );
+    REG( 1 ) = bcd( ( t / 60 ) % 60 );
+
+    if( hours & MODE12 )
+    {
+        REG( 2 ) = MODE12 | ( ( hh >= 12 ) ? PM : 0 )
+                   | bcd( ( hh % 12 == 0 ) ? 12 : hh % 12 );
+    }
+    else
+    {
+        REG( 2 ) = bcd( hh );
+    }
+
+    sim->seconds += s;
+}
+
+// The MCU timer runs off its own oscillator, timer_ppb away from the RTC
+static void timer_run( ds1307_sim_t* sim, double us )
+{
+    double t = us * 1e-6 * sim->timer_hz * ( 1.0 + sim->timer_ppb * 1e-9 ) + sim->timer_frac;
+    double whole = floor( t );
+
+    sim->timer_ticks += ( uint64_t )whole;
+    sim->timer_frac   = t - whole;
+}
+
+// One second boundary: the registers count and SQW falls
+static void tick( ds1307_sim_t* sim )
+{
+    add_seconds( sim, 1 );
+    if( sim->on_sqw != NULL && sqw_1hz( sim ) )
+        sim->on_sqw( sim->sqw_ctx );
+}
+
+static void sim_write( ds1307_sim_t* sim, uint8_t val )
+{
+    if( sim->pointer == CONTROL )
+        val &= CONTROL_MASK;
+
+    REG( sim->pointer ) = val;
+
+    // writing the seconds restarts the countdown chain
+    if( sim->pointer == 0 )
+        sim->sub_us = 0;
+
+    sim->pointer = ( sim->pointer + 1 ) & ( DS1307_SIM_REGS - 1 );
+}
+
+void ds1307_sim_init( ds1307_sim_t* sim )
+{
+    uint32_t x = 1307;
+    uint8_t i;
+
+    memset( sim, 0, sizeof( *sim ) );
+
+    REG( 0 ) = CH;
+    REG( 3 ) = 0x01;
+    REG( 4 ) = 0x01;
+    REG( 5 ) = 0x01;
+    REG( CONTROL ) = 0x03;
+
+    for( i = RAM_FIRST; i < DS1307_SIM_REGS; i++ )
+    {
+        x = x * 1103515245UL + 12345;
+        REG( i ) = ( uint8_t )( x >> 16 );
+    }
+
+    bus_sim = sim;
+}
+
+void ds1307_sim_on_sqw( ds1307_sim_t* sim, void ( *cb )( void* ctx ), void* ctx )
+{
+    sim->on_sqw  = cb;
+    sim->sqw_ctx = ctx;
+}
+
+void ds1307_sim_advance_us( ds1307_sim_t* sim, uint32_t us )
+{
+    uint32_t step;
+
+    if( REG( 0 ) & CH )
+    {
+        timer_run( sim, us );
+        return;
+    }
+
+    while( sim->sub_us + us >= US_PER_SECOND )
+    {
+        step = US_PER_SECOND - sim->sub_us;
+        timer_run( sim, step );
+        us -= step;
+        sim->sub_us = 0;
+        tick( sim );
+    }
+
+    timer_run( sim, us );
+    sim->sub_us += us;
+}
+
+void ds1307_sim_advance( ds1307_sim_t* sim, uint32_t seconds )
+{
+    uint32_t step;
+
+    if( REG( 0 ) & CH )
+    {
+        timer_run( sim, seconds * 1e6 );
+        return;
+    }
+
+    if( sim->on_sqw == NULL || !sqw_1hz( sim ) )
+    {
+        timer_run( sim, seconds * 1e6 );
+        add_seconds( sim, seconds );
+        return;
+    }
+
+    // the edge comes when the current second ends, not a whole step later
+    step = US_PER_SECOND - sim->sub_us;
+    while( seconds-- )
+    {
+        timer_run( sim, step );
+        tick( sim );
+        timer_run( sim, US_PER_SECOND - step );
+    }
+}
+
+uint32_t ds1307_sim_timer( ds1307_sim_t* sim )
+{
+    return ( uint32_t )sim->timer_ticks;
+}
+
+uint8_t ds1307_sim_sqw( ds1307_sim_t* sim )
+{
+    if( !( REG( CONTROL ) & SQWE ) )
+        return ( REG( CONTROL ) & OUT ) ? 1 : 0;
+
+    if( REG( 0 ) & CH )
+        return 0;
+
+    // 1 Hz falls with the seconds register, faster rates are not modelled
+    return ( sim->sub_us >= US_PER_SECOND / 2 ) ? 1 : 0;
+}
+
+void TWI_Start()
+{
+    ds1307_sim_t* sim = bus_sim;
+
+    if( !sim->active )
+        sim->transactions++;
+
+    sim->active   = 1;
+    sim->phase    = 0;
+    sim->selected = 0;
+    memcpy( sim->latch, sim->regs, sizeof( sim->latch ) );
+}
+
+void TWI_Stop()
+{
+    bus_sim->active = 0;
+}
+
+void TWI_Write( uint8_t data_ )
+{
+    ds1307_sim_t* sim = bus_sim;
+
+    sim->bytes++;
+
+    if( sim->phase == 0 )
+    {
+        sim->selected = ( data_ & 0xFE ) == DS1307_SIM_ADDRESS;
+        sim->reading  = data_ & 0x01;
+        sim->phase    = 1;
+    }
+    else if( !sim->selected || sim->reading )
+    {
+        return;
+    }
+    else if( sim->phase == 1 )
+    {
+        sim->pointer = data_ & ( DS1307_SIM_REGS - 1 );
+        sim->phase   = 2;
+    }
+    else
+    {
+        sim_write( sim, data_ );
+    }
+}
+
+uint8_t TWI_Read( uint8_t ack )
+{
+    ds1307_sim_t* sim = bus_sim;
+    uint8_t val;
+
+    ( void )ack;                    // the model always has more to send
+    sim->bytes++;
+
+    if( !sim->selected || !sim->reading )
+        return 0xFF;
+
+    val = ( sim->pointer < sizeof( sim->latch ) ) ? sim->latch[ sim->pointer ]
+                                                  : REG( sim->pointer );
+    sim->pointer = ( sim->pointer + 1 ) & ( DS1307_SIM_REGS - 1 );
+
+    return val;
+}
+
+uint8_t Bcd2Dec( uint8_t bcdnum )
+{
+    return dec( bcdnum );
+}
+
+uint8_t Dec2Bcd( uint8_t decnum )
+{
+    return bcd( decnum );
+}
@@ -0,0 +1,137 @@
+/**
+ * @file ds1307_sim.h
+ *
+ * @brief Register level DS1307 model for host builds
+ *
+ * With DS1307_HOST defined the driver's TWI_* and BCD calls come from
+ * here and talk to this model instead of a chip.  It has the 64 byte
+ * register map with BCD time registers, the CH bit, 12 and 24 hour mode,
+ * the control register and the 56 bytes of RAM.  Time is simulated:
+ * ds1307_sim_advance_us moves it on in small steps, ds1307_sim_advance
+ * in whole seconds, which runs decades of calendar in well under a
+ * second.  The model counts every bus transaction and byte, and runs
+ * a free running MCU timer whose oscillator may be off from the RTC.
+ *
+ * @code
+ *   gcc -O2 -DDS1307_HOST -o ds1307_sim_demo ds1307_sim_demo.c ds1307_sim.c ds1307.c \
+ *       ds1307_tz.c ds1307_fmt.c ds1307_nv.c ds1307_ts.c timelib_epoch.c -lm
+ * @endcode
+ *
+ * @author Richard Lowe
+ * @copyright AlphaLoewe
+ *
+ * @date 18/10/2026
+ *
+ * @version .01 - Initial
+ *
+ * @details
+ *
+ * Status: <XX% completed.>
+ *
+ * @par
+ *   As on the chip, reads of the time registers come from a copy taken at
+ *   each START, writing the seconds register restarts the second, the
+ *   register pointer wraps from 0x3F to 0x00 and the year counts leap
+ *   years every 4 years.  The SQW pin is modelled at 1 Hz only: it falls
+ *   when the seconds register changes and rises half a second later.
+ *   With a 1 Hz callback set, ds1307_sim_advance steps second by second
+ *   so every edge is delivered, otherwise it jumps over whole days.  The
+ *   DS1307_I2C_INTERFACE build is not modelled.
+ */
+
+#ifndef DS1307_SIM_H
+#define DS1307_SIM_H
+
+#include <stdint.h>
+
+#define DS1307_SIM_REGS     64
+#define DS1307_SIM_ADDRESS  0xD0    /**< 8 bit write address */
+
+/**
+ *  @struct Model state
+ */
+typedef struct
+{
+    uint8_t regs[ DS1307_SIM_REGS ];    /**< Time, control and RAM */
+    uint8_t latch[ 7 ];                 /**< Time registers as of the last START */
+    uint8_t pointer;                    /**< Register pointer */
+    uint8_t phase;                      /**< 0 address, 1 pointer, 2 data */
+    uint8_t selected;                   /**< Addressed by the last START */
+    uint8_t reading;
+    uint8_t active;                     /**< Between START and STOP */
+
+    uint32_t sub_us;                    /**< Time into the current second */
+    uint32_t seconds;                   /**< Seconds the oscillator ran */
+
+    uint32_t transactions;              /**< STARTs after a STOP */
+    uint32_t bytes;                     /**< Bytes on the bus, addresses included */
+
+    void ( *on_sqw )( void* ctx );      /**< Falling edge of the 1 Hz output */
+    void* sqw_ctx;
+
+    uint32_t timer_hz;                  /**< MCU timer rate, 0 stops it */
+    int32_t timer_ppb;                  /**< MCU oscillator error against the RTC */
+    uint64_t timer_ticks;
+    double timer_frac;
+} ds1307_sim_t;
+
+/**
+ *  @brief Sets up the model and makes it the target of TWI_*
+ *
+ *  Registers get a power up state: oscillator halted (CH set), 00:00:00
+ *  on 01/01/00 in 24 hour mode, SQW off, RAM filled with a fixed
+ *  pseudo random pattern.
+ */
+void ds1307_sim_init( ds1307_sim_t* sim );
+
+/**
+ *  @brief Calls cb on every falling edge of the 1 Hz SQW output
+ *
+ *  @code
+ *  static void edge( void* ctx ) { ds1307_sqw_isr(); }
+ *
+ *  ds1307_sim_on_sqw( &sim, edge, NULL );
+ *  @endcode
+ */
+void ds1307_sim_on_sqw( ds1307_sim_t* sim, void ( *cb )( void* ctx ), void* ctx );
+
+/**
+ *  @brief Lets time pass in microseconds
+ */
+void ds1307_sim_advance_us( ds1307_sim_t* sim, uint32_t us );
+
+/**
+ *  @brief Lets whole seconds pass
+ *
+ *  Nothing happens while the oscillator is halted.
+ */
+void ds1307_sim_advance( ds1307_sim_t* sim, uint32_t seconds );
+
+/**
+ *  @brief Count of a free running MCU timer
+ *
+ *  The timer runs at timer_hz, skewed by timer_ppb, whether or not the
+ *  RTC oscillator runs.  Both may be changed at any time, e.g. to play a
+ *  temperature drift.
+ */
+uint32_t ds1307_sim_timer( ds1307_sim_t* sim );
+
+/**
+ *  @brief Level of the SQW / OUT pin
+ */
+uint8_t ds1307_sim_sqw( ds1307_sim_t* sim );
+
+/**
+ *  @defgroup Host_Bus
+ *  @{
+ *  Stand ins for the mikroC TWI and Conversions libraries
+ */
+void TWI_Start( void );
+void TWI_Stop( void );
+void TWI_Write( uint8_t data_ );
+uint8_t TWI_Read( uint8_t ack );
+uint8_t Bcd2Dec( uint8_t bcdnum );
+uint8_t Dec2Bcd( uint8_t decnum );
+/**@}*/
+
+#endif
@@ -0,0 +1,336 @@
+/**
+ * @file ds1307_sim_demo.c
+ *
+ * @brief Runs the DS1307 driver against the register level model
+ *
+ * Starts the chip from power up with the oscillator halted, then counts
+ * the bus transactions of a main loop reading three time strings four
+ * times a second, with the SQW driven cache and without it.  Timestamps
+ * of a skewed MCU timer are checked against the model's time.  The 12 hour
+ * mode is checked over two days.  GMT time is checked every hour from
+ * 2000 to 2099, local time of three zones against the host's tz database
+ * from 2008 on, as the rule tables do not keep older laws.  Last the RAM
+ * record store is saved and mounted again, then mounted with the CRC of
+ * its middle record broken.
+ *
+ * @code
+ *   gcc -O2 -DDS1307_HOST -o ds1307_sim_demo ds1307_sim_demo.c ds1307_sim.c ds1307.c \
+ *       ds1307_tz.c ds1307_fmt.c ds1307_nv.c ds1307_ts.c timelib_epoch.c -lm
+ *   ds1307_sim_demo
+ * @endcode
+ *
+ * @author Richard Lowe
+ * @copyright AlphaLoewe
+ *
+ * @date 18/10/2026
+ *
+ * @version .01 - Initial
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "ds1307.h"
+#include "ds1307_nv.h"
+#include "ds1307_ts.h"
+
+#define Y2000       946684800UL     // 2000-01-01 00:00:00 GMT
+#define Y2008       1199145600UL    // current US and AU rules from here on
+#define Y2100       4102444800UL
+#define POLL_US     250000UL
+
+static ds1307_sim_t sim;
+static unsigned long failures;
+
+static void fail( const char* what, uint32_t t, long got, long want )
+{
+    if( failures++ < 10 )
+        printf( "  FAIL %s at %lu: %ld, expected %ld\n", what, ( unsigned long )t, got, want );
+}
+
+static void edge( void* ctx )
+{
+    ( void )ctx;
+    ds1307_sqw_isr();
+}
+
+static void ts_edge( void* ctx )
+{
+    ( void )ctx;
+    ds1307_ts_sqw_isr();
+}
+
+static uint32_t host_timer( void )
+{
+    return ds1307_sim_timer( &sim );
+}
+
+static void start( int16_t offset, const ds1307_tz_rule_t* rule, uint8_t output,
+                   uint8_t hour24 )
+{
+    ds1307_config_t cfg;
+
+    cfg.tz_offset     = offset;
+    cfg.dst_rule      = rule;
+    cfg.output_mode   = output;
+    cfg.hour24_enable = hour24;
+    ds1307_init( &cfg );
+}
+
+static void power_up( void )
+{
+    uint32_t before;
+
+    ds1307_sim_init( &sim );
+    ds1307_sim_advance( &sim, 10 );
+    before = sim.seconds;
+
+    start( 0, DS1307_TZ_NONE, DS1307_SQW_1HZ, 1 );
+    ds1307_set_time_GMT( Y2000 + 12345 );
+    ds1307_sim_advance( &sim, 10 );
+
+    printf( "power up: halted for %lu s, runs after init: %s\n",
+            ( unsigned long )before,
+            ( uint32_t )ds1307_get_GMT_unix_time() == Y2000 + 12355 ? "yes" : "no" );
+    if( before != 0 )
+        fail( "halted oscillator", 0, before, 0 );
+}
+
+// One hour of a main loop reading three strings every 250 ms
+static void transactions( uint8_t output )
+{
+    uint32_t t0, reads = 0, i;
+
+    ds1307_sim_on_sqw( &sim, edge, NULL );
+    start( -300, &ds1307_tz_us, output, 1 );
+    ds1307_set_time_GMT( 1700000000UL );
+    t0 = sim.transactions;
+
+    for( i = 0; i < 3600UL * 1000000 / POLL_US; i++ )
+    {
+        ds1307_sim_advance_us( &sim, POLL_US );
+        ds1307_get_local_time_str( MODE24HOUR );
+        ds1307_get_GMT_time_str( MODE24HOUR );
+        ds1307_get_http_gmt_str();
+        reads += 3;
+    }
+
+    printf( "  %-16s %6lu reads, %6lu transactions\n",
+            output == DS1307_SQW_1HZ ? "SQW 1 Hz cache:" : "no cache:",
+            ( unsigned long )reads, ( unsigned long )( sim.transactions - t0 ) );
+
+    if( ( uint32_t )ds1307_get_GMT_unix_time() != 1700000000UL + 3600 )
+        fail( "time after one hour", 3600, ds1307_get_GMT_unix_time(), 1700000000L + 3600 );
+
+    ds1307_sim_on_sqw( &sim, NULL, NULL );
+}
+
+/*
+ * Twenty minutes of a 1 MHz timer 150 ppm fast, then 40 ppm slow, read at
+ * uneven times.  Errors are taken once the estimate had 30 s to settle.
+ */
+static void timestamps( void )
+{
+    static const int32_t skew[ 2 ] = { 150000, -40000 };
+    ds1307_ts_t ts, last = { 0, 0 };
+    uint32_t s0, t0 = 1700000000UL, x = 1, phase, since, tr0, reads = 0;
+    long err, worst;
+
+    sim.timer_hz = 1000000;
+    ds1307_sim_on_sqw( &sim, ts_edge, NULL );
+    start( 0, DS1307_TZ_NONE, DS1307_SQW_1HZ, 1 );
+    ds1307_set_time_GMT( t0 );
+    s0 = sim.seconds;
+    ds1307_ts_init( sim.timer_hz, host_timer );
+    tr0 = sim.transactions;
+
+    printf( "timestamps, 1 MHz timer\n" );
+
+    for( phase = 0; phase < 2; phase++ )
+    {
+        sim.timer_ppb = skew[ phase ];
+        since = sim.seconds;
+        worst = 0;
+
+        while( sim.seconds - since < 600 )
+        {
+            x = x * 1103515245UL + 12345;
+            ds1307_sim_advance_us( &sim, ( x >> 8 ) % 500000 + 1 );
+
+            if( ds1307_ts_gmt( &ts ) != 0 )
+                continue;
+            reads++;
+
+            err = ( long )( ts.sec - ( t0 + sim.seconds - s0 ) ) * 1000000L
+                  + ( long )ts.usec - ( long )sim.sub_us;
+            if( sim.seconds - since >= 30 && labs( err ) > labs( worst ) )
+                worst = err;
+
+            if( ts.sec < last.sec || ( ts.sec == last.sec && ts.usec < last.usec ) )
+                fail( "monotonic", ts.sec, ts.usec, last.usec );
+            last = ts;
+        }
+
+        printf( "  skew %+7.1f ppm: estimate %+7.1f ppm, worst error %ld us\n",
+                skew[ phase ] / 1000.0, ds1307_ts_drift() / 1000.0, worst );
+
+        if( labs( worst ) > 1000000L / ( long )sim.timer_hz + 4 )
+            fail( "timestamp error", phase, worst, 0 );
+        if( labs( ds1307_ts_drift() - skew[ phase ] ) > 1000 )
+            fail( "drift estimate", phase, ds1307_ts_drift(), skew[ phase ] );
+    }
+
+    printf( "  %lu reads, %lu bus transactions\n", ( unsigned long )reads,
+            ( unsigned long )( sim.transactions - tr0 ) );
+
+    ds1307_sim_on_sqw( &sim, NULL, NULL );
+    sim.timer_hz = 0;
+}
+
+static void hour12( void )
+{
+    uint32_t t;
+
+    start( 0, DS1307_TZ_NONE, DS1307_TGL_OUT, 1 );
+    ds1307_set_time_GMT( Y2000 + 13 * 3600UL );
+    start( 0, DS1307_TZ_NONE, DS1307_TGL_OUT, 0 );
+
+    printf( "12 hour mode: hours register 0x%02X after switching at 13:00\n",
+            sim.regs[2] );
+
+    for( t = Y2000 + 13 * 3600UL; t < Y2000 + 2 * 86400UL; t += 600 )
+    {
+        if( ( uint32_t )ds1307_get_GMT_unix_time() != t )
+            fail( "12 hour read", t, ds1307_get_GMT_unix_time(), t );
+        ds1307_sim_advance( &sim, 600 );
+    }
+
+    start( 0, DS1307_TZ_NONE, DS1307_TGL_OUT, 1 );
+}
+
+// Every hour of the century, local time against the host tz database
+static void decades( const char* name, int16_t offset, const ds1307_tz_rule_t* rule )
+{
+    struct tm tm;
+    time_t tt;
+    clock_t c0;
+    uint32_t t, gmt, local, checks = 0;
+
+    setenv( "TZ", name, 1 );
+    tzset();
+
+    start( offset, rule, DS1307_TGL_OUT, 1 );
+    ds1307_set_time_GMT( Y2000 );
+    c0 = clock();
+
+    for( t = Y2000; t < Y2100; t += 3600 )
+    {
+        gmt   = ( uint32_t )ds1307_get_GMT_unix_time();
+        local = ( uint32_t )ds1307_get_local_unix_time();
+
+        tt = t;
+        localtime_r( &tt, &tm );
+
+        if( gmt != t )
+            fail( "GMT", t, gmt, t );
+        else if( t >= Y2008 && ( long )( int32_t )( local - gmt ) != tm.tm_gmtoff )
+            fail( name, t, ( long )( int32_t )( local - gmt ), tm.tm_gmtoff );
+
+        checks++;
+        ds1307_sim_advance( &sim, 3600 );
+    }
+
+    printf( "  %-20s %lu hours checked in %.2f s\n", name, ( unsigned long )checks,
+            ( double )( clock() - c0 ) / CLOCKS_PER_SEC );
+}
+
+static void nvram( void )
+{
+    uint32_t boots = 41, t0;
+    uint8_t channel = 76, n;
+    int16_t cal[3] = { 12, -3, 250 }, back[3];
+
+    n = ds1307_nv_mount();
+    printf( "RAM store: %u records on a new chip, %u bytes free\n", n, ds1307_nv_free() );
+
+    ds1307_nv_put( 1, &boots, sizeof( boots ) );
+    ds1307_nv_put( 2, &channel, sizeof( channel ) );
+    ds1307_nv_put( 3, cal, sizeof( cal ) );
+    t0 = sim.transactions;
+    n = ds1307_nv_flush();
+    printf( "  3 records saved: %u bytes, %lu transaction\n", n,
+            ( unsigned long )( sim.transactions - t0 ) );
+
+    boots++;
+    ds1307_nv_put( 1, &boots, sizeof( boots ) );
+    t0 = sim.transactions;
+    n = ds1307_nv_flush();
+    printf( "  counter update: %u bytes, %lu transaction\n", n,
+            ( unsigned long )( sim.transactions - t0 ) );
+
+    boots = 0;
+    n = ds1307_nv_mount();
+    ds1307_nv_get( 1, &boots, sizeof( boots ) );
+    ds1307_nv_get( 3, back, sizeof( back ) );
+    printf( "  mounted again: %u records, boots %lu\n", n, ( unsigned long )boots );
+
+    if( n != 3 || boots != 42 || memcmp( cal, back, sizeof( cal ) ) != 0 )
+        fail( "RAM store", 0, n, 3 );
+
+    // power lost while the channel was written, its CRC no longer fits
+    sim.regs[ RAM_START + sizeof( boots ) + DS1307_NV_OVERHEAD
+              + sizeof( channel ) + 2 ] ^= 0x5A;
+
+    boots = 0;
+    memset( back, 0, sizeof( back ) );
+    n = ds1307_nv_mount();
+    ds1307_nv_get( 1, &boots, sizeof( boots ) );
+    ds1307_nv_get( 3, back, sizeof( back ) );
+    printf( "  bad CRC: %u records, boots %lu", n, ( unsigned long )boots );
+
+    if( n != 2 || boots != 42 || ds1307_nv_get( 2, &channel, sizeof( channel ) ) != -1
+        || memcmp( cal, back, sizeof( cal ) ) != 0 )
+        fail( "bad CRC", 0, n, 2 );
+
+    // the records after the bad one moved down, the flush makes it stick
+    t0 = sim.transactions;
+    n = ds1307_nv_flush();
+    printf( ", %u bytes written in %lu transaction\n", n,
+            ( unsigned long )( sim.transactions - t0 ) );
+
+    boots = 0;
+    memset( back, 0, sizeof( back ) );
+    n = ds1307_nv_mount();
+    ds1307_nv_get( 1, &boots, sizeof( boots ) );
+    ds1307_nv_get( 3, back, sizeof( back ) );
+    printf( "  mounted again: %u records, boots %lu\n", n, ( unsigned long )boots );
+
+    if( n != 2 || boots != 42 || memcmp( cal, back, sizeof( cal ) ) != 0 )
+        fail( "RAM store after repair", 0, n, 2 );
+}
+
+int main( void )
+{
+    power_up();
+
+    printf( "bus transactions, 1 hour, 3 strings every 250 ms\n" );
+    transactions( DS1307_TGL_OUT );
+    transactions( DS1307_SQW_1HZ );
+
+    timestamps();
+
+    hour12();
+
+    printf( "GMT and local time 2000 - 2099\n" );
+    decades( "America/New_York", -300, &ds1307_tz_us );
+    decades( "Europe/Berlin", 60, &ds1307_tz_eu );
+    decades( "Australia/Adelaide", 570, &ds1307_tz_au );
+
+    nvram();
+
+    printf( "%lu failures\n", failures );
+
+    return failures != 0;
+}
@@ -8,9 +8,9 @@ void sys_init( void );
 void sys_init()
 {
     ds1307_config_t conf;
-    conf.time_zone = -8;
-    conf.dst_enable = TRUE;
-    conf.config = 0;
+    conf.tz_offset = -8 * 60;
+    conf.dst_rule = &ds1307_tz_us;
+    conf.output_mode = 0;
     
     ds1307_init( &conf );
 
@@ -0,0 +1,221 @@
+#include <stddef.h>
+#include "ds1307.h"
+#include "ds1307_ts.h"
+
+#define US_PER_SECOND   1000000UL
+#define RATE_SHIFT      4           // rate kept in 1/16 ticks per second
+#define FILTER_SHIFT    3           // each second moves the rate 1/8 of the way
+#define PPB_PER_RATE    125         // 1000 / 16, halved by one more shift
+#define SCALE_TOP       0x80000000UL
+
+static uint32_t ( *timer )( void );
+static uint32_t nominal;            // timer ticks per second as specified
+static uint32_t nominal_scale;
+static uint8_t nominal_shift;
+
+// Written by the edge ISR, read under edge_seq
+static volatile uint32_t rate;      // measured ticks per RTC second << RATE_SHIFT
+static volatile uint32_t scale;     // microseconds per tick, scale >> shift
+static volatile uint8_t shift;
+static volatile uint32_t edge_ticks;
+static volatile uint32_t edges;     // SQW edges since init
+static volatile uint8_t edge_seq;   // changes with every edge
+static int8_t rate_rem;             // filter remainder, carried so it cannot stall
+static uint8_t seeded;              // rate measured at least once
+
+static uint32_t wall;               // GMT second of edge 0
+static uint8_t synced;
+
+//private:
+static uint32_t mul_shr( uint32_t a, uint32_t b, uint8_t s );
+static uint8_t ts_scale( uint32_t r, uint32_t* q );
+
+// ( a * b ) >> s from a 64 bit product built of 16 bit halves, s 1 .. 63
+static uint32_t mul_shr( uint32_t a, uint32_t b, uint8_t s )
+{
+    uint32_t ll, lh, hl, hi, mid;
+
+    ll = ( a & 0xFFFF ) * ( b & 0xFFFF );
+    lh = ( a & 0xFFFF ) * ( b >> 16 );
+    hl = ( a >> 16 ) * ( b & 0xFFFF );
+    hi = ( a >> 16 ) * ( b >> 16 );
+
+    mid = ( ll >> 16 ) + ( lh & 0xFFFF ) + ( hl & 0xFFFF );
+    hi += ( lh >> 16 ) + ( hl >> 16 ) + ( mid >> 16 );
+
+    if( s >= 32 )
+        return hi >> ( s - 32 );
+
+    return ( hi << ( 32 - s ) ) | ( ( ( mid << 16 ) | ( ll & 0xFFFF ) ) >> s );
+}
+
+/*
+ * Microseconds per tick for a rate r in 1/16 ticks per second, as q / 2^s
+ * with q in 2^31 .. 2^32 - 1.  Long division one bit at a time, about 40
+ * steps once a second.
+ */
+static uint8_t ts_scale( uint32_t r, uint32_t* q )
+{
+    uint32_t rem = US_PER_SECOND << RATE_SHIFT, quo;
+    uint8_t s = 0;
+
+    quo = rem / r;
+    rem %= r;
+
+    while( quo < SCALE_TOP )
+    {
+        rem <<= 1;
+        quo <<= 1;
+        if( rem >= r )
+        {
+            rem -= r;
+            quo |= 1;
+        }
+        s++;
+    }
+
+    *q = quo;
+
+    return s;
+}
+
+int ds1307_ts_init( uint32_t timer_hz, uint32_t ( *timer_read )( void ) )
+{
+    if( timer_hz == 0 || timer_hz > DS1307_TS_MAX_HZ || timer_read == NULL )
+        return -1;
+
+    nominal       = timer_hz;
+    nominal_shift = ts_scale( nominal << RATE_SHIFT, &nominal_scale );
+
+    rate       = nominal << RATE_SHIFT;
+    scale      = nominal_scale;
+    shift      = nominal_shift;
+    edges      = 0;
+    rate_rem   = 0;
+    seeded     = 0;
+    synced     = 0;
+    timer      = timer_read;
+    edge_ticks = timer();
+    edge_seq++;
+
+    return 0;
+}
+
+void ds1307_ts_sqw_isr()
+{
+    if( timer != NULL )
+        ds1307_ts_edge( timer() );
+    else
+        ds1307_sqw_isr();
+}
+
+void ds1307_ts_edge( uint32_t ticks )
+{
+    uint32_t period = ticks - edge_ticks;
+    uint32_t now = rate >> RATE_SHIFT, q;
+    int32_t d;
+
+    if( !seeded )
+    {
+        // the first whole second, within 1/8 of the nominal rate
+        if( edges != 0 && period - ( nominal - ( nominal >> 3 ) ) <= ( nominal >> 2 ) )
+        {
+            rate   = period << RATE_SHIFT;
+            seeded = 1;
+            shift  = ts_scale( rate, &q );
+            scale  = q;
+        }
+    }
+    else if( period - ( now - ( now >> 6 ) ) <= ( now >> 5 ) )
+    {
+        d = ( int32_t )( ( period << RATE_SHIFT ) - rate ) + rate_rem;
+        rate += d / ( 1 << FILTER_SHIFT );
+        rate_rem = ( int8_t )( d % ( 1 << FILTER_SHIFT ) );
+        shift = ts_scale( rate, &q );
+        scale = q;
+    }
+
+    edge_ticks = ticks;
+    edges++;
+    edge_seq++;
+
+    ds1307_sqw_isr();
+}
+
+void ds1307_ts_now( ds1307_ts_t* ts )
+{
+    uint32_t sec, since, per, mul;
+    uint8_t seq, sh;
+
+    do
+    {
+        seq   = edge_seq;
+        sec   = edges;
+        since = timer() - edge_ticks;
+        per   = rate >> RATE_SHIFT;
+        mul   = scale;
+        sh    = shift;
+    } while( seq != edge_seq );
+
+    // a late edge holds the clock at the end of the second
+    ts->sec  = sec;
+    ts->usec = ( since >= per ) ? US_PER_SECOND - 1 : mul_shr( since, mul, sh );
+}
+
+int ds1307_ts_gmt( ds1307_ts_t* ts )
+{
+    if( !synced && ds1307_ts_sync() != 0 )
+        return -1;
+
+    ds1307_ts_now( ts );
+    ts->sec += wall;
+
+    return 0;
+}
+
+/*
+ * The RTC second and the edge count are taken between the same two
+ * edges.  With the SQW cache of ds1307.c this is usually no bus access.
+ */
+int ds1307_ts_sync()
+{
+    uint32_t gmt, sec;
+    uint8_t seq;
+
+    if( edges == 0 )
+        return -1;
+
+    do
+    {
+        seq = edge_seq;
+        sec = edges;
+        gmt = ( uint32_t )ds1307_get_GMT_unix_time();
+    } while( seq != edge_seq );
+
+    wall   = gmt - sec;
+    synced = 1;
+
+    return 0;
+}
+
+int32_t ds1307_ts_drift()
+{
+    uint32_t r, nom = nominal << RATE_SHIFT, diff, ppb;
+    uint8_t seq;
+
+    do
+    {
+        seq = edge_seq;
+        r   = rate;
+    } while( seq != edge_seq );
+
+    diff = ( r >= nom ) ? r - nom : nom - r;
+
+    // the product would overflow only for fast timers several % off
+    if( diff <= 0xFFFFFFFFUL / PPB_PER_RATE )
+        ppb = mul_shr( diff * PPB_PER_RATE, nominal_scale, nominal_shift + 1 );
+    else
+        ppb = mul_shr( diff, nominal_scale, nominal_shift + 1 ) * PPB_PER_RATE;
+
+    return ( r >= nom ) ? ( int32_t )ppb : -( int32_t )ppb;
+}
@@ -0,0 +1,155 @@
+/**
+ * @file ds1307_ts.h
+ *
+ * @brief Sub-second timestamps from the DS1307 SQW output and an MCU timer
+ *
+ * A free running MCU timer is disciplined by the 1 Hz SQW edges of the
+ * RTC.  Each edge captures the timer and updates a filtered count of
+ * timer ticks per RTC second, so a timestamp is the number of edges plus
+ * the ticks since the last one converted to microseconds.  Timestamps
+ * never touch the bus, they cost one timer read and a 32 x 32 bit
+ * multiply.  The wall clock is tied to the edges by one RTC read.
+ *
+ * @author Richard Lowe
+ * @copyright AlphaLoewe
+ *
+ * @date 18/10/2026
+ *
+ * @version .01 - Initial
+ *
+ * @details
+ *
+ * Status: <XX% completed.>
+ *
+ * @par
+ *   The seconds and microseconds of ds1307_ts_t span the range of a 64
+ *   bit microsecond count without 64 bit arithmetic.  Within a second the
+ *   microseconds are held at 999999 when the next edge is late, so time
+ *   never runs backwards.  Periods more than 1/64 away from the current
+ *   rate, e.g. a missed edge or a second restarted by setting the time,
+ *   are not used for the estimate.
+ *
+ * @par
+ *   The RTC crystal is the reference, drift is that of the MCU timer
+ *   against it.  A timer clocked from the 4, 8 or 32 kHz SQW output has
+ *   no drift to measure, and leaves no 1 Hz edge, so it is not supported.
+ */
+
+#ifndef DS1307_TS_H
+#define DS1307_TS_H
+
+#include <stdint.h>
+
+#define DS1307_TS_MAX_HZ    100000000UL     /**< Fastest timer */
+
+/**
+ *  @struct Timestamp
+ */
+typedef struct
+{
+    uint32_t sec;       /**< Seconds */
+    uint32_t usec;      /**< Microseconds, 0 .. 999999 */
+} ds1307_ts_t;
+
+/**
+ *  @brief Starts the timestamp service
+ *
+ *  The RTC must be set up with output_mode DS1307_SQW_1HZ and the SQW
+ *  ISR must call ds1307_ts_sqw_isr or ds1307_ts_edge.
+ *
+ *  @code
+ *  // ATmega32, Timer1 at 1 MHz extended to 32 bits
+ *  static volatile uint16_t t1_high;
+ *
+ *  void t1_ovf_ISR() iv IVT_ADDR_TIMER1_OVF ics ICS_AUTO
+ *  {
+ *      t1_high++;
+ *  }
+ *
+ *  uint32_t t1_read()
+ *  {
+ *      uint16_t hi, lo;
+ *
+ *      do
+ *      {
+ *          hi = t1_high;
+ *          lo = TCNT1;
+ *          if( TOV1_bit && lo < 0x8000 )     // overflow not served yet
+ *              hi++;
+ *      } while( hi != t1_high );
+ *
+ *      return ( ( uint32_t )hi << 16 ) | lo;
+ *  }
+ *
+ *  ds1307_ts_init( 1000000, t1_read );
+ *  @endcode
+ *
+ *  @param timer_hz - nominal timer rate, 1 .. DS1307_TS_MAX_HZ
+ *  @param timer_read - returns the free running 32 bit timer count
+ *
+ *  @returns int
+ *    @retval 0 OK
+ *    @retval -1 bad rate or no timer
+ */
+int ds1307_ts_init( uint32_t timer_hz, uint32_t ( *timer_read )( void ) );
+
+/**
+ *  @brief Takes an SQW edge, call from the SQW pin ISR
+ *
+ *  Reads the timer and calls ds1307_sqw_isr, so it replaces that call.
+ *
+ *  @code
+ *  void rtc_sw_ISR() iv IVT_ADDR_INT0 ics ICS_AUTO
+ *  {
+ *      ds1307_ts_sqw_isr();
+ *  }
+ *  @endcode
+ */
+void ds1307_ts_sqw_isr( void );
+
+/**
+ *  @brief Takes an SQW edge with the timer count captured by hardware
+ *
+ *  For timers with input capture on the SQW pin, which removes the
+ *  interrupt latency from the measure.  Also calls ds1307_sqw_isr.
+ */
+void ds1307_ts_edge( uint32_t ticks );
+
+/**
+ *  @brief Monotonic time since ds1307_ts_init
+ *
+ *  The first second ends with the first SQW edge and is shorter.
+ */
+void ds1307_ts_now( ds1307_ts_t* ts );
+
+/**
+ *  @brief GMT unix time with microseconds
+ *
+ *  The first call after ds1307_ts_init reads the RTC once, later calls
+ *  never do.
+ *
+ *  @returns int
+ *    @retval 0 OK
+ *    @retval -1 no SQW edge seen yet
+ */
+int ds1307_ts_gmt( ds1307_ts_t* ts );
+
+/**
+ *  @brief Ties the wall clock to the SQW edges again
+ *
+ *  Reads the RTC.  Call after ds1307_set_time_GMT.
+ *
+ *  @returns int
+ *    @retval 0 OK
+ *    @retval -1 no SQW edge seen yet
+ */
+int ds1307_ts_sync( void );
+
+/**
+ *  @brief Drift of the MCU timer against the RTC
+ *
+ *  @returns int32_t - parts per billion, positive when the timer is fast
+ */
+int32_t ds1307_ts_drift( void );
+
+#endif
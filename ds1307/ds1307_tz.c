@@ -0,0 +1,193 @@
+#include <stddef.h>
+#include "ds1307.h"
+
+#define SECONDS_IN_DAY  86400UL
+#define OFFSET_MIN      -720
+#define OFFSET_MAX      840
+
+const code ds1307_tz_rule_t ds1307_tz_eu =
+{
+    { 3, DS1307_TZ_LAST, 6, 1, 60 }, { 10, DS1307_TZ_LAST, 6, 1, 60 }, 60
+};
+
+const code ds1307_tz_rule_t ds1307_tz_us =
+{
+    { 3, 2, 6, 0, 120 }, { 11, 1, 6, 0, 120 }, 60
+};
+
+const code ds1307_tz_rule_t ds1307_tz_au =
+{
+    { 10, 1, 6, 0, 120 }, { 4, 1, 6, 0, 180 }, 60
+};
+
+//private:
+static uint32_t tz_change( uint16_t year, const code ds1307_tz_change_t* change,
+                           int16_t before );
+static void tz_interval( ds1307_tz_t* tz, uint32_t gmt );
+
+/*
+ * GMT time of one change in a year.  before is the offset in minutes in
+ * effect until the change, wall clock times are relative to it.
+ */
+static uint32_t tz_change( uint16_t year, const code ds1307_tz_change_t* change,
+                           int16_t before )
+{
+    TimeStruct ts;
+    uint32_t first, at;
+    uint8_t day;
+
+    ts.ss = 0;
+    ts.mn = 0;
+    ts.hh = 0;
+    ts.md = 1;
+    ts.mo = change->month;
+    ts.yy = year;
+
+    first = Time_dateToEpochU( &ts );
+    Time_epochToDateU( first, &ts );
+
+    // nth weekday, the last is the 5th or the 4th
+    day = ( change->weekday + 7 - ts.wd ) % 7 + ( change->week - 1 ) * 7;
+    at  = first + day * SECONDS_IN_DAY;
+
+    if( change->week == DS1307_TZ_LAST )
+    {
+        Time_epochToDateU( at, &ts );
+        if( ts.mo != change->month )
+            at -= 7 * SECONDS_IN_DAY;
+    }
+
+    at += change->at * 60UL;
+    if( !change->utc )
+        at -= before * 60L;
+
+    return at;
+}
+
+// Interval of constant offset holding gmt, bounded by the year
+static void tz_interval( ds1307_tz_t* tz, uint32_t gmt )
+{
+    TimeStruct ts;
+    uint32_t year_start, year_end, start, end;
+    int16_t save;
+
+    Time_epochToDateU( gmt, &ts );
+
+    tz->shift = tz->offset * 60L;
+    tz->dst   = 0;
+
+    if( tz->rule == DS1307_TZ_NONE )
+    {
+        tz->from = 0;
+        tz->to   = 0xFFFFFFFF;
+        return;
+    }
+
+    ts.ss = 0;
+    ts.mn = 0;
+    ts.hh = 0;
+    ts.md = 1;
+    ts.mo = 1;
+    year_start = Time_dateToEpochU( &ts );
+    ts.yy++;
+    year_end = ( ts.yy > 2105 ) ? 0xFFFFFFFF : Time_dateToEpochU( &ts );
+    ts.yy--;
+
+    save  = tz->rule->save;
+    start = tz_change( ts.yy, &tz->rule->start, tz->offset );
+    end   = tz_change( ts.yy, &tz->rule->end, tz->offset + save );
+
+    if( start < end )
+    {
+        // north, daylight saving in the middle of the year
+        if( gmt < start )
+        {
+            tz->from = year_start;
+            tz->to   = start;
+        }
+        else if( gmt < end )
+        {
+            tz->from = start;
+            tz->to   = end;
+            tz->dst  = 1;
+        }
+        else
+        {
+            tz->from = end;
+            tz->to   = year_end;
+        }
+    }
+    else
+    {
+        // south, standard time in the middle of the year
+        if( gmt < end )
+        {
+            tz->from = year_start;
+            tz->to   = end;
+            tz->dst  = 1;
+        }
+        else if( gmt < start )
+        {
+            tz->from = end;
+            tz->to   = start;
+        }
+        else
+        {
+            tz->from = start;
+            tz->to   = year_end;
+            tz->dst  = 1;
+        }
+    }
+
+    if( tz->dst )
+        tz->shift += save * 60L;
+}
+
+int ds1307_tz_set( ds1307_tz_t* tz, int16_t offset, const code ds1307_tz_rule_t* rule )
+{
+    if( offset < OFFSET_MIN || offset > OFFSET_MAX )
+        return -1;
+
+    tz->offset = offset;
+    tz->rule   = rule;
+
+    // empty interval, the first conversion fills it
+    tz->from = 1;
+    tz->to   = 0;
+
+    return 0;
+}
+
+uint32_t ds1307_tz_local( ds1307_tz_t* tz, uint32_t gmt )
+{
+    if( gmt < tz->from || gmt >= tz->to )
+        tz_interval( tz, gmt );
+
+    return gmt + tz->shift;
+}
+
+uint32_t ds1307_tz_gmt( ds1307_tz_t* tz, uint32_t local )
+{
+    uint32_t gmt;
+    int32_t save;
+
+    if( tz->rule == DS1307_TZ_NONE )
+        return local - tz->offset * 60L;
+
+    // try daylight saving first, then standard time
+    save = tz->rule->save * 60L;
+    gmt  = local - tz->offset * 60L - save;
+
+    if( ds1307_tz_is_dst( tz, gmt ) )
+        return gmt;
+
+    return gmt + save;
+}
+
+uint8_t ds1307_tz_is_dst( ds1307_tz_t* tz, uint32_t gmt )
+{
+    if( gmt < tz->from || gmt >= tz->to )
+        tz_interval( tz, gmt );
+
+    return tz->dst;
+}
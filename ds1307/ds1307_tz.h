@@ -0,0 +1,142 @@
+/**
+ * @file ds1307_tz.h
+ *
+ * @brief Table driven time zones for the DS1307 library
+ *
+ * A zone is a standard offset from GMT in minutes and an optional
+ * daylight saving rule.  Rules are flash tables giving month, week,
+ * weekday and time of both changes, so any offset, including 30 and 45
+ * minute zones, and any rule of that form works.  The zone keeps the GMT
+ * interval it is currently in and the offset that applies, so a
+ * conversion inside the interval is one range check and one add.  Only
+ * when the time leaves it are the changes of that year worked out again.
+ *
+ * @author Richard Lowe
+ * @copyright AlphaLoewe
+ *
+ * @date 18/10/2026
+ *
+ * @version .01 - Initial
+ *
+ * @details
+ *
+ * Status: <XX% completed.>
+ *
+ * @par
+ *   Timestamps are unsigned, 1970 to 2106.  Rules hold for every year,
+ *   past changes of the law are not kept.  Further rules are written in
+ *   the same form, e.g. from the Rule lines of tzdata:
+ *
+ *   Rule  EU  1981  max  -  Mar  lastSun  1:00u  1:00  S
+ *   Rule  EU  1996  max  -  Oct  lastSun  1:00u  0     -
+ *
+ *   becomes
+ *
+ *   { { 3, DS1307_TZ_LAST, 6, 1, 60 }, { 10, DS1307_TZ_LAST, 6, 1, 60 }, 60 }
+ */
+
+#ifndef DS1307_TZ_H
+#define DS1307_TZ_H
+
+#include <stdint.h>
+#include "timelib.h"
+
+#define DS1307_TZ_LAST        5       /**< Last weekday of the month */
+#define DS1307_TZ_NONE        0       /**< No daylight saving, rule pointer */
+
+/**
+ *  @struct One change of a rule
+ */
+typedef struct
+{
+    uint8_t month;          /**< 1 .. 12 */
+    uint8_t week;           /**< 1 .. 4 for the nth weekday, DS1307_TZ_LAST */
+    uint8_t weekday;        /**< monday=0 .. sunday=6 as in TimeStruct */
+    uint8_t utc;            /**< at is GMT, else wall clock time before the change */
+    uint16_t at;            /**< Minutes after midnight */
+} ds1307_tz_change_t;
+
+/**
+ *  @struct Daylight saving rule
+ *
+ *  Start may come after end in the year, south of the equator.
+ */
+typedef struct
+{
+    ds1307_tz_change_t start;   /**< Daylight saving begins */
+    ds1307_tz_change_t end;     /**< Daylight saving ends */
+    uint8_t save;               /**< Minutes added, usually 60 */
+} ds1307_tz_rule_t;
+
+/**
+ *  @defgroup Time_Zone_Rules
+ *  @{
+ */
+extern const code ds1307_tz_rule_t ds1307_tz_eu;   /**< Last sunday of March and October, 01:00 GMT */
+extern const code ds1307_tz_rule_t ds1307_tz_us;   /**< 2nd sunday of March, 1st of November, 02:00 */
+extern const code ds1307_tz_rule_t ds1307_tz_au;   /**< 1st sunday of October and April, 02:00 / 03:00 */
+/**@}*/
+
+/**
+ *  @struct Zone and its cached interval
+ */
+typedef struct
+{
+    int16_t offset;                     /**< Standard time, minutes from GMT */
+    const code ds1307_tz_rule_t* rule;  /**< DS1307_TZ_NONE for none */
+    uint32_t from;                      /**< Cached interval, GMT */
+    uint32_t to;                        /**< First second after it */
+    int32_t shift;                      /**< Seconds added inside it */
+    uint8_t dst;                        /**< Daylight saving inside it */
+} ds1307_tz_t;
+
+/**
+ *  @brief Sets a zone
+ *
+ *  @param offset - standard time in minutes from GMT, -720 .. 840
+ *  @param rule - @ref Time_Zone_Rules or DS1307_TZ_NONE
+ *
+ *  @code
+ *  ds1307_tz_t zone;
+ *
+ *  ds1307_tz_set( &zone, 330, DS1307_TZ_NONE );     // India
+ *  ds1307_tz_set( &zone, 570, &ds1307_tz_au );      // Adelaide
+ *  ds1307_tz_set( &zone, -480, &ds1307_tz_us );     // Pacific
+ *  @endcode
+ *
+ *  @returns int
+ *    @retval 0 OK
+ *    @retval -1 offset out of range, zone left unchanged
+ */
+int ds1307_tz_set( ds1307_tz_t* tz, int16_t offset, const code ds1307_tz_rule_t* rule );
+
+/**
+ *  @brief GMT to local time
+ *
+ *  @param gmt - unix timestamp
+ *
+ *  @returns uint32_t - local timestamp
+ */
+uint32_t ds1307_tz_local( ds1307_tz_t* tz, uint32_t gmt );
+
+/**
+ *  @brief Local time to GMT
+ *
+ *  A time that is skipped when daylight saving begins is taken as
+ *  standard time.  A time that happens twice when it ends is taken as
+ *  the first one.
+ *
+ *  @param local - local timestamp
+ *
+ *  @returns uint32_t - unix timestamp
+ */
+uint32_t ds1307_tz_gmt( ds1307_tz_t* tz, uint32_t local );
+
+/**
+ *  @brief Whether daylight saving applies at a time
+ *
+ *  @param gmt - unix timestamp
+ */
+uint8_t ds1307_tz_is_dst( ds1307_tz_t* tz, uint32_t gmt );
+
+#endif
@@ -31,8 +31,8 @@ void setup_rtc()
     TimeStruct ts1;
     
     ds1307_config_t rtc;
-    rtc.time_zone     = -8;
-    rtc.dst_enable    = 1;
+    rtc.tz_offset     = -8 * 60;
+    rtc.dst_rule      = &ds1307_tz_us;
     rtc.output_mode   = DS1307_SQW_1HZ;
     rtc.hour24_enable = 1;
 
@@ -91,6 +91,8 @@ void rtc_sw_ISR() iv IVT_ADDR_INT0 ics ICS_AUTO {
     
     char i;
     
+    ds1307_sqw_isr();
+
     Lcd_Cmd( 64 );
     
     for (i = 0; i<=10; i++)
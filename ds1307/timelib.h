@@ -13,6 +13,8 @@
  *
  */
 
+#ifndef _TIMELIB_H
+#define _TIMELIB_H
 
 /*
  * some constants
@@ -46,6 +48,13 @@ extern  long            Time_jd1970 ;   // 01/01/1970 julian day number
 long    Time_dateToEpoch(TimeStruct *ts) ;
 void    Time_epochToDate(long e, TimeStruct *ts) ;
 
+/*
+ * unsigned timestamps, from 1970 to 2106
+ * Time_epochToDate and Time_epochToDateU also set wd
+ */
+unsigned long   Time_dateToEpochU(TimeStruct *ts) ;
+void    Time_epochToDateU(unsigned long e, TimeStruct *ts) ;
+
 /*
  * macro definitions
  */
@@ -59,3 +68,4 @@ void    Time_epochToDate(long e, TimeStruct *ts) ;
  */
 #define Time_dateDiff(t1, t2) (Time_dateToEpoch(t2) - Time_dateToEpoch(t1))
 
+#endif
@@ -0,0 +1,263 @@
+/**
+ * @file timelib_bench.c
+ *
+ * @brief Host test and benchmark of the time library conversions
+ *
+ * Compares Time_dateToEpoch, Time_epochToDate and their unsigned
+ * variants with timegm and gmtime_r of the host libc.  Every day of the
+ * signed and the unsigned range is checked at several times of day,
+ * including the first and last second, and every second of a day is
+ * checked on its own.  With "full" each of the 2^32 timestamps of both
+ * ranges is converted and compared with a date stepped on by one second,
+ * which takes a few minutes.  Then both directions are timed against
+ * libc.
+ *
+ * @code
+ *   gcc -O2 -o timelib_bench timelib_bench.c timelib_epoch.c
+ *   timelib_bench [full]
+ * @endcode
+ *
+ * @author Richard Lowe
+ * @copyright AlphaLoewe
+ *
+ * @date 18/10/2026
+ *
+ * @version .01 - Initial
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "timelib.h"
+
+#define TIMED_RUNS  10000000UL
+
+static const uint8_t month_days[ 12 ] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+
+static volatile long sink;
+static TimeStruct sink_ts;
+static unsigned long failures;
+
+static double seconds( clock_t start )
+{
+    return ( double )( clock() - start ) / CLOCKS_PER_SEC;
+}
+
+static void to_tm( TimeStruct* ts, struct tm* tm )
+{
+    memset( tm, 0, sizeof( *tm ) );
+    tm->tm_sec  = ts->ss;
+    tm->tm_min  = ts->mn;
+    tm->tm_hour = ts->hh;
+    tm->tm_mday = ts->md;
+    tm->tm_mon  = ts->mo - 1;
+    tm->tm_year = ts->yy - 1900;
+}
+
+static int same( TimeStruct* ts, struct tm* tm )
+{
+    return ts->ss == tm->tm_sec && ts->mn == tm->tm_min && ts->hh == tm->tm_hour
+           && ts->md == tm->tm_mday && ts->mo == tm->tm_mon + 1
+           && ts->yy == ( unsigned )( tm->tm_year + 1900 ) && ts->wd == ( tm->tm_wday + 6 ) % 7;
+}
+
+static void fail( const char* what, int64_t t )
+{
+    if( failures++ < 10 )
+        printf( "  FAIL %s at %lld\n", what, ( long long )t );
+}
+
+// One timestamp both ways, signed or unsigned variant
+static void check( int64_t t, int is_unsigned )
+{
+    TimeStruct ts;
+    struct tm tm;
+    time_t tt = ( time_t )t;
+    int64_t back;
+
+    gmtime_r( &tt, &tm );
+
+    if( is_unsigned )
+        Time_epochToDateU( ( unsigned long )t, &ts );
+    else
+        Time_epochToDate( ( long )t, &ts );
+
+    if( !same( &ts, &tm ) )
+        fail( is_unsigned ? "epochToDateU" : "epochToDate", t );
+
+    if( is_unsigned )
+        back = ( int64_t )( uint32_t )Time_dateToEpochU( &ts );
+    else
+        back = ( int64_t )( int32_t )Time_dateToEpoch( &ts );
+
+    if( back != t || ( int64_t )timegm( &tm ) != t )
+        fail( is_unsigned ? "dateToEpochU" : "dateToEpoch", t );
+}
+
+static void check_days( int64_t first, int64_t last, int is_unsigned )
+{
+    static const int32_t offsets[] = { 0, 1, 3599, 43200, 86399 };
+    int64_t day, t;
+    unsigned int i;
+
+    for( day = first - 86400; day <= last; day += 86400 )
+    {
+        for( i = 0; i < sizeof( offsets ) / sizeof( offsets[0] ); i++ )
+        {
+            t = day + offsets[i];
+            if( t >= first && t <= last )
+                check( t, is_unsigned );
+        }
+    }
+    check( first, is_unsigned );
+    check( last, is_unsigned );
+}
+
+static void step( TimeStruct* ts )
+{
+    uint8_t days;
+
+    if( ++ts->ss < 60 )
+        return;
+    ts->ss = 0;
+    if( ++ts->mn < 60 )
+        return;
+    ts->mn = 0;
+    if( ++ts->hh < 24 )
+        return;
+    ts->hh = 0;
+    ts->wd = ( ts->wd + 1 ) % 7;
+
+    days = month_days[ ts->mo - 1 ];
+    if( ts->mo == 2 && ( ts->yy % 4 == 0 && ( ts->yy % 100 != 0 || ts->yy % 400 == 0 ) ) )
+        days++;
+    if( ++ts->md <= days )
+        return;
+    ts->md = 1;
+    if( ++ts->mo <= 12 )
+        return;
+    ts->mo = 1;
+    ts->yy++;
+}
+
+// Every second of a range against a stepped date
+static void check_all( int64_t first, uint32_t count, int is_unsigned )
+{
+    TimeStruct ref, ts;
+    struct tm tm;
+    time_t tt = ( time_t )first;
+    int64_t t = first;
+    uint32_t i = 0;
+
+    gmtime_r( &tt, &tm );
+    ref.ss = tm.tm_sec;
+    ref.mn = tm.tm_min;
+    ref.hh = tm.tm_hour;
+    ref.md = tm.tm_mday;
+    ref.mo = tm.tm_mon + 1;
+    ref.yy = tm.tm_year + 1900;
+    ref.wd = ( tm.tm_wday + 6 ) % 7;
+
+    do
+    {
+        if( is_unsigned )
+            Time_epochToDateU( ( unsigned long )( uint32_t )t, &ts );
+        else
+            Time_epochToDate( ( long )( int32_t )t, &ts );
+
+        if( ts.ss != ref.ss || ts.mn != ref.mn || ts.hh != ref.hh || ts.md != ref.md
+            || ts.mo != ref.mo || ts.yy != ref.yy || ts.wd != ref.wd )
+            fail( "stepped epochToDate", t );
+
+        if( ( is_unsigned ? ( int64_t )( uint32_t )Time_dateToEpochU( &ref )
+                          : ( int64_t )( int32_t )Time_dateToEpoch( &ref ) ) != t )
+            fail( "stepped dateToEpoch", t );
+
+        step( &ref );
+        t++;
+    } while( i++ != count );
+}
+
+static void bench( void )
+{
+    TimeStruct ts;
+    struct tm tm;
+    time_t tt;
+    clock_t start;
+    double mine, libc;
+    unsigned long i;
+    uint32_t t;
+
+    start = clock();
+    for( i = 0, t = 12345; i < TIMED_RUNS; i++, t += 2654435761UL )
+    {
+        Time_epochToDateU( t, &ts );
+        sink += ts.md;
+    }
+    mine = seconds( start );
+
+    start = clock();
+    for( i = 0, t = 12345; i < TIMED_RUNS; i++, t += 2654435761UL )
+    {
+        tt = t;
+        gmtime_r( &tt, &tm );
+        sink += tm.tm_mday;
+    }
+    libc = seconds( start );
+    printf( "epoch to date: %6.1f ns, gmtime_r %6.1f ns\n",
+            mine * 1e9 / TIMED_RUNS, libc * 1e9 / TIMED_RUNS );
+
+    Time_epochToDateU( 1700000000UL, &sink_ts );
+    to_tm( &sink_ts, &tm );
+
+    start = clock();
+    for( i = 0; i < TIMED_RUNS; i++ )
+    {
+        sink_ts.ss = i & 31;
+        sink += Time_dateToEpochU( &sink_ts );
+    }
+    mine = seconds( start );
+
+    start = clock();
+    for( i = 0; i < TIMED_RUNS; i++ )
+    {
+        tm.tm_sec = i & 31;
+        sink += timegm( &tm );
+    }
+    libc = seconds( start );
+    printf( "date to epoch: %6.1f ns, timegm   %6.1f ns\n",
+            mine * 1e9 / TIMED_RUNS, libc * 1e9 / TIMED_RUNS );
+}
+
+int main( int argc, char** argv )
+{
+    int64_t t;
+    int full = argc > 1 && strcmp( argv[1], "full" ) == 0;
+
+    printf( "days, signed range\n" );
+    check_days( INT32_MIN, INT32_MAX, 0 );
+    printf( "days, unsigned range\n" );
+    check_days( 0, UINT32_MAX, 1 );
+
+    printf( "seconds of a day\n" );
+    for( t = 0; t < 86400; t++ )
+    {
+        check( t, 1 );
+        check( t - 86400, 0 );
+    }
+
+    if( full )
+    {
+        printf( "every second, signed range\n" );
+        check_all( INT32_MIN, UINT32_MAX, 0 );
+        printf( "every second, unsigned range\n" );
+        check_all( 0, UINT32_MAX, 1 );
+    }
+
+    printf( "%lu failures\n", failures );
+    bench();
+
+    return failures != 0;
+}
@@ -0,0 +1,200 @@
+/**
+ * @file timelib_epoch.c
+ *
+ * @brief Unix time conversion of the time library
+ *
+ * Implements Time_dateToEpoch and Time_epochToDate of timelib.h with
+ * the days from civil algorithm on a calendar that starts on March 1st,
+ * so the leap day is the last day of its year.  Dates count from
+ * 1600-03-01, the start of a 400 year cycle, which keeps every count
+ * positive.  Only 32 bit integers are used and the only long division
+ * is the split of a timestamp into days, everything else is shifts,
+ * compares and multiplies by reciprocals.
+ *
+ * @code
+ *   gcc -O2 -o timelib_bench timelib_bench.c timelib_epoch.c
+ * @endcode
+ *
+ * @author Richard Lowe
+ * @copyright AlphaLoewe
+ *
+ * @date 18/10/2026
+ *
+ * @version .01 - Initial
+ *
+ * @details
+ *
+ * Status: <XX% completed.>
+ *
+ * @par
+ *   Signed timestamps cover 1901-12-13 20:45:52 to 2038-01-19 03:14:07.
+ *   The unsigned variants Time_dateToEpochU and Time_epochToDateU cover
+ *   1970-01-01 to 2106-02-07 06:28:15.  Dates outside the range wrap.
+ *   The multiply shift constants are exact for the value ranges noted
+ *   next to them, timelib_bench checks every second of both ranges.
+ */
+
+#include <stdint.h>
+#include "timelib.h"
+
+#define CYCLE_DAYS     146097UL     // days in 400 years
+#define CENTURY_DAYS   36524U       // days in a century without leap year 400
+#define YEAR4_DAYS     1461U        // days in 4 years with a leap year
+#define YEAR_DAYS      365U
+#define EPOCH_DAYS     135080UL     // 1600-03-01 to 1970-01-01
+#define CYCLE_YEAR     1600U
+#define CYCLE_WEEKDAY  2            // 1600-03-01 was a wednesday
+
+long Time_jd1970 = 2440588L;
+
+//private:
+static uint32_t civil_to_days( TimeStruct* ts );
+static void days_to_civil( uint32_t days, TimeStruct* ts );
+static uint16_t split_day( uint32_t e, uint32_t* sod );
+static void seconds_to_time( uint32_t sod, TimeStruct* ts );
+
+// Days since 1600-03-01
+static uint32_t civil_to_days( TimeStruct* ts )
+{
+    uint16_t y, doy;
+    uint8_t mp;
+
+    // year and month of the march based calendar
+    if( ts->mo > 2 )
+    {
+        y  = ts->yy - CYCLE_YEAR;
+        mp = ts->mo - 3;
+    }
+    else
+    {
+        y  = ts->yy - CYCLE_YEAR - 1;
+        mp = ts->mo + 9;
+    }
+
+    // ( 153 * mp + 2 ) / 5, mp 0 .. 11
+    doy = ( uint16_t )( ( ( uint32_t )( 153 * mp + 2 ) * 1639 ) >> 13 ) + ts->md - 1;
+
+    // leap days: y / 4 - y / 100 + y / 400, y 0 .. 511
+    return ( uint32_t )y * YEAR_DAYS + doy + ( y >> 2 )
+           - ( ( ( uint32_t )y * 5243 ) >> 19 ) + ( y >= 400 );
+}
+
+static void days_to_civil( uint32_t days, TimeStruct* ts )
+{
+    uint16_t yy, doe, doy;
+    uint8_t c, y, mp;
+
+    // at most one full cycle is passed, 1600 .. 2106
+    yy = CYCLE_YEAR;
+    if( days >= CYCLE_DAYS )
+    {
+        days -= CYCLE_DAYS;
+        yy   += 400;
+    }
+
+    // centuries 0 .. 2 have 36524 days, century 3 ends with a leap day
+    c = 0;
+    while( c < 3 && days >= CENTURY_DAYS )
+    {
+        days -= CENTURY_DAYS;
+        c++;
+    }
+    doe = ( uint16_t )days;     // 0 .. 36524
+
+    // a cycle repeats every 7 days, 36524 % 7 = 5
+    ts->wd = ( uint8_t )( ( doe + c * 5 + CYCLE_WEEKDAY ) % 7 );
+
+    // 4 year blocks, doe / 1461, doe 0 .. 36524
+    y   = ( uint8_t )( ( ( uint32_t )doe * 22967 ) >> 25 );
+    doe -= y * YEAR4_DAYS;
+
+    // years in the block, doe / 365 capped at 3 for the leap day
+    mp = ( uint8_t )( ( ( uint32_t )doe * 1437 ) >> 19 );
+    if( mp > 3 )
+        mp = 3;
+    doy = doe - mp * YEAR_DAYS;
+    yy += c * 100 + y * 4 + mp;
+
+    // ( 5 * doy + 2 ) / 153, doy 0 .. 365
+    mp = ( uint8_t )( ( ( uint32_t )( 5 * doy + 2 ) * 857 ) >> 17 );
+    ts->md = ( uint8_t )( doy - ( ( ( uint32_t )( 153 * mp + 2 ) * 1639 ) >> 13 ) + 1 );
+
+    if( mp < 10 )
+    {
+        ts->mo = mp + 3;
+    }
+    else
+    {
+        ts->mo = mp - 9;
+        yy++;
+    }
+    ts->yy = yy;
+}
+
+// Days and seconds of day of an unsigned timestamp, 86400 = 675 << 7
+static uint16_t split_day( uint32_t e, uint32_t* sod )
+{
+    uint32_t q;
+    uint16_t days;
+
+    q    = e >> 7;
+    days = ( uint16_t )( q / 675 );
+    *sod = ( ( q - ( uint32_t )days * 675 ) << 7 ) | ( e & 0x7F );
+
+    return days;
+}
+
+static void seconds_to_time( uint32_t sod, TimeStruct* ts )
+{
+    uint16_t m;
+    uint8_t h;
+
+    // sod / 60 as ( sod / 4 ) / 15, sod 0 .. 86399
+    m = ( uint16_t )( ( ( sod >> 2 ) * 17477 ) >> 18 );
+    ts->ss = ( uint8_t )( sod - m * 60UL );
+
+    // m / 60, m 0 .. 1439
+    h = ( uint8_t )( ( ( uint32_t )m * 1093 ) >> 16 );
+    ts->mn = ( uint8_t )( m - h * 60 );
+    ts->hh = h;
+}
+
+long Time_dateToEpoch( TimeStruct* ts )
+{
+    return ( int32_t )Time_dateToEpochU( ts );
+}
+
+void Time_epochToDate( long e, TimeStruct* ts )
+{
+    uint32_t n, sod;
+    uint16_t days;
+    int32_t s = ( int32_t )e;
+
+    if( s >= 0 )
+    {
+        Time_epochToDateU( ( uint32_t )s, ts );
+        return;
+    }
+
+    // before 1970, rounded down to whole days
+    n    = ( uint32_t )( -( s + 1 ) );
+    days = split_day( n, &sod );
+    days_to_civil( EPOCH_DAYS - 1 - days, ts );
+    seconds_to_time( 86399UL - sod, ts );
+}
+
+unsigned long Time_dateToEpochU( TimeStruct* ts )
+{
+    return ( uint32_t )( civil_to_days( ts ) - EPOCH_DAYS ) * 86400UL
+           + ts->hh * 3600UL + ts->mn * 60U + ts->ss;
+}
+
+void Time_epochToDateU( unsigned long e, TimeStruct* ts )
+{
+    uint32_t sod;
+    uint16_t days;
+
+    days = split_day( ( uint32_t )e, &sod );
+    days_to_civil( EPOCH_DAYS + days, ts );
+    seconds_to_time( sod, ts );
+}
@@ -553,6 +553,29 @@ uint8_t hal_nrf_get_rx_data_source( void );
 */
 uint16_t hal_nrf_read_rx_pload( uint8_t* rx_pload );
 
+/**
+ * @brief Read RX pipe and payload width in one command.
+ *
+ * R_RX_PL_WID shifts STATUS out first, so the pipe number of the top
+ * level FIFO packet comes with its width.  The width is only valid with
+ * dynamic payload width enabled.
+ *
+ * @return pipe number (MSB byte), 7 when the FIFO is empty, and payload
+ * width (LSB byte)
+*/
+uint16_t hal_nrf_read_rx_source_width( void );
+
+/**
+ * @brief Read RX payload of a known width.
+ *
+ * Pops the top level FIFO packet without reading the pipe and width
+ * again.
+ *
+ * @param  *rx_pload pointer to buffer in which RX payload are stored
+ * @param  length payload width
+*/
+void hal_nrf_read_rx_fifo( uint8_t* rx_pload, uint8_t length );
+
 /** 
  * @brief Write TX payload to radio.
  *
@@ -716,7 +739,8 @@ uint16_t hal_nrf_read_multibyte_reg( uint8_t reg, uint8_t* pbuf );
  *
  * @param reg Register to write
  * @param *pbuf pointer to buffer in which data to write is
- * @param length \# of bytes to write
+ * @param length \# of bytes to write, for addresses 0 reads the address
+ * width from the radio
  */
 void hal_nrf_write_multibyte_reg( uint8_t reg, uint8_t* pbuf, uint8_t length );
 
@@ -731,6 +755,21 @@ void hal_nrf_write_multibyte_reg( uint8_t reg, uint8_t* pbuf, uint8_t length );
  * @return Databyte from radio.
 */
 extern uint8_t hal_nrf_rw( uint8_t value );
+
+/**
+ * @brief Basis function, nrf_spi_xfer
+ *
+ * Exchanges a block with the radio inside a chip select window opened
+ * by the caller.  Payload and address accesses send their command byte
+ * with hal_nrf_rw and the rest with one call of this function.  Like
+ * hal_nrf_rw it is provided by the board code, by DMA where there is
+ * one, else a loop.
+ *
+ * @param tx Bytes to send, 0 sends zeros
+ * @param rx Buffer for the bytes received, 0 drops them
+ * @param length Number of bytes
+ */
+extern void hal_nrf_spi_xfer( uint8_t* tx, uint8_t* rx, uint8_t length );
 //@}
 #endif
 /**
@@ -4,6 +4,7 @@
 #define RADIO_H__
 
 #include <stdint.h>
+#include <stdbool.h>
 #include "hal_nrf_hw.h"
 #include "hal_nrf_reg.h"
 
@@ -16,6 +17,25 @@
 /** Defines the payload length the radio should use */
 #define RF_PAYLOAD_LENGTH 32
 
+/** Largest payload the radio carries */
+#define RF_MAX_PAYLOAD 32
+
+/** Packets the receive ring holds, a power of two */
+#define RADIO_RX_QUEUE 8
+
+/** Packets the transmit queue holds, a power of two up to 128 */
+#define RADIO_TX_QUEUE 8
+
+/** Depth of the radio TX FIFO */
+#define RF_TX_FIFO 3
+
+/**
+ * SPI2 blocks of RADIO_DMA_MIN bytes or more by DMA1, STM32F4.  Buffers
+ * must not be in CCM RAM, DMA cannot reach it.
+ */
+//#define RADIO_SPI_DMA
+#define RADIO_DMA_MIN 4
+
 /** Defines how many retransmitts that should be performed */
 #define RF_RETRANSMITS 15
 
@@ -72,6 +92,82 @@ typedef enum
 } radio_mode_t;
 
 
+/**
+ * @brief Called when a queued packet is done.
+ *
+ * Runs in the radio ISR.
+ *
+ * @param id The id radio_send_packet returned
+ * @param result @c RF_TX_DS sent, @c RF_TX_AP sent with an ack payload
+ * received, @c RF_MAX_RT given up
+ */
+typedef void ( *radio_tx_done_t )( uint8_t id, radio_status_t result );
+
+/**
+ * @struct Radio configuration
+ */
+typedef struct
+{
+    radio_mode_t mode;                  /**< DEVICE_PRX_SB .. DEVICE_PTX_PL */
+    uint8_t channel;                    /**< 2400 + channel MHz, 0 .. 125 */
+    uint8_t retransmits;                /**< ESB and PL, 0 .. 15 */
+    uint16_t retrans_delay;             /**< 250 .. 4000 us, steps of 250 */
+    hal_nrf_datarate_t datarate;
+    hal_nrf_output_power_t power;
+} radio_config_t;
+
+/**
+ * @struct A received packet
+ */
+typedef struct
+{
+    uint32_t time;                      /**< Clock at the IRQ, see radio_set_clock */
+    uint8_t pipe;                       /**< Data pipe 0 .. 5 */
+    uint8_t length;                     /**< Payload bytes */
+    uint8_t data[ RF_MAX_PAYLOAD ];
+} radio_packet_t;
+
+
+/**
+ * @brief Initializes the radio from a configuration.
+ *
+ * The configuration is turned into an image of the radio registers and
+ * only the registers that differ from what the radio holds are written,
+ * one SPI command each.  The first call writes them all and waits for
+ * the power up, later ones switch mode in a few commands.  Registers
+ * changed with the hal_nrf_set functions afterwards are not known to
+ * it.
+ *
+ * @code
+ * radio_config_t config;
+ *
+ * config.mode          = DEVICE_PTX_PL;
+ * config.channel       = 76;
+ * config.retransmits   = 5;
+ * config.retrans_delay = 500;
+ * config.datarate      = HAL_NRF_2MBPS;
+ * config.power         = HAL_NRF_0DBM;
+ *
+ * radio_init( &config );
+ * @endcode
+ *
+ * @param config The configuration
+ * @return 0 OK, -1 a setting out of range
+ */
+int radio_init( radio_config_t* config );
+
+/**
+ * @brief Switches between PTX and PRX, keeping the rest of the
+ * configuration.
+ *
+ * Usually one write of CONFIG.  Packets queued for sending are loaded
+ * again in the new role.
+ *
+ * @param operational_mode @c HAL_NRF_PRX or @c HAL_NRF_PTX
+ * @return 0 OK, -1 radio not initialized
+ */
+int radio_set_role( hal_nrf_operation_mode_t operational_mode );
+
 /**
  * @brief Initializes the radio in ShockBurst mode.
  *
@@ -118,21 +214,92 @@ uint8_t* radio_get_address( void );
 radio_status_t radio_get_status( void );
 
 /**
- * @brief Gets the bit at position @a byte_index in @b pload.
+ * @brief Gets a byte of the oldest received packet without taking it.
  *
- * @param byte_index The index of the bit
- * @return The value of @b pload[byte_index]
+ * @param byte_index The index of the byte
+ * @return The byte, 0 when no packet is waiting
  */
 uint8_t radio_get_pload_byte( uint8_t byte_index );
 
 /**
- * @brief This function load the data to be sent into the radio, sends it,
- * and waits for the response.
+ * @brief Sets the clock received packets are stamped with.
+ *
+ * Called once per IRQ, e.g. a millisecond tick.  Without one packets
+ * carry time 0.
+ *
+ * @param clock Returns the time, 0 for none
+ */
+void radio_set_clock( uint32_t ( *clock )( void ) );
+
+/**
+ * @brief Takes the oldest received packet.
+ *
+ * The IRQ drains every packet in the radio RX FIFO, up to three, into a
+ * ring of RADIO_RX_QUEUE packets.  When the ring is full the rest stay
+ * in the radio until this function makes room.
+ *
+ * @code
+ * radio_packet_t packet;
+ *
+ * while( radio_receive( &packet ) )
+ * {
+ *     handle( packet.pipe, packet.data, packet.length );
+ * }
+ * @endcode
+ *
+ * @param packet Filled with the packet
+ * @return false when no packet is waiting
+ */
+bool radio_receive( radio_packet_t* packet );
+
+/**
+ * @brief Number of received packets waiting.
+ */
+uint8_t radio_rx_count( void );
+
+/**
+ * @brief Queues a packet and returns without waiting for it.
+ *
+ * The packet is copied.  The IRQ keeps the radio TX FIFO full from a
+ * queue of RADIO_TX_QUEUE packets, and in PTX holds CE high while there
+ * is something to send so packets go back to back.  Each packet ends
+ * with a call of the done callback, in the order they were queued.  In
+ * PRX with ack payload the packets are the ack payloads of pipe 0.
+ *
+ * @code
+ * while( radio_send_packet( buffer, 32 ) < 0 )
+ *     ;                                   // queue full
+ * @endcode
+ *
+ * @param packet The data to send
+ * @param length The length of the data, 1 .. RF_MAX_PAYLOAD
+ * @return The packet id 0 .. 255, -1 when the queue is full, the length
+ * is bad or the mode cannot send
+ */
+int radio_send_packet( uint8_t* packet, uint8_t length );
+
+/**
+ * @brief Sets the function called when a queued packet is done.
+ *
+ * @param done Callback, 0 for none
+ */
+void radio_set_tx_done( radio_tx_done_t done );
+
+/**
+ * @brief Sets how often a packet is tried again after MAX_RT.
+ *
+ * Each round is another RF_RETRANSMITS hardware retransmits.  When they
+ * are used up the packet is dropped with @c RF_MAX_RT and the next one is
+ * sent.  The default 0 gives up at the first MAX_RT.
  *
- * @param packet The data to send. Maximum 2 byte
- * @param length The length of the data
-*/
-void radio_send_packet( uint8_t* packet, uint8_t length );
+ * @param rounds Extra rounds per packet
+ */
+void radio_set_tx_retries( uint8_t rounds );
+
+/**
+ * @brief Number of queued packets not done yet.
+ */
+uint8_t radio_tx_pending( void );
 
 
 #endif
\ No newline at end of file
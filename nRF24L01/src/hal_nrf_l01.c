@@ -28,6 +28,27 @@
 #define SET_BIT(pos) ( (uint8_t) ( 1 << ( (uint8_t) ( pos ) ) ) )
 #define UINT8(t) ( (uint8_t) ( t ) )
 
+/*
+ * One chip select window: the command byte, then the whole block in one
+ * hal_nrf_spi_xfer.  Returns STATUS, the radio clocks it out with every
+ * command byte.
+ */
+static uint8_t hal_nrf_burst( uint8_t cmd, uint8_t* tx, uint8_t* rx, uint8_t length )
+{
+    uint8_t status;
+
+    chip_select_low();
+
+    status = hal_nrf_rw( cmd );
+
+    if( length )
+        hal_nrf_spi_xfer( tx, rx, length );
+
+    chip_select_high();
+
+    return status;
+}
+
 
 
 
@@ -392,16 +413,7 @@ void hal_nrf_disable_dynamic_ack()
 
 void hal_nrf_write_ack_pload( uint8_t pipe, uint8_t* tx_pload, uint8_t length )
 {
-    chip_select_low();
-
-    hal_nrf_rw( WR_ACK_PLOAD | pipe );
-
-    while( length-- )
-    {
-        hal_nrf_rw( *tx_pload++ );
-    }
-
-    chip_select_high();
+    hal_nrf_burst( WR_ACK_PLOAD | pipe, tx_pload, 0, length );
 }
 
 uint8_t hal_nrf_read_rx_pl_w()
@@ -439,6 +451,20 @@ uint16_t hal_nrf_read_rx_pload( uint8_t* rx_pload )
     return hal_nrf_read_multibyte_reg( UINT8 ( HAL_NRF_RX_PLOAD ), rx_pload );
 }
 
+uint16_t hal_nrf_read_rx_source_width()
+{
+    uint8_t status, width;
+
+    status = hal_nrf_burst( RD_RX_PLOAD_W, 0, &width, 1 );
+
+    return ( ( uint16_t ) ( ( status & ( BIT_3 | BIT_2 | BIT_1 ) ) >> 1 ) << 8 ) | width;
+}
+
+void hal_nrf_read_rx_fifo( uint8_t* rx_pload, uint8_t length )
+{
+    hal_nrf_burst( RD_RX_PLOAD, 0, rx_pload, length );
+}
+
 void hal_nrf_reuse_tx()
 {
     hal_nrf_write_reg( REUSE_TX_PL, 0 );
@@ -545,45 +571,39 @@ uint8_t hal_nrf_write_reg( uint8_t reg, uint8_t value )
 
 uint16_t hal_nrf_read_multibyte_reg( uint8_t reg, uint8_t* pbuf )
 {
-    uint8_t ctr, length;
+    uint16_t source;
+    uint8_t length;
 
     switch( reg )
     {
         case HAL_NRF_PIPE0:
         case HAL_NRF_PIPE1:
         case HAL_NRF_TX:
-            length = ctr = hal_nrf_get_address_width();
-            chip_select_low();
-            hal_nrf_rw( RX_ADDR_P0 + reg );
+            length = hal_nrf_get_address_width();
+            hal_nrf_burst( RX_ADDR_P0 + reg, 0, pbuf, length );
             break;
 
         case HAL_NRF_RX_PLOAD:
-            if ( ( reg = hal_nrf_get_rx_data_source() ) < 7 )
-            {
-                length = ctr = hal_nrf_read_rx_pl_w();
+            // pipe and width in one command, pipe 7 is an empty FIFO
+            source = hal_nrf_read_rx_source_width();
+            reg    = source >> 8;
+            length = ( reg < 7 ) ? ( uint8_t ) source : 0;
 
-                chip_select_low();
-                hal_nrf_rw( RD_RX_PLOAD );
-            }
-            else
+            if ( length > 32 )              // corrupt, flush as the datasheet asks
             {
-                ctr = length = 0;
+                hal_nrf_flush_rx();
+                length = 0;
             }
 
+            if ( length )
+                hal_nrf_burst( RD_RX_PLOAD, 0, pbuf, length );
             break;
 
         default:
-            ctr = length = 0;
+            length = 0;
             break;
     }
 
-    while ( ctr-- )
-    {
-        *pbuf++ = hal_nrf_rw( 0 );
-    }
-
-    chip_select_high();
-
     return ( ( ( uint16_t ) reg << 8 ) | length );
 }
 
@@ -594,24 +614,17 @@ void hal_nrf_write_multibyte_reg( uint8_t reg, uint8_t* pbuf, uint8_t length )
         case HAL_NRF_PIPE0:
         case HAL_NRF_PIPE1:
         case HAL_NRF_TX:
-            length = hal_nrf_get_address_width();
-            chip_select_low();
-            hal_nrf_rw( WRITE_REG + RX_ADDR_P0 + reg );
+            if ( length == 0 )
+                length = hal_nrf_get_address_width();
+
+            hal_nrf_burst( WRITE_REG + RX_ADDR_P0 + reg, pbuf, 0, length );
             break;
 
         case HAL_NRF_TX_PLOAD:
-            chip_select_low();
-            hal_nrf_rw( WR_TX_PLOAD );
+            hal_nrf_burst( WR_TX_PLOAD, pbuf, 0, length );
             break;
 
         default:
             break;
     }
-
-    while ( length-- )
-    {
-        hal_nrf_rw( *pbuf++ );
-    }
-
-    chip_select_high();
 }
\ No newline at end of file
@@ -8,12 +8,36 @@ sbit radio_chip_enable at GPIOG_ODR.B12;
 
 static bool bus_initialized;
 
+/*
+ * Received packets.  The ISR moves rx_head, radio_receive() moves rx_tail,
+ * the ring is empty when they are equal.
+ */
+static radio_packet_t rx_ring[ RADIO_RX_QUEUE ];
+static volatile uint8_t rx_head;
+static volatile uint8_t rx_tail;
+static volatile bool rx_stalled;          // ring was full, packets wait in the radio
+static bool rx_dynamic;                   // width from R_RX_PL_WID, else RX_PW_Px
+static uint32_t ( *rx_clock )( void );
 
 /*
- * The payload sent over the radio. Also contains the recieved data.
- * Should be read with radio_get_pload_byte().
+ * Packets to send.  tx_tail .. tx_load are in the radio TX FIFO, tx_load
+ * .. tx_head wait for room.  A slot is freed when its packet is done,
+ * so a dropped packet's followers can be loaded again.  The index of a
+ * slot is the id of its packet.
  */
-static uint8_t pload[ RF_PAYLOAD_LENGTH ];
+typedef struct
+{
+    uint8_t length;
+    uint8_t data[ RF_MAX_PAYLOAD ];
+} radio_tx_slot_t;
+
+static radio_tx_slot_t tx_ring[ RADIO_TX_QUEUE ];
+static volatile uint8_t tx_head;          // written by radio_send_packet
+static volatile uint8_t tx_load;
+static volatile uint8_t tx_tail;
+static uint8_t tx_retries;
+static uint8_t tx_rounds;                 // retries used by the packet at tx_tail
+static radio_tx_done_t tx_done;
 
 /*
  * The current status of the radio. Should be set with radio_set_status(),
@@ -21,14 +45,67 @@ static uint8_t pload[ RF_PAYLOAD_LENGTH ];
  */
 static volatile radio_status_t status;
 static radio_mode_t radio_mode;
+static radio_config_t radio_config;
+
+/*
+ * Register image of a configuration, written in this order.  FEATURE
+ * has to be set before DYNPD, CONFIG last powers up a configured radio.
+ */
+enum
+{
+    IMG_EN_AA,
+    IMG_EN_RXADDR,
+    IMG_SETUP_AW,
+    IMG_SETUP_RETR,
+    IMG_RF_CH,
+    IMG_RF_SETUP,
+    IMG_RX_PW_P0,
+    IMG_FEATURE,
+    IMG_DYNPD,
+    IMG_CONFIG,
+    IMG_SIZE
+};
+
+static const code uint8_t image_reg[ IMG_SIZE ] =
+{
+    EN_AA, EN_RXADDR, SETUP_AW, SETUP_RETR, RF_CH, RF_SETUP, RX_PW_P0,
+    FEATURE, DYNPD, CONFIG
+};
+
+/*
+ * What the radio registers hold, radio_init writes only the ones its
+ * image changes.  Invalid until the first init wrote them all.
+ */
+static uint8_t shadow[ IMG_SIZE ];
+static bool shadow_valid;
+static bool features_active;              // FEATURE writable, ACTIVATE done
 
 /** The address of the radio. Parameter to the radio init */
 static const code uint8_t address[ HAL_NRF_AW_5BYTES ] = { RADIO_ADDRESS };
 
 
+/*
+ * Main context SPI traffic keeps the radio ISR out by masking its line
+ * only, a pending IRQ runs when it is unmasked.
+ */
+#define radio_irq_lock()    NVIC_IntDisable( IVT_INT_EXTI15_10 )
+#define radio_irq_unlock()  NVIC_IntEnable( IVT_INT_EXTI15_10 )
+
+
 static void radio_set_status( radio_status_t new_status );
 static void radio_wait( void );
 static void radio_bus_init( void );
+static void radio_rx_drain( void );
+static void radio_tx_fill( void );
+static void radio_tx_finish( radio_status_t result );
+static void radio_tx_service( uint8_t irq_flags );
+static void radio_build_image( radio_config_t* config, uint8_t* image );
+static void radio_apply_image( uint8_t* image );
+static void radio_default_init( radio_mode_t mode );
+#ifdef RADIO_SPI_DMA
+static void radio_dma_init( void );
+static void radio_dma_xfer( uint8_t* tx, uint8_t* rx, uint8_t length );
+#endif
 
 // Set status
 static void radio_set_status( radio_status_t new_status )
@@ -68,200 +145,313 @@ static void radio_bus_init()
 
     NVIC_IntEnable( IVT_INT_EXTI15_10 );   // Enable External interrupt
 
+#ifdef RADIO_SPI_DMA
+    radio_dma_init();
+#endif
+
     bus_initialized = true;
     // Note: Radio - By default all IRQ sources are enabled.
 }
 
-
-void radio_sb_init( hal_nrf_operation_mode_t operational_mode )
+/*
+ * Moves every packet in the radio RX FIFO to the ring.  One R_RX_PL_WID
+ * per packet gives pipe and width, STATUS comes with it, then one
+ * R_RX_PAYLOAD.  An empty FIFO costs a single command.
+ */
+static void radio_rx_drain()
 {
-    if( !bus_initialized  )
-        radio_bus_init();
-        
-    switch( operational_mode )
+    radio_packet_t* packet;
+    uint16_t source;
+    uint8_t pipe, width;
+    uint32_t now = ( rx_clock != 0 ) ? rx_clock() : 0;
+
+    rx_stalled = false;
+
+    while( 1 )
     {
-        case HAL_NRF_PRX:
-            radio_mode = DEVICE_PRX_SB;
+        source = hal_nrf_read_rx_source_width();
+        pipe   = source >> 8;
+
+        if( pipe > 5 )                      // 7 is an empty FIFO
             break;
-        case HAL_NRF_PTX:
-            radio_mode = DEVICE_PTX_SB;
+
+        if( ( uint8_t )( rx_head - rx_tail ) == RADIO_RX_QUEUE )
+        {
+            rx_stalled = true;
             break;
-    }
+        }
 
-    hal_nrf_close_pipe(HAL_NRF_ALL);               // First close all radio pipes
-    // Pipe 0 and 1 open by default
-    hal_nrf_open_pipe(HAL_NRF_PIPE0, false);       // Open pipe0, without/autoack
+        width = rx_dynamic ? ( uint8_t )source : hal_nrf_get_rx_pload_width( pipe );
 
-    hal_nrf_set_crc_mode(HAL_NRF_CRC_16BIT);       // Operates in 16bits CRC mode
-    hal_nrf_set_auto_retr(0, RF_RETRANS_DELAY);    // Disables auto retransmit
+        // the datasheet asks to flush a packet with a width over 32
+        if( width > RF_MAX_PAYLOAD )
+        {
+            hal_nrf_flush_rx();
+            break;
+        }
 
-    hal_nrf_set_address_width(HAL_NRF_AW_5BYTES);  // 5 bytes address width
-    hal_nrf_set_address(HAL_NRF_TX, address);      // Set device's addresses
-    hal_nrf_set_address(HAL_NRF_PIPE0, address);   // Sets recieving address on
-    // pipe0
+        packet = &rx_ring[ rx_head & ( RADIO_RX_QUEUE - 1 ) ];
+        packet->time   = now;
+        packet->pipe   = pipe;
+        packet->length = width;
+        hal_nrf_read_rx_fifo( packet->data, width );
 
-    if(operational_mode == HAL_NRF_PTX)            // Mode depentant settings
-    {
-        hal_nrf_set_operation_mode(HAL_NRF_PTX);     // Enter TX mode
-    }
-    else
-    {
-        hal_nrf_set_operation_mode(HAL_NRF_PRX);     // Enter RX mode
-        hal_nrf_set_rx_pload_width((uint8_t)HAL_NRF_PIPE0, RF_PAYLOAD_LENGTH);
-        // Pipe0 expect
-        // PAYLOAD_LENGTH byte payload
-        // PAYLOAD_LENGTH in radio.h
+        rx_head++;
     }
+}
 
-    hal_nrf_set_rf_channel(RF_CHANNEL);            // Operating on static channel
-    // Defined in radio.h.
-    // Frequenzy =
-    //        2400 + RF_CHANNEL
-    hal_nrf_set_power_mode(HAL_NRF_PWR_UP);        // Power up device
+/*
+ * Loads waiting packets while the radio TX FIFO has room.  In PTX CE
+ * stays high as long as packets are in flight, the radio then sends the
+ * next one as soon as the last is done.
+ */
+static void radio_tx_fill()
+{
+    radio_tx_slot_t* slot;
+
+    if( radio_mode == DEVICE_PRX_SB || radio_mode == DEVICE_PRX_ESB )
+        return;                             // kept until a mode that sends
+
+    while( tx_load != tx_head && ( uint8_t )( tx_load - tx_tail ) < RF_TX_FIFO )
+    {
+        slot = &tx_ring[ tx_load & ( RADIO_TX_QUEUE - 1 ) ];
 
-    //hal_nrf_set_datarate(HAL_NRF_1MBPS);           // Uncomment this line for
-    // compatibility with nRF2401
-    // and nRF24E1
+        if( radio_mode == DEVICE_PRX_PL )
+            hal_nrf_write_ack_pload( 0, slot->data, slot->length );
+        else
+            hal_nrf_write_tx_pload( slot->data, slot->length );
 
-    radio_wait();
+        tx_load++;
+    }
 
-    radio_set_status (RF_IDLE);                    // Radio now ready
+    if( radio_mode == DEVICE_PTX_SB || radio_mode == DEVICE_PTX_ESB
+        || radio_mode == DEVICE_PTX_PL )
+    {
+        if( tx_load != tx_tail )
+            chip_enable_high();
+        else
+            chip_enable_low();              // standby-I, not standby-II
+    }
 }
 
+// Frees the oldest packet in flight and reports it
+static void radio_tx_finish( radio_status_t result )
+{
+    uint8_t id = tx_tail;
 
+    tx_tail++;
+    tx_rounds = 0;
 
-void radio_pl_init( hal_nrf_operation_mode_t operational_mode )
+    if( tx_done != 0 )
+        tx_done( id, result );
+}
+
+/*
+ * TX_DS is one flag, the ISR has to run within a packet time, about
+ * 200 us at 2 Mbps, to see each packet sent.  An empty FIFO settles the
+ * count should one be missed.  MAX_RT is still set here, the radio holds
+ * the failed packet until it is cleared.  The caller loads the next
+ * packets.
+ */
+static void radio_tx_service( uint8_t irq_flags )
 {
-    if( !bus_initialized  )
-        radio_bus_init();
-        
-    switch( operational_mode )
+    if( irq_flags & ( 1 << HAL_NRF_TX_DS ) )
     {
-        case HAL_NRF_PRX:
-            radio_mode = DEVICE_PRX_PL;
-            break;
-        case HAL_NRF_PTX:
-            radio_mode = DEVICE_PTX_PL;
-            break;
+        if( hal_nrf_tx_fifo_empty() )
+        {
+            while( tx_tail != tx_load )
+                radio_tx_finish( ( irq_flags & ( 1 << HAL_NRF_RX_DR ) ) ? RF_TX_AP : RF_TX_DS );
+        }
+        else if( tx_tail != tx_load )
+        {
+            radio_tx_finish( ( irq_flags & ( 1 << HAL_NRF_RX_DR ) ) ? RF_TX_AP : RF_TX_DS );
+        }
     }
 
-    hal_nrf_close_pipe(HAL_NRF_ALL);               // First close all radio pipes
-    // Pipe 0 and 1 open by default
-    hal_nrf_open_pipe(HAL_NRF_PIPE0, true);        // Then open pipe0, w/autoack
-
-    hal_nrf_set_crc_mode(HAL_NRF_CRC_16BIT);       // Operates in 16bits CRC mode
-    hal_nrf_set_auto_retr(RF_RETRANSMITS, RF_RETRANS_DELAY);
-    // Enables auto retransmit.
-    // 3 retrans with 250ms delay
-
-    hal_nrf_set_address_width(HAL_NRF_AW_5BYTES);  // 5 bytes address width
-    hal_nrf_set_address(HAL_NRF_TX, address);      // Set device's addresses
-    hal_nrf_set_address(HAL_NRF_PIPE0, address);   // Sets recieving address on
-    // pipe0
-
-    /*****************************************************************************
-     * Changed from esb/radio_esb.c                                              *
-     * Enables:                                                                  *
-     *  - ACK payload                                                            *
-     *  - Dynamic payload width                                                  *
-     *  - Dynamic ACK                                                            *
-     *****************************************************************************/
-    hal_nrf_enable_ack_pl();                       // Try to enable ack payload
-
-    // When the features are locked, the FEATURE and DYNPD are read out 0x00
-    // even after we have tried to enable ack payload. This mean that we need to
-    // activate the features.
-    if(hal_nrf_read_reg(FEATURE) == 0x00 && (hal_nrf_read_reg( DYNPD ) == 0x00))
+    if( irq_flags & ( 1 << HAL_NRF_MAX_RT ) )
     {
-        hal_nrf_lock_unlock ();                    // Activate features
-        hal_nrf_enable_ack_pl();                   // Enables payload in ack
+        if( tx_tail == tx_load )
+        {
+            hal_nrf_flush_tx();             // not a queued packet
+        }
+        else if( tx_rounds < tx_retries )
+        {
+            tx_rounds++;                    // same packet, another round
+        }
+        else
+        {
+            chip_enable_low();
+            hal_nrf_flush_tx();             // the followers are loaded again
+            tx_load = tx_tail + 1;
+            radio_tx_finish( RF_MAX_RT );
+        }
+
+        hal_nrf_clear_irq_flag( HAL_NRF_MAX_RT );
     }
+}
+
 
-    hal_nrf_enable_dynamic_pl();                   // Enables dynamic payload
-    hal_nrf_setup_dyn_pl( ALL_PIPES );             // Sets up dynamic payload on
-    // all data pipes.
-    /*****************************************************************************
-     * End changes from esb/radio_esb.c                                          *
-     *****************************************************************************/
+static void radio_build_image( radio_config_t* config, uint8_t* image )
+{
+    uint8_t link = ( config->mode - DEVICE_PRX_SB ) % 3;    // 0 SB, 1 ESB, 2 PL
+
+    image[ IMG_EN_AA ]      = ( link == 0 ) ? 0 : ( 1 << HAL_NRF_PIPE0 );
+    image[ IMG_EN_RXADDR ]  = ( 1 << HAL_NRF_PIPE0 );
+    image[ IMG_SETUP_AW ]   = HAL_NRF_AW_5BYTES - 2;
+    image[ IMG_SETUP_RETR ] = ( ( config->retrans_delay / 250 - 1 ) << 4 )
+                              | ( ( link == 0 ) ? 0 : config->retransmits );
+    image[ IMG_RF_CH ]      = config->channel;
+    image[ IMG_RF_SETUP ]   = ( config->datarate << RF_DR ) | ( config->power << RF_PWR0 )
+                              | ( 1 << LNA_HCURR );
+    image[ IMG_RX_PW_P0 ]   = RF_PAYLOAD_LENGTH;
+
+    // ack payload and dynamic payload width on all pipes
+    image[ IMG_FEATURE ]    = ( link == 2 ) ? 0x06 : 0;
+    image[ IMG_DYNPD ]      = ( link == 2 ) ? ALL_PIPES : 0;
+
+    image[ IMG_CONFIG ]     = ( 1 << EN_CRC ) | ( 1 << CRCO ) | ( 1 << PWR_UP )
+                              | ( ( config->mode < DEVICE_PTX_SB ) ? ( 1 << PRIM_RX ) : 0 );
+}
 
-    if(operational_mode == HAL_NRF_PTX)            // Mode depentant settings
+/*
+ * Writes the registers that differ from the shadow, one command each.
+ * FEATURE of an nRF24L01 reads 0 until ACTIVATE, the first write of it
+ * is read back to find out.
+ */
+static void radio_apply_image( uint8_t* image )
+{
+    uint8_t i;
+    bool power_up = !shadow_valid || !( shadow[ IMG_CONFIG ] & ( 1 << PWR_UP ) );
+
+    if( !shadow_valid )
     {
-        hal_nrf_set_operation_mode(HAL_NRF_PTX);   // Enter TX mode
+        hal_nrf_write_multibyte_reg( HAL_NRF_TX, address, HAL_NRF_AW_5BYTES );
+        hal_nrf_write_multibyte_reg( HAL_NRF_PIPE0, address, HAL_NRF_AW_5BYTES );
     }
-    else
+
+    for( i = 0; i < IMG_SIZE; i++ )
     {
-        hal_nrf_set_operation_mode(HAL_NRF_PRX);   // Enter RX mode
-        hal_nrf_set_rx_pload_width((uint8_t)HAL_NRF_PIPE0, RF_PAYLOAD_LENGTH);
-        // Pipe0 expect
-        // PAYLOAD_LENGTH byte payload
-        // PAYLOAD_LENGTH in radio.h
+        if( shadow_valid && shadow[ i ] == image[ i ] )
+            continue;
+
+        hal_nrf_write_reg( image_reg[ i ], image[ i ] );
+
+        if( i == IMG_FEATURE && image[ i ] != 0 && !features_active )
+        {
+            if( hal_nrf_read_reg( FEATURE ) != image[ i ] )
+            {
+                hal_nrf_lock_unlock();
+                hal_nrf_write_reg( FEATURE, image[ i ] );
+            }
+
+            features_active = true;
+        }
+
+        shadow[ i ] = image[ i ];
     }
 
-    hal_nrf_set_rf_channel(RF_CHANNEL);            // Operating on static channel
-    // Defined in radio.h.
-    // Frequenzy =
-    //        2400 + RF_CHANNEL
-    hal_nrf_set_power_mode(HAL_NRF_PWR_UP);        // Power up device
+    shadow_valid = true;
 
-    radio_wait();
+    if( power_up )
+        radio_wait();
+}
 
-    radio_set_status (RF_IDLE);                    // Radio now ready
+// The configurations of the fixed init functions
+static void radio_default_init( radio_mode_t mode )
+{
+    radio_config_t config;
+
+    config.mode          = mode;
+    config.channel       = RF_CHANNEL;
+    config.retransmits   = RF_RETRANSMITS;
+    config.retrans_delay = RF_RETRANS_DELAY;
+    config.datarate      = HAL_NRF_2MBPS;
+    config.power         = HAL_NRF_0DBM;
+
+    radio_init( &config );
 }
 
 
-void radio_esb_init( hal_nrf_operation_mode_t operational_mode )
+int radio_init( radio_config_t* config )
 {
+    uint8_t image[ IMG_SIZE ], irq_flags;
+
+    if( config->mode < DEVICE_PRX_SB || config->mode > DEVICE_PTX_PL
+        || config->channel > 125 || config->retransmits > 15
+        || config->retrans_delay < 250 || config->retrans_delay > 4000 )
+        return -1;
+
     if( !bus_initialized  )
         radio_bus_init();
-        
-    switch( operational_mode )
-    {
-        case HAL_NRF_PRX:
-            radio_mode = DEVICE_PRX_ESB;
-            break;
-        case HAL_NRF_PTX:
-            radio_mode = DEVICE_PTX_ESB;
-            break;
-    }
 
-    hal_nrf_close_pipe( HAL_NRF_ALL );               // First close all radio pipes
-    // Pipe 0 and 1 open by default
-    hal_nrf_open_pipe( HAL_NRF_PIPE0, true );        // Then open pipe0, w/autoack
-    // Changed from sb/radio_sb.c
+    radio_build_image( config, image );
+
+    radio_irq_lock();
 
-    hal_nrf_set_crc_mode( HAL_NRF_CRC_16BIT );       // Operates in 16bits CRC mode
-    hal_nrf_set_auto_retr( RF_RETRANSMITS, RF_RETRANS_DELAY );
-    // Enables auto retransmit.
-    // 3 retrans with 250ms delay
-    // Changed from sb/radio_sb.c
+    chip_enable_low();                      // registers are written in standby
 
-    hal_nrf_set_address_width( HAL_NRF_AW_5BYTES );  // 5 bytes address width
-    hal_nrf_set_address( HAL_NRF_TX, address );      // Set device's addresses
-    hal_nrf_set_address( HAL_NRF_PIPE0, address );   // Sets recieving address on
-    // pipe0
+    // packets the radio finished before the ISR saw them are reported
+    // first, only the ones still in its FIFO are loaded again
+    irq_flags = hal_nrf_write_reg( STATUS, ( 1 << HAL_NRF_TX_DS ) )
+                & ( ( 1 << HAL_NRF_TX_DS ) | ( 1 << HAL_NRF_MAX_RT ) );
 
-    if( operational_mode == HAL_NRF_PTX )            // Mode depentant settings
+    if( irq_flags )
+        radio_tx_service( irq_flags );
+
+    // packets in flight are loaded again in the new mode
+    if( tx_load != tx_tail )
     {
-        hal_nrf_set_operation_mode( HAL_NRF_PTX );     // Enter TX mode
+        hal_nrf_flush_tx();
+        tx_load = tx_tail;
     }
+
+    radio_config = *config;
+    radio_mode   = config->mode;
+    rx_dynamic   = ( radio_mode == DEVICE_PRX_PL || radio_mode == DEVICE_PTX_PL );
+
+    radio_apply_image( image );
+
+    if( radio_mode < DEVICE_PTX_SB )
+        chip_enable_high();                 // PRX listens
     else
-    {
-        hal_nrf_set_operation_mode( HAL_NRF_PRX );     // Enter RX mode
-        hal_nrf_set_rx_pload_width( (uint8_t)HAL_NRF_PIPE0, RF_PAYLOAD_LENGTH );
-        // Pipe0 expect
-        // PAYLOAD_LENGTH byte payload
-        // PAYLOAD_LENGTH in radio.h
-    }
+        radio_tx_fill();
 
-    hal_nrf_set_rf_channel( RF_CHANNEL );            // Operating on static channel
-    // Defined in radio.h.
-    // Frequenzy =
-    //        2400 + RF_CHANNEL
-    hal_nrf_set_power_mode( HAL_NRF_PWR_UP );        // Power up device
+    radio_irq_unlock();
 
-    radio_wait();
+    radio_set_status( RF_IDLE );            // Radio now ready
 
-    radio_set_status( RF_IDLE );                     // Radio now ready
+    return 0;
+}
+
+int radio_set_role( hal_nrf_operation_mode_t operational_mode )
+{
+    radio_config_t config = radio_config;
+
+    if( !shadow_valid )
+        return -1;
+
+    // the PTX modes follow the PRX modes of the same link in the same order
+    if( operational_mode == HAL_NRF_PTX && config.mode < DEVICE_PTX_SB )
+        config.mode += DEVICE_PTX_SB - DEVICE_PRX_SB;
+    else if( operational_mode == HAL_NRF_PRX && config.mode >= DEVICE_PTX_SB )
+        config.mode -= DEVICE_PTX_SB - DEVICE_PRX_SB;
+
+    return radio_init( &config );
+}
+
+void radio_sb_init( hal_nrf_operation_mode_t operational_mode )
+{
+    radio_default_init( ( operational_mode == HAL_NRF_PTX ) ? DEVICE_PTX_SB : DEVICE_PRX_SB );
+}
+
+void radio_pl_init( hal_nrf_operation_mode_t operational_mode )
+{
+    radio_default_init( ( operational_mode == HAL_NRF_PTX ) ? DEVICE_PTX_PL : DEVICE_PRX_PL );
+}
+
+void radio_esb_init( hal_nrf_operation_mode_t operational_mode )
+{
+    radio_default_init( ( operational_mode == HAL_NRF_PTX ) ? DEVICE_PTX_ESB : DEVICE_PRX_ESB );
 }
 
 
@@ -270,33 +460,61 @@ uint8_t* radio_get_address()
     return address;
 }
 
-void radio_send_packet( uint8_t* packet, uint8_t length )
+int radio_send_packet( uint8_t* packet, uint8_t length )
 {
-    // trans. in progress; RF_BUSY
-    radio_set_status( RF_BUSY );
-    // load message into radio
+    radio_tx_slot_t* slot;
+    uint8_t id, i;
+
     switch( radio_mode )
     {
         case DEVICE_PRX_PL:
-            hal_nrf_write_ack_pload( 0, packet, length );
-            break;
         case DEVICE_PTX_PL:
-            hal_nrf_write_tx_pload( packet, length );
-            break;
-        case DEVICE_PRX_SB:
-            break;
         case DEVICE_PTX_SB:
-            break;
-        case DEVICE_PRX_ESB:
-            break;
         case DEVICE_PTX_ESB:
             break;
+        default:                            // PRX without ack payload
+            return -1;
     }
-    //hal_nrf_write_tx_pload( packet, length );
-    // send packet
-    chip_enable_pulse();
-    // Set back to idle
-    radio_set_status( RF_IDLE );
+
+    if( length == 0 || length > RF_MAX_PAYLOAD )
+        return -1;
+
+    // only this function moves tx_head, the ISR may free slots meanwhile
+    id = tx_head;
+
+    if( ( uint8_t )( id - tx_tail ) >= RADIO_TX_QUEUE )
+        return -1;
+
+    slot = &tx_ring[ id & ( RADIO_TX_QUEUE - 1 ) ];
+    slot->length = length;
+
+    for( i = 0; i < length; i++ )
+        slot->data[ i ] = packet[ i ];
+
+    // trans. in progress; RF_BUSY
+    radio_set_status( RF_BUSY );
+
+    radio_irq_lock();
+    tx_head = id + 1;
+    radio_tx_fill();
+    radio_irq_unlock();
+
+    return id;
+}
+
+void radio_set_tx_done( radio_tx_done_t done )
+{
+    tx_done = done;
+}
+
+void radio_set_tx_retries( uint8_t rounds )
+{
+    tx_retries = rounds;
+}
+
+uint8_t radio_tx_pending()
+{
+    return tx_head - tx_tail;
 }
 
 radio_status_t radio_get_status()
@@ -306,7 +524,39 @@ radio_status_t radio_get_status()
 
 uint8_t radio_get_pload_byte( uint8_t byte_index )
 {
-    return pload[ byte_index ];
+    if( rx_head == rx_tail || byte_index >= RF_MAX_PAYLOAD )
+        return 0;
+
+    return rx_ring[ rx_tail & ( RADIO_RX_QUEUE - 1 ) ].data[ byte_index ];
+}
+
+void radio_set_clock( uint32_t ( *clock )( void ) )
+{
+    rx_clock = clock;
+}
+
+bool radio_receive( radio_packet_t* packet )
+{
+    if( rx_head == rx_tail )
+        return false;
+
+    *packet = rx_ring[ rx_tail & ( RADIO_RX_QUEUE - 1 ) ];
+    rx_tail++;
+
+    // room again for what the IRQ had to leave in the radio FIFO
+    if( rx_stalled )
+    {
+        radio_irq_lock();
+        radio_rx_drain();
+        radio_irq_unlock();
+    }
+
+    return true;
+}
+
+uint8_t radio_rx_count()
+{
+    return rx_head - rx_tail;
 }
 
 uint8_t hal_nrf_rw( uint8_t value )
@@ -314,19 +564,109 @@ uint8_t hal_nrf_rw( uint8_t value )
     return SPI2_Read( value );
 }
 
+#ifdef RADIO_SPI_DMA
+/*
+ * SPI2 on DMA1 channel 0, stream 4 feeds SPI2_DR and stream 3 empties
+ * it.  Only the transfer enables the SPI DMA requests, SPI2_Read keeps
+ * working for single bytes.
+ */
+#define DMA_SxCR_EN     ( 1UL << 0 )
+#define DMA_SxCR_M2P    ( 1UL << 6 )
+#define DMA_SxCR_MINC   ( 1UL << 10 )
+#define DMA_S3_FLAGS    0x0F400000UL        // FEIF3, DMEIF3, TEIF3, HTIF3, TCIF3
+#define DMA_S3_TCIF     ( 1UL << 27 )
+#define DMA_S4_FLAGS    0x0000003DUL        // FEIF4, DMEIF4, TEIF4, HTIF4, TCIF4
+#define SPI_CR2_RXDMAEN ( 1 << 0 )
+#define SPI_CR2_TXDMAEN ( 1 << 1 )
+
+static uint8_t dma_zero;                    // sent when there is no tx
+static uint8_t dma_sink;                    // received when there is no rx
+
+static void radio_dma_init()
+{
+    RCC_AHB1ENR |= ( 1UL << 21 );           // DMA1EN
+
+    DMA1_S3PAR = ( uint32_t )&SPI2_DR;
+    DMA1_S4PAR = ( uint32_t )&SPI2_DR;
+}
+
+static void radio_dma_xfer( uint8_t* tx, uint8_t* rx, uint8_t length )
+{
+    DMA1_LIFCR = DMA_S3_FLAGS;
+    DMA1_HIFCR = DMA_S4_FLAGS;
+
+    DMA1_S3M0AR = ( rx != 0 ) ? ( uint32_t )rx : ( uint32_t )&dma_sink;
+    DMA1_S3NDTR = length;
+    DMA1_S3CR   = ( rx != 0 ) ? DMA_SxCR_MINC : 0;
+
+    DMA1_S4M0AR = ( tx != 0 ) ? ( uint32_t )tx : ( uint32_t )&dma_zero;
+    DMA1_S4NDTR = length;
+    DMA1_S4CR   = DMA_SxCR_M2P | ( ( tx != 0 ) ? DMA_SxCR_MINC : 0 );
+
+    // RX first so no byte is missed, TX requests start the clock
+    SPI2_CR2  |= SPI_CR2_RXDMAEN;
+    DMA1_S3CR |= DMA_SxCR_EN;
+    DMA1_S4CR |= DMA_SxCR_EN;
+    SPI2_CR2  |= SPI_CR2_TXDMAEN;
+
+    // the last byte received ends the transfer, both streams stop by
+    // themselves
+    while( !( DMA1_LISR & DMA_S3_TCIF ) )
+        ;
+
+    SPI2_CR2 &= ~( SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN );
+}
+#endif
+
+void hal_nrf_spi_xfer( uint8_t* tx, uint8_t* rx, uint8_t length )
+{
+    uint8_t value;
+
+#ifdef RADIO_SPI_DMA
+    if( length >= RADIO_DMA_MIN )
+    {
+        radio_dma_xfer( tx, rx, length );
+        return;
+    }
+#endif
+
+    while( length-- )
+    {
+        value = SPI2_Read( ( tx != 0 ) ? *tx++ : 0 );
+
+        if( rx != 0 )
+            *rx++ = value;
+    }
+}
+
 
 
 
 
 void radio_ISR() iv IVT_INT_EXTI15_10 ics ICS_AUTO
 {
-    EXTI_PR |= ( 1 << PR10 );               // clear flag
-    DisableInterrupts();
+    uint8_t irq_flags;
 
-    switch( hal_nrf_get_clear_irq_flags() )
+    EXTI_PR = ( 1 << PR10 );                // clear flag, write 1 clears
+
+    // RX_DR and TX_DS are cleared first, a packet arriving during the
+    // drain raises the IRQ again.  MAX_RT stays until the TX queue has
+    // decided, clearing it lets the radio send again.
+    irq_flags = hal_nrf_write_reg( STATUS, ( 1 << HAL_NRF_RX_DR ) | ( 1 << HAL_NRF_TX_DS ) )
+                & ( ( 1 << HAL_NRF_RX_DR ) | ( 1 << HAL_NRF_TX_DS ) | ( 1 << HAL_NRF_MAX_RT ) );
+
+    if( irq_flags & ( 1 << HAL_NRF_RX_DR ) )
+        radio_rx_drain();
+
+    if( irq_flags & ( ( 1 << HAL_NRF_TX_DS ) | ( 1 << HAL_NRF_MAX_RT ) ) )
+    {
+        radio_tx_service( irq_flags );
+        radio_tx_fill();
+    }
+
+    switch( irq_flags )
     {
         case ( 1 << HAL_NRF_MAX_RT ):       // Max retries reached
-            //hal_nrf_flush_tx();             // flush tx fifo, avoid fifo jam
             radio_set_status( RF_MAX_RT );
             break;
 
@@ -335,22 +675,10 @@ void radio_ISR() iv IVT_INT_EXTI15_10 ics ICS_AUTO
             break;
 
         case ( 1 << HAL_NRF_RX_DR ):        // Packet received
-            /*
-            while ( !hal_nrf_rx_fifo_empty() )
-            {
-                hal_nrf_read_rx_pload( pload );
-            }
-            */
             radio_set_status( RF_RX_DR );
             break;
 
         case ( ( 1 << HAL_NRF_RX_DR ) | ( 1 << HAL_NRF_TX_DS ) ): // Ack payload recieved
-            /*
-            while ( !hal_nrf_rx_fifo_empty() )
-            {
-                hal_nrf_read_rx_pload( pload );
-            }
-            */
             radio_set_status( RF_TX_AP );
             break;
 
@@ -358,6 +686,4 @@ void radio_ISR() iv IVT_INT_EXTI15_10 ics ICS_AUTO
             // Pretty debugging goes here
             break;
     }
-
-    EnableInterrupts();
 }
\ No newline at end of file
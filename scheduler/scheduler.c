@@ -7,7 +7,8 @@ typedef struct
     uint8_t   id;                // task ID
     task_t    task;              // pointer to the task
     volatile uint32_t  delay;             // delay before execution
-    uint32_t  period;
+    uint32_t  period;            // SCH_EVENT for triggered tasks
+    uint8_t   once;              // deleted after the next run
     task_status_e task_status;   // status of task
 } task_control_t;
 
@@ -71,6 +72,7 @@ uint8_t task_add( task_t task, uint32_t period )
             task_list[task_id].task        = task;
             task_list[task_id].delay       = ceil( time_calc );
             task_list[task_id].period      = task_list[task_id].delay;
+            task_list[task_id].once        = 0;
 
             return task_list[task_id].id;
         }
@@ -79,6 +81,30 @@ uint8_t task_add( task_t task, uint32_t period )
     return TASK_ERROR;
 }
 
+// adds a task that waits for task_trigger
+uint8_t task_add_event( task_t task, uint8_t once )
+{
+    task_control_t* tcb = find_task( task_add( task, SCH_SECONDS_1 ) );
+
+    if( tcb == 0 ) return TASK_ERROR;
+
+    tcb->delay  = SCH_EVENT;
+    tcb->period = SCH_EVENT;
+    tcb->once   = once;
+
+    return tcb->id;
+}
+
+// makes an event task due
+void task_trigger( uint8_t id )
+{
+    task_control_t* task = find_task( id );
+
+    if( task == 0 || task->period != SCH_EVENT ) return;
+
+    task->delay = 0;
+}
+
 // remove task from task list
 // note STOPPED is equivalent
 // to removing a task
@@ -147,9 +173,23 @@ void task_dispatch()
             if( ( task_list[i].delay == 0 ) && ( task_list[i].task_status == TASK_RUNNABLE ) )
             {
                 task_list[i].task_status = TASK_RUNNING;  // task is now running
-                ( *task_list[i].task )();                 // call the task
-                task_list[i].delay = task_list[i].period; // reset the delay
-                task_list[i].task_status = TASK_RUNNABLE; // task is runnable again
+
+                if( task_list[i].period == SCH_EVENT )
+                {
+                    // rearmed first, so a trigger while it runs is kept
+                    task_list[i].delay = SCH_EVENT;
+                    ( *task_list[i].task )();
+                }
+                else
+                {
+                    ( *task_list[i].task )();                 // call the task
+                    task_list[i].delay = task_list[i].period; // reset the delay
+                }
+
+                if( task_list[i].once )
+                    task_delete( task_list[i].id );
+                else
+                    task_list[i].task_status = TASK_RUNNABLE; // task is runnable again
             }
         }
     }
@@ -182,7 +222,7 @@ void task_scheduler_clock()
         {
             if( task_list[i].task_status == TASK_RUNNABLE )
             {
-                if( task_list[i].delay > 0 )
+                if( task_list[i].delay > 0 && task_list[i].period != SCH_EVENT )
                 {
                     task_list[i].delay--;
                 }
@@ -67,6 +67,7 @@
 #define SCH_HOURS_1     SCH_MINUTES_30 * 2
 #define SCH_HOURS_12    SCH_HOURS_1 * 12
 #define SCH_DAY_1       SCH_HOURS_12 * 2
+#define SCH_EVENT       0xFFFFFFFFUL    // period of tasks run by task_trigger
 
 /* pointer to a void function with no arguments */
 typedef void ( *task_t )( void );
@@ -116,6 +117,30 @@ void task_scheduler_init( uint16_t clock );
 uint8_t task_add( task_t task, uint32_t period );
 
 
+/**
+ *  @brief Adds a task that runs when triggered instead of periodically
+ *
+ *  @pre Scheduler must be initialized first
+ *
+ *  @param task_t task - Function that will be called when triggered
+ *  @param uint8_t once - delete the task after it ran
+ *
+ *  @returns uint8_t - id of created task, TASK_ERROR when the list is full
+ */
+uint8_t task_add_event( task_t task, uint8_t once );
+
+
+/**
+ *  @brief Runs an event task on the next task_dispatch
+ *
+ *  Can be called from an ISR.  A trigger while the task runs makes it
+ *  run once more.
+ *
+ *  @param uint8_t id - id of a task from task_add_event
+ */
+void task_trigger( uint8_t id );
+
+
 /**
  *  @brief Deletes task from scheduler
  *
@@ -0,0 +1,445 @@
+#include <string.h>
+#include "task_calendar.h"
+
+#define SECONDS_IN_HOUR 3600UL
+#define SECONDS_IN_DAY  86400UL
+#define CRON_HORIZON    ( 8 * 366 * SECONDS_IN_DAY )  // covers 29 February
+#define CRON_MDAY       0x01    // day of month field was given
+#define CRON_WDAY       0x02    // day of week field was given
+
+// keeps the ISR out while a 32 bit value shared with the tick changes
+#ifdef __MIKROC_PRO_FOR_AVR__
+static uint8_t irq_state;
+#define CAL_LOCK()      irq_state = SREG_I_bit; SREG_I_bit = 0
+#define CAL_UNLOCK()    SREG_I_bit = irq_state
+#endif
+
+#ifdef __MIKROC_PRO_FOR_ARM__
+#define CAL_LOCK()      DisableInterrupts()
+#define CAL_UNLOCK()    EnableInterrupts()
+#endif
+
+#ifndef CAL_LOCK
+#define CAL_LOCK()
+#define CAL_UNLOCK()
+#endif
+
+// cron fields as bit masks, bit n set when value n matches
+typedef struct
+{
+    uint32_t minute[2];          // 0 .. 59
+    uint32_t hour;               // 0 .. 23
+    uint32_t mday;               // 1 .. 31
+    uint32_t month;              // 1 .. 12
+    uint32_t wday;               // 0 .. 6, sunday is 0
+    uint8_t  given;              // CRON_MDAY, CRON_WDAY
+} cron_t;
+
+// calendar event
+typedef struct
+{
+    uint32_t  due;               // GMT of the next run
+    cron_t    cron;
+    uint8_t   id;                // scheduler task, 0 when free
+    uint8_t   once;              // task_at, no cron
+} cal_event_t;
+
+static cal_event_t events[MAX_EVENTS];
+// events by due time, first is next
+static uint8_t order[MAX_EVENTS];
+static uint8_t count;
+static ds1307_tz_t zone;
+// calendar's own event task
+static uint8_t run_id;
+
+// shared with task_calendar_tick
+static volatile uint32_t now;
+static volatile uint32_t next_due = CAL_NEVER;
+static volatile uint8_t kicked;
+
+/*******************
+ *  Private
+ ******************/
+static const char* cron_field( const char* p, uint8_t lo, uint8_t hi, uint32_t* mask );
+static uint8_t cron_parse( cron_t* c, const char* spec );
+static uint8_t cron_day( cron_t* c, TimeStruct* ts );
+static uint32_t cron_next( cron_t* c, uint32_t gmt );
+static uint8_t cal_add( task_t task, uint8_t once, cron_t* c, uint32_t gmt );
+static void cal_insert( uint8_t e );
+static void cal_unlink( uint8_t pos );
+static void cal_arm( void );
+static void calendar_run( void );
+
+
+// one field, a list of n, n-m, * each with an optional /step
+static const char* cron_field( const char* p, uint8_t lo, uint8_t hi, uint32_t* mask )
+{
+    uint16_t a, b, step, v;
+
+    while( 1 )
+    {
+        if( *p == '*' )
+        {
+            a = lo;
+            b = hi;
+            p++;
+        }
+        else
+        {
+            if( *p < '0' || *p > '9' ) return 0;
+            for( a = 0; *p >= '0' && *p <= '9' && a <= hi; p++ )
+                a = a * 10 + ( *p - '0' );
+            b = a;
+
+            if( *p == '-' )
+            {
+                p++;
+                if( *p < '0' || *p > '9' ) return 0;
+                for( b = 0; *p >= '0' && *p <= '9' && b <= hi; p++ )
+                    b = b * 10 + ( *p - '0' );
+            }
+        }
+
+        step = 1;
+        if( *p == '/' )
+        {
+            p++;
+            if( *p < '1' || *p > '9' ) return 0;
+            for( step = 0; *p >= '0' && *p <= '9' && step <= hi; p++ )
+                step = step * 10 + ( *p - '0' );
+        }
+
+        if( a < lo || b > hi || a > b || step == 0 ) return 0;
+
+        for( v = a; v <= b; v += step )
+            mask[v >> 5] |= 1UL << ( v & 31 );
+
+        if( *p != ',' ) return p;
+        p++;
+    }
+}
+
+// five fields separated by spaces, returns 0 on error
+static uint8_t cron_parse( cron_t* c, const char* spec )
+{
+    uint32_t wday = 0;
+
+    memset( c, 0, sizeof( cron_t ) );
+
+    while( *spec == ' ' ) spec++;
+    spec = cron_field( spec, 0, 59, c->minute );
+    if( spec == 0 || *spec != ' ' ) return 0;
+
+    while( *spec == ' ' ) spec++;
+    spec = cron_field( spec, 0, 23, &c->hour );
+    if( spec == 0 || *spec != ' ' ) return 0;
+
+    while( *spec == ' ' ) spec++;
+    if( *spec != '*' ) c->given |= CRON_MDAY;
+    spec = cron_field( spec, 1, 31, &c->mday );
+    if( spec == 0 || *spec != ' ' ) return 0;
+
+    while( *spec == ' ' ) spec++;
+    spec = cron_field( spec, 1, 12, &c->month );
+    if( spec == 0 || *spec != ' ' ) return 0;
+
+    while( *spec == ' ' ) spec++;
+    if( *spec != '*' ) c->given |= CRON_WDAY;
+    spec = cron_field( spec, 0, 7, &wday );
+    if( spec == 0 ) return 0;
+
+    while( *spec == ' ' ) spec++;
+    if( *spec != '\0' ) return 0;
+
+    // 7 is sunday too
+    c->wday = ( wday | ( wday >> 7 ) ) & 0x7F;
+
+    return 1;
+}
+
+// cron takes a day matching either field when both were given
+static uint8_t cron_day( cron_t* c, TimeStruct* ts )
+{
+    // TimeStruct weekday counts from monday
+    uint8_t mday = ( c->mday >> ts->md ) & 1;
+    uint8_t wday = ( c->wday >> ( ( ts->wd + 1 ) % 7 ) ) & 1;
+
+    if( c->given == ( CRON_MDAY | CRON_WDAY ) )
+        return mday | wday;
+
+    return mday & wday;
+}
+
+/* first run after gmt, CAL_NEVER when there is none within the horizon
+   the search is in local time and skips whole months, days and hours
+   that do not match */
+static uint32_t cron_next( cron_t* c, uint32_t gmt )
+{
+    TimeStruct ts;
+    uint32_t local, limit, due;
+    uint8_t mn;
+
+    local = ds1307_tz_local( &zone, gmt );
+    local = local - local % 60 + 60;
+    limit = local + CRON_HORIZON;
+
+    while( local < limit )
+    {
+        Time_epochToDateU( local, &ts );
+
+        if( ( ( c->month >> ts.mo ) & 1 ) == 0 )
+        {
+            ts.md = 1;
+            ts.hh = 0;
+            ts.mn = 0;
+            ts.ss = 0;
+            if( ++ts.mo > 12 )
+            {
+                ts.mo = 1;
+                ts.yy++;
+            }
+            local = Time_dateToEpochU( &ts );
+            continue;
+        }
+
+        if( !cron_day( c, &ts ) )
+        {
+            local = local - local % SECONDS_IN_DAY + SECONDS_IN_DAY;
+            continue;
+        }
+
+        for( mn = ts.mn; mn < 60 && ( ( c->minute[mn >> 5] >> ( mn & 31 ) ) & 1 ) == 0; mn++ );
+
+        if( ( ( c->hour >> ts.hh ) & 1 ) == 0 || mn == 60 )
+        {
+            local = local - local % SECONDS_IN_HOUR + SECONDS_IN_HOUR;
+            continue;
+        }
+
+        local += ( mn - ts.mn ) * 60UL;
+
+        // a time that happens twice is taken the first time
+        due = ds1307_tz_gmt( &zone, local );
+        if( due > gmt ) return due;
+
+        local += 60;
+    }
+
+    return CAL_NEVER;
+}
+
+// takes a free event and its task, returns the task id
+static uint8_t cal_add( task_t task, uint8_t once, cron_t* c, uint32_t gmt )
+{
+    uint8_t e;
+
+    if( count == MAX_EVENTS || gmt == CAL_NEVER ) return TASK_ERROR;
+
+    for( e = 0; events[e].id != 0; e++ );
+
+    events[e].id = task_add_event( task, once );
+    if( events[e].id == TASK_ERROR )
+    {
+        events[e].id = 0;
+        return TASK_ERROR;
+    }
+
+    events[e].once = once;
+    events[e].due  = gmt;
+    if( c != 0 ) events[e].cron = *c;
+
+    cal_insert( e );
+    cal_arm();
+
+    return events[e].id;
+}
+
+// sorted insert, equal times keep the order they were added in
+static void cal_insert( uint8_t e )
+{
+    uint8_t pos = count;
+
+    while( pos > 0 && events[order[pos - 1]].due > events[e].due )
+    {
+        order[pos] = order[pos - 1];
+        pos--;
+    }
+
+    order[pos] = e;
+    count++;
+}
+
+static void cal_unlink( uint8_t pos )
+{
+    count--;
+    for( ; pos < count; pos++ )
+        order[pos] = order[pos + 1];
+}
+
+// hands the first due time to the tick
+static void cal_arm()
+{
+    uint32_t due = ( count == 0 ) ? CAL_NEVER : events[order[0]].due;
+
+    CAL_LOCK();
+    next_due = due;
+    CAL_UNLOCK();
+}
+
+// runs from task_dispatch when the tick found an event due
+static void calendar_run()
+{
+    uint32_t t = ( uint32_t )ds1307_get_GMT_unix_time();
+    uint8_t e;
+
+    // the RTC is the clock, the tick only counts between events
+    CAL_LOCK();
+    now = t;
+    kicked = 0;
+    CAL_UNLOCK();
+
+    while( count > 0 && events[order[0]].due <= t )
+    {
+        e = order[0];
+        cal_unlink( 0 );
+        task_trigger( events[e].id );
+
+        if( events[e].once )
+        {
+            events[e].id = 0;   // scheduler deletes the task after it ran
+        }
+        else
+        {
+            events[e].due = cron_next( &events[e].cron, t );
+            cal_insert( e );
+        }
+    }
+
+    cal_arm();
+}
+
+
+// initialises the calendar
+int task_calendar_init( ds1307_config_t* rtc )
+{
+    uint8_t e;
+
+    if( ds1307_tz_set( &zone, rtc->tz_offset, rtc->dst_rule ) != 0 ) return -1;
+
+    run_id = task_add_event( calendar_run, 0 );
+    if( run_id == TASK_ERROR ) return -1;
+
+    for( e = 0; e < MAX_EVENTS; e++ )
+        events[e].id = 0;
+    count = 0;
+
+    CAL_LOCK();
+    now = ( uint32_t )ds1307_get_GMT_unix_time();
+    kicked = 0;
+    CAL_UNLOCK();
+    cal_arm();
+
+    return 0;
+}
+
+// one shot at a GMT time
+uint8_t task_at( task_t task, uint32_t gmt )
+{
+    return cal_add( task, 1, 0, gmt );
+}
+
+// every day at hh:mm local time
+uint8_t task_daily( task_t task, uint8_t hh, uint8_t mm )
+{
+    cron_t c;
+
+    if( hh > 23 || mm > 59 ) return TASK_ERROR;
+
+    memset( &c, 0, sizeof( cron_t ) );
+    c.minute[mm >> 5] = 1UL << ( mm & 31 );
+    c.hour  = 1UL << hh;
+    c.mday  = 0xFFFFFFFE;
+    c.month = 0x1FFE;
+    c.wday  = 0x7F;
+
+    return cal_add( task, 0, &c, cron_next( &c, ( uint32_t )ds1307_get_GMT_unix_time() ) );
+}
+
+// cron expression in local time
+uint8_t task_cron( task_t task, const char* spec )
+{
+    cron_t c;
+
+    if( !cron_parse( &c, spec ) ) return TASK_ERROR;
+
+    return cal_add( task, 0, &c, cron_next( &c, ( uint32_t )ds1307_get_GMT_unix_time() ) );
+}
+
+// removes the event and its task
+void task_calendar_delete( uint8_t id )
+{
+    uint8_t pos;
+
+    if( id == 0 ) return;
+
+    for( pos = 0; pos < count; pos++ )
+    {
+        if( events[order[pos]].id == id )
+        {
+            events[order[pos]].id = 0;
+            cal_unlink( pos );
+            cal_arm();
+            task_delete( id );
+            return;
+        }
+    }
+}
+
+// next run in GMT
+uint32_t task_calendar_next( uint8_t id )
+{
+    uint8_t pos;
+
+    for( pos = 0; pos < count; pos++ )
+    {
+        if( events[order[pos]].id == id )
+            return events[order[pos]].due;
+    }
+
+    return CAL_NEVER;
+}
+
+// due times again after the clock was set
+void task_calendar_sync()
+{
+    uint32_t t = ( uint32_t )ds1307_get_GMT_unix_time();
+    uint8_t e;
+
+    CAL_LOCK();
+    now = t;
+    CAL_UNLOCK();
+
+    count = 0;
+    for( e = 0; e < MAX_EVENTS; e++ )
+    {
+        if( events[e].id == 0 ) continue;
+
+        // one shots keep their time, even when it has passed now
+        if( !events[e].once )
+            events[e].due = cron_next( &events[e].cron, t );
+
+        cal_insert( e );
+    }
+
+    cal_arm();
+}
+
+// 1 Hz tick
+void task_calendar_tick()
+{
+    if( ++now >= next_due && !kicked )
+    {
+        kicked = 1;
+        task_trigger( run_id );
+    }
+}
@@ -0,0 +1,166 @@
+/**
+ * @file task_calendar.h
+ *
+ * @brief Wall clock events for the task scheduler
+ *
+ * Runs scheduler tasks at a GMT time, every day at a local time or on a
+ * cron expression, using the time of the DS1307.  The next run of each
+ * event is worked out once, in local time with daylight saving, and the
+ * events are kept sorted by it.  The 1 Hz tick only counts a second and
+ * compares it with the first due time, no calendar math happens in the
+ * ISR.  Long periods do not drift as the RTC is read each time an event
+ * is due.
+ *
+ * @author Richard Lowe
+ * @copyright AlphaLoewe
+ *
+ * @date 18/10/2026
+ *
+ * @version .01 - Initial
+ *
+ * @details
+ *
+ * Status: <XX% completed.>
+ *
+ * @note
+ *   Needs ds1307.c, ds1307_tz.c, ds1307_fmt.c and timelib_epoch.c from
+ *   the ds1307 library in the project.
+ *
+ * @code
+ *  void main()
+ *  {
+ *      ds1307_config_t rtc;
+ *
+ *      rtc.tz_offset     = -8 * 60;
+ *      rtc.dst_rule      = &ds1307_tz_us;
+ *      rtc.output_mode   = DS1307_SQW_1HZ;
+ *      rtc.hour24_enable = 1;
+ *      ds1307_init( &rtc );
+ *
+ *      task_scheduler_init( 100 );
+ *      task_calendar_init( &rtc );
+ *      task_daily( watering, 6, 30 );                  // 06:30 local
+ *      task_cron( report, "0 8-18/2 * * 1-5" );        // every 2 h, weekdays
+ *      task_at( wake, 1798761600UL );                  // once, GMT
+ *
+ *      task_scheduler_start();
+ *
+ *      while( 1 )
+ *      {
+ *          task_dispatch();
+ *      }
+ *  }
+ *
+ *  void rtc_sw_ISR() iv IVT_ADDR_INT0 ics ICS_AUTO
+ *  {
+ *      ds1307_sqw_isr();
+ *      task_calendar_tick();
+ *  }
+ * @endcode
+ *
+ * @par
+ *   Cron expressions have the five fields minute, hour, day of month,
+ *   month and day of week (0 or 7 sunday), each a list of numbers, ranges
+ *   and steps: "*", "5", "1-5", "0,30", "8-18/2".  A step may follow a
+ *   star as well.  Names are not supported.  As in cron, when both day
+ *   fields are given a day matching either one is taken.  A local time
+ *   skipped when daylight saving begins runs as much later, 02:30 at
+ *   03:30, a time that happens twice when it ends runs once.
+ *
+ * @par
+ *   Every event is a scheduler task, so events, the calendar's own task
+ *   and tasks from task_add all share the MAX_TASKS slots.  MAX_EVENTS
+ *   follows MAX_TASKS, each periodic task leaves room for one event less.
+ *   task_calendar_demo.c checks the events against the DS1307 model.
+ */
+
+#ifndef TASK_CALENDAR_H
+#define TASK_CALENDAR_H
+
+#include <stdint.h>
+#include "scheduler.h"
+#include "ds1307.h"
+
+#define MAX_EVENTS      ( MAX_TASKS - 1 )   // the calendar's own task takes a slot
+#define CAL_NEVER       0xFFFFFFFFUL    // due time of an event that never runs
+
+/**
+ *  @brief Initializes the calendar
+ *
+ *  Takes the zone from the RTC configuration and adds one event task of
+ *  its own to the scheduler.
+ *
+ *  @pre task_scheduler_init and ds1307_init
+ *
+ *  @param ds1307_config_t* rtc - configuration passed to ds1307_init
+ *
+ *  @returns int
+ *    @retval 0 OK
+ *    @retval -1 bad zone or no free task
+ */
+int task_calendar_init( ds1307_config_t* rtc );
+
+/**
+ *  @brief Runs a task once at a GMT time
+ *
+ *  A time already past runs on the next tick.  The task is deleted after
+ *  it ran.
+ *
+ *  @param task_t task - function to run
+ *  @param uint32_t gmt - unix timestamp
+ *
+ *  @returns uint8_t - task id, TASK_ERROR when no event or task is free
+ */
+uint8_t task_at( task_t task, uint32_t gmt );
+
+/**
+ *  @brief Runs a task every day at a local time
+ *
+ *  @param uint8_t hh - hour 0 .. 23
+ *  @param uint8_t mm - minute 0 .. 59
+ *
+ *  @returns uint8_t - task id, TASK_ERROR on bad time or when full
+ */
+uint8_t task_daily( task_t task, uint8_t hh, uint8_t mm );
+
+/**
+ *  @brief Runs a task on a cron expression in local time
+ *
+ *  @param const char* spec - e.g. "15 6 * * 1-5"
+ *
+ *  @returns uint8_t - task id, TASK_ERROR on a bad or never matching
+ *  expression or when full
+ */
+uint8_t task_cron( task_t task, const char* spec );
+
+/**
+ *  @brief Removes an event and its task
+ *
+ *  @param uint8_t id - id from task_at, task_daily or task_cron
+ */
+void task_calendar_delete( uint8_t id );
+
+/**
+ *  @brief Next run of an event
+ *
+ *  @returns uint32_t - GMT unix timestamp, CAL_NEVER for no such event
+ */
+uint32_t task_calendar_next( uint8_t id );
+
+/**
+ *  @brief Works out all due times again from the RTC
+ *
+ *  Call after the RTC or the zone was set.  Events do not run for the
+ *  times skipped.
+ */
+void task_calendar_sync( void );
+
+/**
+ *  @brief Counts one second, call from the 1 Hz SQW ISR
+ *
+ *  One increment and one compare, the event task is triggered when the
+ *  first event is due.
+ */
+void task_calendar_tick( void );
+
+#endif
@@ -0,0 +1,270 @@
+/**
+ * @file task_calendar_demo.c
+ *
+ * @brief Runs the calendar events against the DS1307 model
+ *
+ * The DS1307 model drives the 1 Hz tick and the scheduler dispatches
+ * after every second, for 400 days from 2025 in three zones.  Every run
+ * of two daily events in the daylight saving gap and overlap, a daily
+ * event outside them, two cron expressions and a one shot is checked
+ * against a minute by minute walk of the host's tz database.  Last the
+ * shared task limit is checked.
+ *
+ * @code
+ *   gcc -O2 -DDS1307_HOST -include math.h -I ../ds1307 -o task_calendar_demo \
+ *       task_calendar_demo.c task_calendar.c scheduler.c ../ds1307/ds1307_sim.c \
+ *       ../ds1307/ds1307.c ../ds1307/ds1307_tz.c ../ds1307/ds1307_fmt.c \
+ *       ../ds1307/timelib_epoch.c -lm
+ *   task_calendar_demo
+ * @endcode
+ *
+ * @author Richard Lowe
+ * @copyright AlphaLoewe
+ *
+ * @date 18/10/2026
+ *
+ * @version .01 - Initial
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "task_calendar.h"
+#include "ds1307_sim.h"
+
+#define Y2025       1735689600UL    // 2025-01-01 00:00:00 GMT
+#define DAYS        400UL
+#define ONCE_AT     ( Y2025 + 200 * 86400UL + 12345 )
+#define EVENTS      6
+#define MAX_RUNS    2048
+
+// event kinds, checked against the tz database
+enum { DAILY, WEEKDAYS, MONTHLY, ONCE };
+
+typedef struct
+{
+    const char* name;
+    uint8_t kind;
+    uint8_t hh;
+    uint8_t mm;
+} spec_t;
+
+typedef struct
+{
+    uint32_t runs[ MAX_RUNS ];
+    uint16_t count;
+    uint32_t want[ MAX_RUNS ];
+    uint16_t wanted;
+} log_t;
+
+static const spec_t specs[ EVENTS ] =
+{
+    { "daily 06:30",          DAILY,    6, 30 },
+    { "daily 01:30",          DAILY,    1, 30 },    // US overlap
+    { "daily 02:30",          DAILY,    2, 30 },    // gaps, EU / AU overlap
+    { "0 8-18/2 * * 1-5",     WEEKDAYS, 0,  0 },
+    { "15 6 1 * *",           MONTHLY,  6, 15 },
+    { "once",                 ONCE,     0,  0 }
+};
+
+static log_t logs[ EVENTS ];
+
+static ds1307_sim_t sim;
+static unsigned long failures;
+
+static void fail( const char* what, uint32_t t, long got, long want )
+{
+    if( failures++ < 10 )
+        printf( "  FAIL %s at %lu: %ld, expected %ld\n", what, ( unsigned long )t, got, want );
+}
+
+static void edge( void* ctx )
+{
+    ( void )ctx;
+    ds1307_sqw_isr();
+    task_calendar_tick();
+}
+
+static void record( uint8_t e )
+{
+    if( logs[e].count < MAX_RUNS )
+        logs[e].runs[ logs[e].count++ ] = ( uint32_t )ds1307_get_GMT_unix_time();
+}
+
+static void run0( void ) { record( 0 ); }
+static void run1( void ) { record( 1 ); }
+static void run2( void ) { record( 2 ); }
+static void run3( void ) { record( 3 ); }
+static void run4( void ) { record( 4 ); }
+static void run5( void ) { record( 5 ); }
+static void spare( void ) { }
+
+static void expect( uint8_t e, uint32_t t )
+{
+    if( logs[e].wanted < MAX_RUNS )
+        logs[e].want[ logs[e].wanted++ ] = t;
+}
+
+static uint8_t matches( const spec_t* l, int hh, int mm, struct tm* tm )
+{
+    switch( l->kind )
+    {
+        case DAILY:
+            return hh == l->hh && mm == l->mm;
+        case WEEKDAYS:
+            return mm == 0 && hh >= 8 && hh <= 18 && hh % 2 == 0
+                   && tm->tm_wday >= 1 && tm->tm_wday <= 5;
+        case MONTHLY:
+            return hh == l->hh && mm == l->mm && tm->tm_mday == 1;
+        default:
+            return 0;
+    }
+}
+
+/* Minute by minute through the tz database.  A local time seen before,
+   in the overlap, is not run again.  A local time skipped by the gap is
+   due as much after the gap as it was into it. */
+static void reference( uint32_t from, uint32_t to )
+{
+    struct tm tm;
+    time_t tt;
+    uint32_t t, top = 0, local, skipped;
+    uint8_t e;
+
+    for( t = from + 60; t <= to; t += 60 )
+    {
+        tt = t;
+        localtime_r( &tt, &tm );
+        local = t + tm.tm_gmtoff;
+
+        for( skipped = top + 60; top != 0 && skipped < local; skipped += 60 )
+        {
+            time_t st = skipped;
+            struct tm sm;
+
+            gmtime_r( &st, &sm );
+            for( e = 0; e < EVENTS; e++ )
+                if( matches( &specs[e], sm.tm_hour, sm.tm_min, &sm ) )
+                    expect( e, t + ( skipped - top - 60 ) );
+        }
+
+        if( local > top )
+        {
+            for( e = 0; e < EVENTS; e++ )
+                if( matches( &specs[e], tm.tm_hour, tm.tm_min, &tm ) )
+                    expect( e, t );
+            top = local;
+        }
+    }
+
+    expect( 5, ONCE_AT );
+}
+
+static int cmp( const void* a, const void* b )
+{
+    uint32_t x = *( const uint32_t* )a, y = *( const uint32_t* )b;
+
+    return ( x > y ) - ( x < y );
+}
+
+static void zone( const char* name, int16_t offset, const ds1307_tz_rule_t* rule )
+{
+    ds1307_config_t cfg;
+    uint32_t s, end = Y2025 + DAYS * 86400UL;
+    uint16_t n;
+    uint8_t e, id[ EVENTS ];
+    clock_t c0 = clock();
+
+    setenv( "TZ", name, 1 );
+    tzset();
+
+    ds1307_sim_init( &sim );
+    ds1307_sim_on_sqw( &sim, edge, NULL );
+
+    cfg.tz_offset     = offset;
+    cfg.dst_rule      = rule;
+    cfg.output_mode   = DS1307_SQW_1HZ;
+    cfg.hour24_enable = 1;
+    ds1307_init( &cfg );
+    ds1307_set_time_GMT( Y2025 );
+
+    for( e = 0; e < EVENTS; e++ )
+    {
+        logs[e].count  = 0;
+        logs[e].wanted = 0;
+    }
+
+    task_scheduler_init( 1000 );
+    task_calendar_init( &cfg );
+    id[0] = task_daily( run0, 6, 30 );
+    id[1] = task_daily( run1, 1, 30 );
+    id[2] = task_daily( run2, 2, 30 );
+    id[3] = task_cron( run3, specs[3].name );
+    id[4] = task_cron( run4, specs[4].name );
+    id[5] = task_at( run5, ONCE_AT );
+
+    for( e = 0; e < EVENTS; e++ )
+        if( id[e] == TASK_ERROR )
+            fail( specs[e].name, 0, id[e], 0 );
+
+    // events and tasks share the scheduler's slots, all are taken now
+    if( task_daily( spare, 12, 0 ) != TASK_ERROR || task_add( spare, SCH_SECONDS_1 ) != TASK_ERROR )
+        fail( "slot limit", 0, 0, TASK_ERROR );
+
+    task_scheduler_start();
+
+    for( s = Y2025; s < end; s++ )
+    {
+        ds1307_sim_advance( &sim, 1 );
+        task_dispatch();
+    }
+
+    task_scheduler_stop();
+
+    reference( Y2025, end - 1 );
+
+    printf( "  %-20s", name );
+    for( e = 0; e < EVENTS; e++ )
+    {
+        qsort( logs[e].want, logs[e].wanted, sizeof( uint32_t ), cmp );
+
+        if( logs[e].count != logs[e].wanted )
+            fail( specs[e].name, 0, logs[e].count, logs[e].wanted );
+
+        for( n = 0; n < logs[e].count && n < logs[e].wanted; n++ )
+        {
+            if( logs[e].runs[n] != logs[e].want[n] )
+            {
+                fail( specs[e].name, logs[e].want[n], logs[e].runs[n], logs[e].want[n] );
+                break;
+            }
+        }
+
+        printf( " %u", logs[e].count );
+    }
+    printf( " runs in %.2f s\n", ( double )( clock() - c0 ) / CLOCKS_PER_SEC );
+
+    // frees the calendar's own task as well, ids are slot + 1
+    for( e = 1; e <= MAX_TASKS; e++ )
+        task_delete( e );
+}
+
+int main( void )
+{
+    uint8_t e;
+
+    printf( "calendar events, %lu days from 2025, runs of", DAYS );
+    for( e = 0; e < EVENTS; e++ )
+        printf( "%s %s", e ? "," : "", specs[e].name );
+    printf( "\n" );
+
+    zone( "America/New_York", -300, &ds1307_tz_us );
+    zone( "Europe/Berlin", 60, &ds1307_tz_eu );
+    zone( "Australia/Adelaide", 570, &ds1307_tz_au );
+
+    printf( "%lu failures\n", failures );
+
+    return failures != 0;
+}
@@ -0,0 +1,164 @@
+/**
+ * @file term_demux.c
+ *
+ * @brief Host tool splitting a multiplexed terminal link into sessions
+ *
+ * Reads the framed stream produced by muxed terminal contexts from a file,
+ * serial device or stdin and appends each session's payload to its own
+ * output, <prefix>.<id>.  A SOF always starts a new frame, bytes after it
+ * are unescaped, so a damaged frame never hides the next one.  Point a terminal at each output, e.g. with
+ * named pipes or "tail -f", to watch the sessions side by side.
+ *
+ * @code
+ *   gcc -o term_demux term_demux.c
+ *   stty -F /dev/ttyUSB0 38400 raw
+ *   term_demux /dev/ttyUSB0 session      // session.0, session.1, ...
+ * @endcode
+ *
+ * @author Richard Lowe
+ * @copyright AlphaLoewe
+ *
+ * @date 18/10/2026
+ *
+ * @version .01 - Initial
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include "terminal_driver.h"
+
+#define MAX_SESSIONS  256
+
+/*** Parser states ***/
+#define WAIT_SOF      0
+#define WAIT_ID       1
+#define WAIT_LEN      2
+#define WAIT_DATA     3
+#define WAIT_SUM      4
+
+static FILE* outputs[ MAX_SESSIONS ];
+
+static FILE* session_output( const char* prefix, uint8_t id )
+{
+    char path[ 256 ];
+
+    if( outputs[id] == NULL )
+    {
+        snprintf( path, sizeof( path ), "%s.%u", prefix, id );
+        outputs[id] = fopen( path, "ab" );
+
+        if( outputs[id] == NULL )
+            perror( path );
+    }
+
+    return outputs[id];
+}
+
+int main( int argc, char** argv )
+{
+    FILE* in;
+    FILE* out;
+    int ch, i;
+    uint8_t state = WAIT_SOF;
+    uint8_t id = 0, len = 0, pos = 0, sum = 0, escaped = 0;
+    uint8_t payload[ 255 ];
+    unsigned long frames = 0, errors = 0;
+
+    if( argc != 3 )
+    {
+        fprintf( stderr, "usage: %s input|- prefix\n", argv[0] );
+        return 2;
+    }
+
+    in = ( strcmp( argv[1], "-" ) == 0 ) ? stdin : fopen( argv[1], "rb" );
+    if( in == NULL )
+    {
+        perror( argv[1] );
+        return 2;
+    }
+
+    while( ( ch = fgetc( in ) ) != EOF )
+    {
+        if( ch == TERM_MUX_SOF )
+        {
+            if( state != WAIT_SOF )
+                errors++;                           // Frame cut short
+            state   = WAIT_ID;
+            escaped = 0;
+            continue;
+        }
+
+        if( state == WAIT_SOF )
+            continue;
+
+        if( ch == TERM_MUX_ESC )
+        {
+            escaped = 1;
+            continue;
+        }
+
+        if( escaped )
+        {
+            ch ^= TERM_MUX_XOR;
+            escaped = 0;
+        }
+
+        switch( state )
+        {
+            case WAIT_ID:
+                id  = ( uint8_t )ch;
+                sum = id;
+                state = WAIT_LEN;
+                break;
+
+            case WAIT_LEN:
+                len = ( uint8_t )ch;
+                sum += len;
+                pos = 0;
+                if( len == 0 || len > TERM_MUX_FRAME_SIZE )
+                {
+                    errors++;
+                    state = WAIT_SOF;
+                }
+                else
+                {
+                    state = WAIT_DATA;
+                }
+                break;
+
+            case WAIT_DATA:
+                payload[pos++] = ( uint8_t )ch;
+                sum += ( uint8_t )ch;
+                if( pos == len )
+                    state = WAIT_SUM;
+                break;
+
+            default:
+                if( ( uint8_t )ch == sum && ( out = session_output( argv[2], id ) ) != NULL )
+                {
+                    fwrite( payload, 1, len, out );
+                    fflush( out );
+                    frames++;
+                }
+                else
+                {
+                    errors++;                       // Drop frame, resync on next SOF
+                }
+                state = WAIT_SOF;
+                break;
+        }
+    }
+
+    for( i = 0; i < MAX_SESSIONS; i++ )
+    {
+        if( outputs[i] != NULL )
+            fclose( outputs[i] );
+    }
+
+    if( in != stdin )
+        fclose( in );
+
+    fprintf( stderr, "%lu frames, %lu dropped\n", frames, errors );
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,215 @@
+/**
+ * @file term_replay.c
+ *
+ * @brief Host tool rendering a recorded terminal byte stream
+ *
+ * Feeds a recording made with term_profile_record_file() through the VT100
+ * screen model and prints the resulting screen.  When an expected screen
+ * dump is given the rendered screen is compared against it, so rendering
+ * changes in the driver can be checked and their byte cost compared offline.
+ * Built with the driver and TERM_PROFILE it also checks that the profiler
+ * charges the frames of a muxed context to the calls that wrote them.
+ *
+ * @code
+ *   gcc -o term_replay term_replay.c terminal_vt.c
+ *   term_replay menu.rec                      // print screen
+ *   term_replay menu.rec 24 80 menu.txt       // compare with expected dump
+ *
+ *   gcc -DTERM_PROFILE -o term_replay term_replay.c terminal_vt.c \
+ *       terminal_driver.c terminal_profile.c
+ *   term_replay -p                            // profiler check, muxed context
+ * @endcode
+ *
+ * @author Richard Lowe
+ * @copyright AlphaLoewe
+ *
+ * @date 18/10/2026
+ *
+ * @version .01 - Initial
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "terminal_vt.h"
+
+#ifdef TERM_PROFILE
+#include "terminal_driver.h"
+#include "terminal_profile.h"
+#endif
+
+#define DEFAULT_ROWS  24
+#define DEFAULT_COLS  80
+#define MAX_COLS      255
+
+static uint8_t cells[ 255 * 255 ];
+
+#ifdef TERM_PROFILE
+static uint32_t wired;
+
+static void wire_sink( uint8_t c )
+{
+    ( void )c;
+    wired++;
+}
+
+static uint8_t wire_source( void )
+{
+    return 13;
+}
+
+// One call's bytes, frame overhead included, must be charged to that call
+static int profile_call( const char* name, term_op_e op )
+{
+    term_op_stats_t call, send;
+
+    term_profile_get( op, &call );
+    term_profile_get( TERM_OP_SEND, &send );
+
+    printf( "profile: %s %lu call / %lu bytes, send %lu calls / %lu bytes, wire %lu bytes\n",
+            name, ( unsigned long )call.calls, ( unsigned long )call.bytes,
+            ( unsigned long )send.calls, ( unsigned long )send.bytes, ( unsigned long )wired );
+
+    return call.calls != 1 || call.bytes != wired || send.calls != 0 || send.bytes != 0;
+}
+
+// Muxed context, a large call spanning several frames and one below a frame
+static int profile_check( void )
+{
+    term_ctx_t ctx;
+    int failed;
+
+    term_ctx_init( &ctx, 1, wire_sink, wire_source );
+    term_ctx_set_mux( &ctx, 1 );
+    term_ctx_select( &ctx );
+    term_profile_init( 115200 );
+
+    wired = 0;
+    term_draw_frame( 2, 2, 10, 40, 0 );
+    failed = profile_call( "draw_frame", TERM_OP_DRAW_FRAME );
+
+    term_profile_reset();
+    wired = 0;
+    term_set_cursor_position( 5, 7 );
+    failed |= profile_call( "cursor_position", TERM_OP_CURSOR_POSITION );
+
+    return failed;
+}
+#endif
+
+// Renders one row, erased cells become spaces, trailing spaces removed
+static void render_row( term_vt_t* vt, int row, char* line )
+{
+    int c;
+    int len = 0;
+
+    for( c = 1; c <= vt->cols; c++ )
+    {
+        uint8_t ch = term_vt_cell( vt, ( uint8_t )row, ( uint8_t )c );
+        line[c - 1] = ch ? ( char )ch : ' ';
+
+        if( ch )
+            len = c;
+    }
+
+    line[len] = '\0';
+}
+
+int main( int argc, char** argv )
+{
+    FILE* fp;
+    term_vt_t vt;
+    int ch, rows, cols;
+    long bytes = 0;
+    char line[ MAX_COLS + 1 ];
+    char expected[ MAX_COLS + 3 ];
+    int r;
+
+    if( argc < 2 )
+    {
+        fprintf( stderr, "usage: %s recording [rows cols] [expected]\n", argv[0] );
+        return 2;
+    }
+
+#ifdef TERM_PROFILE
+    if( strcmp( argv[1], "-p" ) == 0 )
+        return profile_check();
+#endif
+
+    rows = ( argc > 3 ) ? atoi( argv[2] ) : DEFAULT_ROWS;
+    cols = ( argc > 3 ) ? atoi( argv[3] ) : DEFAULT_COLS;
+
+    if( rows < 1 || rows > 255 || cols < 1 || cols > MAX_COLS )
+    {
+        fprintf( stderr, "rows and cols must be 1..255\n" );
+        return 2;
+    }
+
+    fp = fopen( argv[1], "rb" );
+    if( fp == NULL )
+    {
+        perror( argv[1] );
+        return 2;
+    }
+
+    term_vt_init( &vt, cells, ( uint8_t )rows, ( uint8_t )cols );
+
+    while( ( ch = fgetc( fp ) ) != EOF )
+    {
+        term_vt_put( &vt, ( uint8_t )ch );
+        bytes++;
+    }
+
+    fclose( fp );
+
+    printf( "bytes: %ld\n", bytes );
+
+    if( argc == 5 || argc == 3 )
+    {
+        const char* path = argv[ argc - 1 ];
+
+        fp = fopen( path, "rb" );
+        if( fp == NULL )
+        {
+            perror( path );
+            return 2;
+        }
+
+        for( r = 1; r <= vt.rows; r++ )
+        {
+            size_t len;
+
+            render_row( &vt, r, line );
+
+            if( fgets( expected, sizeof( expected ), fp ) == NULL )
+                expected[0] = '\0';
+
+            len = strlen( expected );
+            while( len > 0 && ( expected[len - 1] == '\n' || expected[len - 1] == '\r'
+                                || expected[len - 1] == ' ' ) )
+            {
+                expected[--len] = '\0';
+            }
+
+            if( strcmp( line, expected ) != 0 )
+            {
+                printf( "mismatch at row %d\n  got:      '%s'\n  expected: '%s'\n",
+                        r, line, expected );
+                fclose( fp );
+                return 1;
+            }
+        }
+
+        fclose( fp );
+        printf( "screen matches %s\n", path );
+        return 0;
+    }
+
+    for( r = 1; r <= vt.rows; r++ )
+    {
+        render_row( &vt, r, line );
+        printf( "%s\n", line );
+    }
+
+    return 0;
+}
@@ -1,6 +1,10 @@
 #include <stddef.h>
 #include "terminal_driver.h"
 
+#ifdef TERM_PROFILE
+#include "terminal_profile.h"
+#endif
+
 //***************************
 // Macros
 //***************************
@@ -10,8 +14,318 @@
     term_send( 27 );       \
     term_send( '[' );
 
-static void( *send_char )( uint8_t c );
-static uint8_t( *get_char )( void );
+/*** Profiler hooks, compiled out unless TERM_PROFILE is defined ***/
+#ifdef TERM_PROFILE
+#define PROFILE_BEGIN( op )  term_profile_begin( op );
+#define PROFILE_END          term_profile_end();
+#define PROFILE_BYTE( c )    term_profile_byte( c );
+#else
+#define PROFILE_BEGIN( op )
+#define PROFILE_END
+#define PROFILE_BYTE( c )
+#endif
+
+/*** API call boundaries, a muxed frame is flushed when the outermost call returns,
+     before the profiler closes the call so the frame is charged to it ***/
+#define CALL_BEGIN( op )     call_depth++; PROFILE_BEGIN( op )
+#define CALL_END             if( --call_depth == 0 ) ctx_flush( active ); PROFILE_END
+
+static term_ctx_t  default_ctx;          // Used by term_initialise()
+static term_ctx_t* active;               // Target of term_* calls
+static term_ctx_t* visible;              // Direct session owning the screen
+static uint8_t     call_depth;
+
+static void ctx_wire( term_ctx_t* ctx, uint8_t c );
+static void ctx_wire_framed( term_ctx_t* ctx, uint8_t c );
+static void ctx_flush( term_ctx_t* ctx );
+static void ctx_put( term_ctx_t* ctx, uint8_t c );
+static void ctx_send_number( term_ctx_t* ctx, uint8_t value );
+static void ctx_send_cursor( term_ctx_t* ctx, uint8_t row, uint8_t column );
+static void ctx_send_attribute( term_ctx_t* ctx, uint8_t code );
+static void ctx_repaint( term_ctx_t* ctx, term_ctx_t* shown );
+
+
+//***************************
+// Put one byte on the physical link
+//***************************
+static void ctx_wire( term_ctx_t* ctx, uint8_t c )
+{
+    PROFILE_BYTE( c )                    // Account byte
+    ctx->send_char( c );                 // Send byte
+}
+
+
+//***************************
+// Put one byte of a frame on the link, escaping SOF and ESC
+//***************************
+static void ctx_wire_framed( term_ctx_t* ctx, uint8_t c )
+{
+    if( c == TERM_MUX_SOF || c == TERM_MUX_ESC )
+    {
+        ctx_wire( ctx, TERM_MUX_ESC );
+        c ^= TERM_MUX_XOR;
+    }
+
+    ctx_wire( ctx, c );
+}
+
+
+//***************************
+// Send buffered bytes of muxed session as one frame
+//
+// SOF | id | len | payload | sum of id, len and payload, all but SOF
+// escaped
+//***************************
+static void ctx_flush( term_ctx_t* ctx )
+{
+    uint8_t i, sum;
+
+    if( ctx == NULL || !ctx->muxed || ctx->frame_len == 0 )
+        return;
+
+    sum = ctx->id + ctx->frame_len;
+
+    ctx_wire( ctx, TERM_MUX_SOF );
+    ctx_wire_framed( ctx, ctx->id );
+    ctx_wire_framed( ctx, ctx->frame_len );
+
+    for( i = 0; i < ctx->frame_len; i++ )
+    {
+        ctx_wire_framed( ctx, ctx->frame[i] );
+        sum += ctx->frame[i];
+    }
+
+    ctx_wire_framed( ctx, sum );
+    ctx->frame_len = 0;
+}
+
+
+//***************************
+// Route one byte of session output
+//***************************
+static void ctx_put( term_ctx_t* ctx, uint8_t c )
+{
+    if( ctx->has_shadow )
+    {
+        term_vt_put( &ctx->shadow, c );  // Keep session screen model
+    }
+
+    if( ctx->muxed )
+    {
+        ctx->frame[ ctx->frame_len++ ] = c;
+
+        if( ctx->frame_len == TERM_MUX_FRAME_SIZE )
+            ctx_flush( ctx );
+    }
+    else if( ctx == visible || !ctx->has_shadow )
+    {
+        ctx_wire( ctx, c );
+    }                                    // Else offscreen, shadow only
+}
+
+
+//***************************
+// Send decimal value directly on the link
+//***************************
+static void ctx_send_number( term_ctx_t* ctx, uint8_t value )
+{
+    if( value >= 100 )
+        ctx_wire( ctx, '0' + value / 100 );
+    if( value >= 10 )
+        ctx_wire( ctx, '0' + ( value / 10 ) % 10 );
+
+    ctx_wire( ctx, '0' + value % 10 );
+}
+
+
+//***************************
+// Send cursor position directly on the link
+//***************************
+static void ctx_send_cursor( term_ctx_t* ctx, uint8_t row, uint8_t column )
+{
+    ctx_wire( ctx, 27 );
+    ctx_wire( ctx, '[' );
+    ctx_send_number( ctx, row );
+    ctx_wire( ctx, ';' );
+    ctx_send_number( ctx, column );
+    ctx_wire( ctx, 'H' );
+}
+
+
+//***************************
+// Send display attribute directly on the link
+//***************************
+static void ctx_send_attribute( term_ctx_t* ctx, uint8_t code )
+{
+    ctx_wire( ctx, 27 );
+    ctx_wire( ctx, '[' );
+    ctx_send_number( ctx, code );
+    ctx_wire( ctx, 'm' );
+}
+
+
+//***************************
+// Bring screen from shown session to ctx, only differing cells are sent
+//***************************
+static void ctx_repaint( term_ctx_t* ctx, term_ctx_t* shown )
+{
+    uint8_t r, c, want, have, cur_row, cur_col;
+    uint8_t comparable;
+
+    comparable = ( shown != NULL && shown->has_shadow
+                   && shown->shadow.rows == ctx->shadow.rows
+                   && shown->shadow.cols == ctx->shadow.cols );
+
+    ctx_send_attribute( ctx, 0 );        // Cells are painted without the old session's attributes
+
+    if( !comparable )
+    {
+        ctx_wire( ctx, 27 );             // Unknown screen, start from blank
+        ctx_wire( ctx, '[' );
+        ctx_wire( ctx, '2' );
+        ctx_wire( ctx, 'J' );
+    }
+
+    cur_row = cur_col = 0;
+
+    for( r = 1; r <= ctx->shadow.rows; r++ )
+    {
+        for( c = 1; c <= ctx->shadow.cols; c++ )
+        {
+            want = term_vt_cell( &ctx->shadow, r, c );
+            have = comparable ? term_vt_cell( &shown->shadow, r, c ) : 0;
+
+            if( want == 0 ) want = ' ';  // Erased and blank look the same
+            if( have == 0 ) have = ' ';
+
+            if( want == have )
+                continue;
+
+            if( r != cur_row || c != cur_col )
+                ctx_send_cursor( ctx, r, c );
+
+            ctx_wire( ctx, want );
+            cur_row = r;
+            cur_col = c + 1;
+        }
+    }
+
+    for( c = 1; c <= 8; c++ )            // Restore session attributes
+    {
+        if( ctx->shadow.modes & ( 1 << ( c - 1 ) ) )
+            ctx_send_attribute( ctx, c );
+    }
+    if( ctx->shadow.fg )
+        ctx_send_attribute( ctx, ctx->shadow.fg );
+    if( ctx->shadow.bg )
+        ctx_send_attribute( ctx, ctx->shadow.bg );
+
+    ctx_wire( ctx, 27 );                 // Restore scroll region, homes cursor
+    ctx_wire( ctx, '[' );
+    ctx_send_number( ctx, ctx->shadow.scroll_top );
+    ctx_wire( ctx, ';' );
+    ctx_send_number( ctx, ctx->shadow.scroll_bottom );
+    ctx_wire( ctx, 'r' );
+
+    ctx_send_cursor( ctx, ctx->shadow.row, ctx->shadow.col );
+}
+
+
+//***************************
+// Initialize terminal context
+//***************************
+void term_ctx_init( term_ctx_t* ctx, uint8_t id,
+                    void( *send_c )( uint8_t c ), uint8_t( *get_c )( void ) )
+{
+    if( ctx == NULL || send_c == NULL || get_c == NULL )
+        return;
+
+    ctx->id         = id;
+    ctx->send_char  = send_c;
+    ctx->get_char   = get_c;
+    ctx->muxed      = 0;
+    ctx->frame_len  = 0;
+    ctx->has_shadow = 0;
+}
+
+
+//***************************
+// Attach shadow screen to context
+//***************************
+void term_ctx_set_shadow( term_ctx_t* ctx, uint8_t* cells, uint8_t rows, uint8_t cols )
+{
+    if( ctx == NULL || cells == NULL || rows == 0 || cols == 0 )
+        return;
+
+    term_vt_init( &ctx->shadow, cells, rows, cols );
+    ctx->has_shadow = 1;
+}
+
+
+//***************************
+// Enable or disable framed output
+//***************************
+void term_ctx_set_mux( term_ctx_t* ctx, uint8_t enable )
+{
+    if( ctx == NULL )
+        return;
+
+    if( !enable )
+        ctx_flush( ctx );
+
+    ctx->muxed = enable ? 1 : 0;
+}
+
+
+//***************************
+// Direct term_* calls to context
+//***************************
+void term_ctx_select( term_ctx_t* ctx )
+{
+    if( ctx == NULL || ctx == active )
+        return;
+
+    ctx_flush( active );
+    active = ctx;
+}
+
+
+//***************************
+// Get selected context
+//***************************
+term_ctx_t* term_ctx_get()
+{
+    return active;
+}
+
+
+//***************************
+// Show direct session on the physical screen
+//***************************
+void term_ctx_show( term_ctx_t* ctx )
+{
+    term_ctx_t* shown = visible;
+
+    if( ctx == NULL || ctx == visible || ctx->muxed )
+        return;
+
+    visible = ctx;
+
+    if( !ctx->has_shadow )
+        return;
+
+    ctx_repaint( ctx, shown );
+}
+
+
+//***************************
+// Send pending frame of selected context
+//***************************
+void term_flush()
+{
+    ctx_flush( active );
+}
+
 
 //***************************
 // Convert byte to 3 ASCII digits and send
@@ -20,6 +334,7 @@ void term_send_value_as_digits( uint8_t value )
 {
     uint8_t digit;
     
+    CALL_BEGIN( TERM_OP_DIGITS )
     digit = '0';
     while( value >= 100 )                // Still larger than 100 ?
     {
@@ -39,6 +354,8 @@ void term_send_value_as_digits( uint8_t value )
     term_send( digit );                  // Send second digit
     
     term_send( '0' + value );            // Send third digit
+    
+    CALL_END
 }
 
 
@@ -50,12 +367,15 @@ void term_initialise( void( *send_c )( uint8_t c ), uint8_t( *get_c )( void ) )
     if( send_c == NULL || get_c == NULL )
         return;
     
-    send_char = send_c;
-    get_char  = get_c;
+    term_ctx_init( &default_ctx, 0, send_c, get_c );
+    active  = &default_ctx;
+    visible = &default_ctx;
     
+    CALL_BEGIN( TERM_OP_INIT )
     term_set_display_attribute_mode( MODE_NONE ); // Disable all previous modes
     term_erase_screen();                          // Clear screen
     term_set_cursor_position( 1, 1 );             // Move to top-left corner
+    CALL_END
 }
 
 
@@ -64,7 +384,7 @@ void term_initialise( void( *send_c )( uint8_t c ), uint8_t( *get_c )( void ) )
 //****************************
 void term_send( uint8_t _data )
 {
-    send_char( _data );                              // Send byte
+    ctx_put( active, _data );                        // Send byte
 }
 
 
@@ -73,7 +393,8 @@ void term_send( uint8_t _data )
 //***************************
 uint8_t term_get()
 {
-    return get_char();
+    ctx_flush( active );                 // Output must be out before we wait
+    return active->get_char();
 }
 
 
@@ -128,6 +449,7 @@ uint8_t term_send_flashStr( const uint8_t* str )
 {
     uint8_t count = 0;            // Initialize byte counter
 
+    CALL_BEGIN( TERM_OP_FLASH_STR )
     while( *str != 0 )                  // Reached zero byte ?
     {
         term_send( *str );
@@ -135,6 +457,7 @@ uint8_t term_send_flashStr( const uint8_t* str )
         count++;                        // Increment byte counter
     }    
     
+    CALL_END
     return count;                       // Return byte count
 }
 
@@ -148,6 +471,7 @@ uint8_t term_send_RAMStr( uint8_t* str )
 {
     uint8_t count = 0;            // Initialize byte counter
 
+    CALL_BEGIN( TERM_OP_RAM_STR )
     while( *str != 0 )                  // Reached zero byte ?
     {
         term_send( *str );
@@ -155,6 +479,7 @@ uint8_t term_send_RAMStr( uint8_t* str )
         count++;                        // Increment byte counter
     }    
     
+    CALL_END
     return count;                       // Return byte count
 }
 
@@ -164,9 +489,12 @@ uint8_t term_send_RAMStr( uint8_t* str )
 //***************************
 void term_erase_screenBottom()
 {
+    CALL_BEGIN( TERM_OP_ERASE_SCREEN_BOTTOM )
     SENDESC                             // Send escape sequence start
     
     term_send( 'J' );
+    
+    CALL_END
 }
 
 
@@ -175,10 +503,13 @@ void term_erase_screenBottom()
 //***************************
 void term_erase_screenTop()
 {
+    CALL_BEGIN( TERM_OP_ERASE_SCREEN_TOP )
     SENDESC                             // Send escape sequence start
     
     term_send( '1' );
     term_send( 'J' );
+    
+    CALL_END
 }
 
 
@@ -187,10 +518,13 @@ void term_erase_screenTop()
 //***************************
 void term_erase_screen()
 {
+    CALL_BEGIN( TERM_OP_ERASE_SCREEN )
     SENDESC                             // Send escape sequence start
     
     term_send( '2' );
     term_send( 'J' );
+    
+    CALL_END
 }
 
 
@@ -199,9 +533,12 @@ void term_erase_screen()
 //***************************
 void term_erase_to_end_of_line()
 {
+    CALL_BEGIN( TERM_OP_ERASE_TO_END_OF_LINE )
     SENDESC                             // Send escape sequence start
     
     term_send( 'K' );
+    
+    CALL_END
 }
 
 
@@ -210,10 +547,13 @@ void term_erase_to_end_of_line()
 //***************************
 void term_erase_to_start_of_line()
 {
+    CALL_BEGIN( TERM_OP_ERASE_TO_START_OF_LINE )
     SENDESC                             // Send escape sequence start
     
     term_send( '1' );
     term_send( 'K' );
+    
+    CALL_END
 }
 
 
@@ -222,10 +562,13 @@ void term_erase_to_start_of_line()
 //***************************
 void term_erase_line()
 {
+    CALL_BEGIN( TERM_OP_ERASE_LINE )
     SENDESC                             // Send escape sequence start
     
     term_send( '2' );
     term_send( 'K' );
+    
+    CALL_END
 }
 
 
@@ -234,10 +577,13 @@ void term_erase_line()
 //***************************
 void term_set_display_attribute_mode( uint8_t mode )
 {
+    CALL_BEGIN( TERM_OP_ATTRIBUTE_MODE )
     SENDESC                             // Send escape sequence start
     
     term_send( mode );
     term_send( 'm' );
+    
+    CALL_END
 }
 
 
@@ -246,11 +592,14 @@ void term_set_display_attribute_mode( uint8_t mode )
 //***************************
 void term_set_display_colour( uint8_t fg_bg, uint8_t colour )
 {
+    CALL_BEGIN( TERM_OP_COLOUR )
     SENDESC                             // Send escape sequence start
     
     term_send( fg_bg );                 // Select foreground/background
     term_send( colour );
     term_send( 'm' );
+    
+    CALL_END
 }
 
 
@@ -261,12 +610,15 @@ void term_set_display_colour( uint8_t fg_bg, uint8_t colour )
 //***************************
 void term_set_cursor_position( uint8_t row, uint8_t column )
 {
+    CALL_BEGIN( TERM_OP_CURSOR_POSITION )
     SENDESC                                        // Send escape sequence start
     
     term_send_value_as_digits( row );              // Convert row byte
     term_send( ';' );
     term_send_value_as_digits( column );           // Convert column byte
     term_send( 'H' );
+    
+    CALL_END
 }
 
 
@@ -275,11 +627,14 @@ void term_set_cursor_position( uint8_t row, uint8_t column )
 //***************************
 void term_move_cursor( uint8_t distance, uint8_t direction )
 {
+    CALL_BEGIN( TERM_OP_MOVE_CURSOR )
     SENDESC                             // Send escape sequence start
     
     term_send_value_as_digits( distance );         // Convert distance byte
 
     term_send( direction );
+    
+    CALL_END
 }
 
 
@@ -289,9 +644,12 @@ void term_move_cursor( uint8_t distance, uint8_t direction )
 //***************************
 void term_save_cursor_position()
 {
+    CALL_BEGIN( TERM_OP_SAVE_CURSOR )
     SENDESC                             // Send escape sequence start
     
     term_send( 's' );
+    
+    CALL_END
 }
 
 
@@ -300,9 +658,12 @@ void term_save_cursor_position()
 //***************************
 void term_restore_cursor_position()
 {
+    CALL_BEGIN( TERM_OP_RESTORE_CURSOR )
     SENDESC                             // Send escape sequence start
     
     term_send( 'u' );
+    
+    CALL_END
 }
 
 
@@ -311,9 +672,12 @@ void term_restore_cursor_position()
 //***************************
 void term_set_scroll_mode_all()
 {
+    CALL_BEGIN( TERM_OP_SCROLL_ALL )
     SENDESC                             // Send escape sequence start
     
     term_send( 'r' );
+    
+    CALL_END
 }
 
 
@@ -322,12 +686,15 @@ void term_set_scroll_mode_all()
 //***************************
 void term_set_scroll_mode_limit( uint8_t start, uint8_t end )
 {
+    CALL_BEGIN( TERM_OP_SCROLL_LIMIT )
     SENDESC                             // Send escape sequence start
     
     term_send_value_as_digits( start );            // Convert start line byte
     term_send( ';' );
     term_send_value_as_digits( end );              // Convert end line byte
     term_send( 'r' );
+    
+    CALL_END
 }
 
 
@@ -336,9 +703,12 @@ void term_set_scroll_mode_limit( uint8_t start, uint8_t end )
 //***************************
 void term_print_screen()
 {
+    CALL_BEGIN( TERM_OP_PRINT_SCREEN )
     SENDESC                             // Send escape sequence start
    
     term_send( 'i' );
+    
+    CALL_END
 }
 
 
@@ -354,6 +724,8 @@ void term_draw_frame( uint8_t top, uint8_t left,
                                              0xc9, 0xbb, 0xc8, 0xbc, 0xcd, 0xba };
 
     uint8_t i = 0;
+    
+    CALL_BEGIN( TERM_OP_DRAW_FRAME )
     height++;
     width++;    
     
@@ -387,6 +759,8 @@ void term_draw_frame( uint8_t top, uint8_t left,
         term_set_cursor_position( i, left + width );
         term_send( edges[ doubleFrame * 6 + 5 ] );
     }
+    
+    CALL_END
 }
 
 
@@ -401,6 +775,7 @@ uint8_t term_draw_menu( const uint8_t* menu, uint8_t selectPos,
     
     width = height = 0;
     
+    CALL_BEGIN( TERM_OP_DRAW_MENU )
     while( *ptr != 0 )                          // Scan through menu string
     {
         height++;                               // Keep track of item count
@@ -438,6 +813,8 @@ uint8_t term_draw_menu( const uint8_t* menu, uint8_t selectPos,
     }
     
     term_set_cursor_position( top + selectPos, left + 1 );    // Postition at start of selected item
+    
+    CALL_END
     return height;
 }
 
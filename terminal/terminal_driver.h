@@ -30,6 +30,10 @@
 #define TERMINAL_DRIVER_H
 
 #include <stdint.h>
+#include "terminal_vt.h"
+
+//#define TERM_PROFILE          // Count bytes per call, see terminal_profile.h
+
 //***************************
 // Misc definitions
 //***************************
@@ -64,10 +68,59 @@
 #define MOVE_RIGHT        'C'
 #define MOVE_LEFT         'D'
 
+/*** Session multiplexing ***/
+#define TERM_MUX_SOF        0x7E  // Start of frame
+#define TERM_MUX_ESC        0x7D  // Next byte is xor TERM_MUX_XOR
+#define TERM_MUX_XOR        0x20
+#define TERM_MUX_FRAME_SIZE 32    // Max payload bytes per frame
+
+/**
+ *  @struct Logical terminal session
+ *
+ *  Several contexts can share one physical link.  A muxed context sends
+ *  its output in frames (SOF, id, len, payload, checksum) which the host
+ *  side term_demux splits back into one stream per session.  SOF and ESC
+ *  after the SOF are sent as ESC, byte xor 0x20, so a SOF always starts a
+ *  frame and a damaged frame costs only itself.  Direct contexts take
+ *  turns on one screen; with a shadow attached, output of a session that
+ *  is not shown only updates its shadow and term_ctx_show() repaints the
+ *  cells that differ from the previous session, the attributes and the
+ *  scroll region.  The cursor saved by ESC[s is not restored.  A direct
+ *  context without a shadow has nowhere to keep its output and always
+ *  writes to the link.
+ */
+typedef struct
+{
+    uint8_t   id;                                 /**< Session id, frame channel      */
+    void      ( *send_char )( uint8_t c );        /**< Physical link output           */
+    uint8_t   ( *get_char )( void );              /**< Physical link input            */
+    uint8_t   muxed;                              /**< Output is framed               */
+    uint8_t   frame_len;                          /**< Bytes pending in frame         */
+    uint8_t   frame[ TERM_MUX_FRAME_SIZE ];       /**< Pending frame payload          */
+    uint8_t   has_shadow;                         /**< Shadow screen attached         */
+    term_vt_t shadow;                             /**< Screen as this session sees it */
+} term_ctx_t;
+
 //***************************
 // Function prototypes
 //***************************
 
+void term_ctx_init( term_ctx_t* ctx, uint8_t id,
+                    void( *send_c )( uint8_t ), uint8_t( *get_c )( void ) );
+
+void term_ctx_set_shadow( term_ctx_t* ctx, uint8_t* cells, uint8_t rows, uint8_t cols );
+
+void term_ctx_set_mux( term_ctx_t* ctx, uint8_t enable );
+
+void term_ctx_select( term_ctx_t* ctx );
+
+term_ctx_t* term_ctx_get( void );
+
+void term_ctx_show( term_ctx_t* ctx );
+
+void term_flush( void );
+
+
 void term_initialise( void( *send_c )( uint8_t ), uint8_t( *get_c )( void ) );
 
 uint8_t term_get();
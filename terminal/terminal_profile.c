@@ -0,0 +1,193 @@
+#include <stddef.h>
+#include <string.h>
+#include "terminal_profile.h"
+
+#ifdef TERM_PROFILE_FILE
+#include <stdio.h>
+#endif
+
+#define BITS_PER_BYTE     10              // start + 8 data + stop
+
+static term_op_stats_t stats[ TERM_OP_COUNT ];
+static uint32_t baud_rate;
+static uint8_t depth;                     // nesting of API calls
+static term_op_e current;                 // operation bytes are charged to
+static void( *recorder )( uint8_t c );
+
+#ifdef TERM_PROFILE_FILE
+static FILE* record_fp;
+
+static void record_to_file( uint8_t c )
+{
+    fputc( c, record_fp );
+}
+#endif
+
+
+//***************************
+// Initialize profiler
+//***************************
+void term_profile_init( uint32_t baud )
+{
+    baud_rate = baud;
+    term_profile_reset();
+}
+
+
+//***************************
+// Clear counters
+//***************************
+void term_profile_reset()
+{
+    memset( stats, 0, sizeof( stats ) );
+    depth   = 0;
+    current = TERM_OP_SEND;
+}
+
+
+//***************************
+// Start of API call, only the outermost call is charged
+//***************************
+void term_profile_begin( term_op_e op )
+{
+    if( depth++ == 0 )
+    {
+        current = op;
+        stats[op].calls++;
+    }
+}
+
+
+//***************************
+// End of API call
+//***************************
+void term_profile_end()
+{
+    if( depth > 0 && --depth == 0 )
+    {
+        current = TERM_OP_SEND;
+    }
+}
+
+
+//***************************
+// Account one byte
+//***************************
+void term_profile_byte( uint8_t c )
+{
+    if( depth == 0 )
+    {
+        stats[TERM_OP_SEND].calls++;      // Bare term_send()
+    }
+
+    stats[current].bytes++;
+
+    if( recorder != NULL )
+    {
+        recorder( c );
+    }
+}
+
+
+//***************************
+// Get counters
+//***************************
+void term_profile_get( term_op_e op, term_op_stats_t* op_stats )
+{
+    if( op >= TERM_OP_COUNT || op_stats == NULL )
+        return;
+
+    *op_stats = stats[op];
+}
+
+
+//***************************
+// Total bytes
+//***************************
+uint32_t term_profile_total_bytes()
+{
+    uint8_t i;
+    uint32_t total = 0;
+
+    for( i = 0; i < TERM_OP_COUNT; i++ )
+    {
+        total += stats[i].bytes;
+    }
+
+    return total;
+}
+
+
+//***************************
+// Wire time in us
+//
+// bits * 1000000 / baud as whole seconds plus the remainder scaled in two
+// steps of 1000, no product passes 32 bits for baud up to 4 Mbaud
+//***************************
+uint32_t term_profile_wire_time_us( term_op_e op )
+{
+    uint32_t bytes, sec, rem, us;
+
+    if( baud_rate < 100 )
+        return 0;
+
+    bytes = ( op >= TERM_OP_COUNT ) ? term_profile_total_bytes() : stats[op].bytes;
+
+    if( bytes > 0xFFFFFFFFUL / BITS_PER_BYTE )
+        return 0xFFFFFFFFUL;
+
+    sec = bytes * BITS_PER_BYTE / baud_rate;
+    rem = bytes * BITS_PER_BYTE % baud_rate;
+
+    us  = rem * 1000UL / baud_rate * 1000UL;
+    rem = rem * 1000UL % baud_rate;
+    us += rem * 1000UL / baud_rate;
+
+    // over 2^32 us
+    if( sec > 4294UL || us > 0xFFFFFFFFUL - sec * 1000000UL )
+        return 0xFFFFFFFFUL;
+
+    return sec * 1000000UL + us;
+}
+
+
+//***************************
+// Set recorder
+//***************************
+void term_profile_set_recorder( void( *record )( uint8_t c ) )
+{
+    recorder = record;
+}
+
+
+#ifdef TERM_PROFILE_FILE
+//***************************
+// Record to file
+//***************************
+int term_profile_record_file( const char* path )
+{
+    term_profile_record_close();
+
+    record_fp = fopen( path, "wb" );
+
+    if( record_fp == NULL )
+        return -1;
+
+    recorder = record_to_file;
+    return 0;
+}
+
+
+//***************************
+// Close recording
+//***************************
+void term_profile_record_close()
+{
+    if( record_fp != NULL )
+    {
+        fclose( record_fp );
+        record_fp = NULL;
+        recorder  = NULL;
+    }
+}
+#endif
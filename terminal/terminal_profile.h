@@ -0,0 +1,161 @@
+/**
+ * @file terminal_profile.h
+ *
+ * @brief Output bandwidth profiler for the ANSI terminal driver
+ *
+ * Counts the bytes every terminal API call puts on the wire and converts
+ * them to an estimated transmit time at the configured baud rate.  The
+ * byte stream can be handed to a recorder, e.g. a file in a host build,
+ * and rendered offline with term_replay.
+ *
+ * @author Richard Lowe
+ * @copyright AlphaLoewe
+ *
+ * @date 18/10/2026
+ *
+ * @version .01 - Initial
+ *
+ * @details
+ *
+ * Status: <XX% completed.>
+ *
+ * @note
+ * Test configuration:
+ *   MCU:             %DEVICE%
+ *   Dev.Board:       x
+ *   Oscillator:      %DEVICE_CLOCK%
+ *   Ext. Modules:    x
+ *   SW:              %COMPILER%
+ *
+ * @par
+ *   Enable with TERM_PROFILE in terminal_driver.h and add terminal_profile.c
+ *   to the project.  Nested calls, e.g. the cursor moves done inside
+ *   term_draw_frame(), are charged to the outermost call.
+ */
+
+#ifndef TERMINAL_PROFILE_H
+#define TERMINAL_PROFILE_H
+
+#include <stdint.h>
+
+//#define TERM_PROFILE_FILE     // Host builds only, enables stdio recorder
+
+/**
+ *  @enum Profiled terminal operations
+ */
+typedef enum
+{
+    TERM_OP_SEND = 0,               /**< term_send() outside of any other call */
+    TERM_OP_INIT,
+    TERM_OP_DIGITS,
+    TERM_OP_FLASH_STR,
+    TERM_OP_RAM_STR,
+    TERM_OP_ERASE_SCREEN_BOTTOM,
+    TERM_OP_ERASE_SCREEN_TOP,
+    TERM_OP_ERASE_SCREEN,
+    TERM_OP_ERASE_TO_END_OF_LINE,
+    TERM_OP_ERASE_TO_START_OF_LINE,
+    TERM_OP_ERASE_LINE,
+    TERM_OP_ATTRIBUTE_MODE,
+    TERM_OP_COLOUR,
+    TERM_OP_CURSOR_POSITION,
+    TERM_OP_MOVE_CURSOR,
+    TERM_OP_SAVE_CURSOR,
+    TERM_OP_RESTORE_CURSOR,
+    TERM_OP_SCROLL_ALL,
+    TERM_OP_SCROLL_LIMIT,
+    TERM_OP_PRINT_SCREEN,
+    TERM_OP_DRAW_FRAME,
+    TERM_OP_DRAW_MENU,
+    TERM_OP_COUNT                   /**< Number of operations, not an operation */
+} term_op_e;
+
+/**
+ *  @struct Counters kept for each operation
+ */
+typedef struct
+{
+    uint32_t calls;                 /**< Number of top level calls */
+    uint32_t bytes;                 /**< Bytes sent by those calls */
+} term_op_stats_t;
+
+/**
+ *  @brief Initializes profiler
+ *
+ *  @param uint32_t baud - baud rate of link, used for wire time estimates
+ *
+ *  @note
+ *   Assumes 8N1 framing, 10 bits per byte on the wire.
+ */
+void term_profile_init( uint32_t baud );
+
+/**
+ *  @brief Clears all counters
+ */
+void term_profile_reset( void );
+
+/**
+ *  @brief Marks the start of an API call
+ */
+void term_profile_begin( term_op_e op );
+
+/**
+ *  @brief Marks the end of an API call
+ */
+void term_profile_end( void );
+
+/**
+ *  @brief Accounts one byte sent by the driver
+ */
+void term_profile_byte( uint8_t c );
+
+/**
+ *  @brief Gets counters of operation
+ *
+ *  @param[in] op - operation
+ *  @param[out] stats - counters
+ */
+void term_profile_get( term_op_e op, term_op_stats_t* stats );
+
+/**
+ *  @brief Total bytes sent since last reset
+ */
+uint32_t term_profile_total_bytes( void );
+
+/**
+ *  @brief Estimated wire time of an operation
+ *
+ *  Rounded down to the microsecond for any byte count at baud rates up
+ *  to 4 Mbaud.  Wire times of more than about 71 minutes do not fit and
+ *  read 0xFFFFFFFF.
+ *
+ *  @param op - operation, TERM_OP_COUNT gives the total of all operations
+ *
+ *  @returns uint32_t - microseconds spent on the wire at configured baud
+ */
+uint32_t term_profile_wire_time_us( term_op_e op );
+
+/**
+ *  @brief Sets a recorder receiving every byte sent
+ *
+ *  @param record - callback, NULL stops recording
+ */
+void term_profile_set_recorder( void ( *record )( uint8_t c ) );
+
+#ifdef TERM_PROFILE_FILE
+/**
+ *  @brief Records the byte stream to a file (host builds)
+ *
+ *  @returns int
+ *    @retval 0 OK
+ *    @retval -1 file could not be opened
+ */
+int term_profile_record_file( const char* path );
+
+/**
+ *  @brief Stops and closes the file recording
+ */
+void term_profile_record_close( void );
+#endif
+
+#endif
@@ -0,0 +1,293 @@
+#include <stddef.h>
+#include <string.h>
+#include "terminal_vt.h"
+
+//***************************
+// Parser states
+//***************************
+#define VT_GROUND         0
+#define VT_ESCAPE         1
+#define VT_CSI            2
+
+#define VT_CELL( vt, r, c ) ( ( vt )->cells[ ( uint16_t )( ( r ) - 1 ) * ( vt )->cols + ( ( c ) - 1 ) ])
+
+static void vt_erase( term_vt_t* vt, uint8_t row, uint8_t from, uint8_t to );
+static void vt_scroll_up( term_vt_t* vt );
+static void vt_execute( term_vt_t* vt, uint8_t final );
+static void vt_attribute( term_vt_t* vt, uint16_t code );
+
+
+//***************************
+// Erase columns from..to of one row
+//***************************
+static void vt_erase( term_vt_t* vt, uint8_t row, uint8_t from, uint8_t to )
+{
+    if( row < 1 || row > vt->rows )
+        return;
+
+    if( to > vt->cols )
+        to = vt->cols;
+
+    while( from <= to && from >= 1 )
+    {
+        VT_CELL( vt, row, from ) = 0;
+        from++;
+    }
+}
+
+
+//***************************
+// Scroll the scroll region one line up
+//***************************
+static void vt_scroll_up( term_vt_t* vt )
+{
+    uint8_t r;
+
+    for( r = vt->scroll_top; r < vt->scroll_bottom; r++ )
+    {
+        memcpy( &VT_CELL( vt, r, 1 ), &VT_CELL( vt, r + 1, 1 ), vt->cols );
+    }
+
+    vt_erase( vt, vt->scroll_bottom, 1, vt->cols );
+}
+
+
+//***************************
+// Apply one display attribute code
+//***************************
+static void vt_attribute( term_vt_t* vt, uint16_t code )
+{
+    if( code == 0 )
+    {
+        vt->modes = 0;
+        vt->fg    = 0;
+        vt->bg    = 0;
+    }
+    else if( code <= 8 )
+        vt->modes |= ( uint8_t )( 1 << ( code - 1 ) );
+    else if( code == 22 )                               // Bold and dim off
+        vt->modes &= ( uint8_t )~0x03;
+    else if( code >= 23 && code <= 28 )                 // Attribute off
+        vt->modes &= ( uint8_t )~( 1 << ( code - 21 ) );
+    else if( code >= 30 && code <= 37 )
+        vt->fg = ( uint8_t )code;
+    else if( code == 39 )
+        vt->fg = 0;
+    else if( code >= 40 && code <= 47 )
+        vt->bg = ( uint8_t )code;
+    else if( code == 49 )
+        vt->bg = 0;
+}
+
+
+//***************************
+// Execute a complete ESC [ sequence
+//***************************
+static void vt_execute( term_vt_t* vt, uint8_t final )
+{
+    uint16_t p0 = vt->param[0];
+    uint16_t p1 = vt->param[1];
+    uint8_t r;
+
+    switch( final )
+    {
+        case 'A':                                   // Cursor up
+            vt->row = ( p0 >= vt->row ) ? 1 : vt->row - p0;
+            break;
+        case 'B':                                   // Cursor down
+            vt->row = ( vt->row + p0 > vt->rows ) ? vt->rows : vt->row + p0;
+            break;
+        case 'C':                                   // Cursor right
+            vt->col = ( vt->col + p0 > vt->cols ) ? vt->cols : vt->col + p0;
+            break;
+        case 'D':                                   // Cursor left
+            vt->col = ( p0 >= vt->col ) ? 1 : vt->col - p0;
+            break;
+        case 'H':
+        case 'f':                                   // Cursor position
+            vt->row = ( p0 == 0 ) ? 1 : ( p0 > 255 ? 255 : p0 );
+            vt->col = ( p1 == 0 ) ? 1 : ( p1 > 255 ? 255 : p1 );
+            break;
+        case 'J':                                   // Erase in display
+            if( p0 == 0 )
+            {
+                vt_erase( vt, vt->row, vt->col, vt->cols );
+                for( r = vt->row + 1; r <= vt->rows && r != 0; r++ )
+                    vt_erase( vt, r, 1, vt->cols );
+            }
+            else if( p0 == 1 )
+            {
+                for( r = 1; r < vt->row && r <= vt->rows; r++ )
+                    vt_erase( vt, r, 1, vt->cols );
+                vt_erase( vt, vt->row, 1, vt->col );
+            }
+            else
+            {
+                memset( vt->cells, 0, ( uint16_t )vt->rows * vt->cols );
+            }
+            break;
+        case 'K':                                   // Erase in line
+            if( p0 == 0 )
+                vt_erase( vt, vt->row, vt->col, vt->cols );
+            else if( p0 == 1 )
+                vt_erase( vt, vt->row, 1, vt->col );
+            else
+                vt_erase( vt, vt->row, 1, vt->cols );
+            break;
+        case 'm':                                   // Display attributes
+            vt_attribute( vt, p0 );
+            if( vt->nparam == 2 )
+                vt_attribute( vt, p1 );
+            break;
+        case 's':                                   // Save cursor
+            vt->saved_row = vt->row;
+            vt->saved_col = vt->col;
+            break;
+        case 'u':                                   // Restore cursor
+            vt->row = vt->saved_row;
+            vt->col = vt->saved_col;
+            break;
+        case 'r':                                   // Scroll region
+            if( vt->nparam < 2 )
+            {
+                vt->scroll_top    = 1;
+                vt->scroll_bottom = vt->rows;
+            }
+            else
+            {
+                vt->scroll_top    = ( p0 < 1 ) ? 1 : ( uint8_t )p0;
+                vt->scroll_bottom = ( p1 > vt->rows ) ? vt->rows : ( uint8_t )p1;
+            }
+            vt->row = 1;
+            vt->col = 1;
+            break;
+        default:                                    // 'i' and unknown, ignored
+            break;
+    }
+}
+
+
+//***************************
+// Initialize model
+//***************************
+void term_vt_init( term_vt_t* vt, uint8_t* cells, uint8_t rows, uint8_t cols )
+{
+    if( vt == NULL || cells == NULL || rows == 0 || cols == 0 )
+        return;
+
+    vt->cells = cells;
+    vt->rows  = rows;
+    vt->cols  = cols;
+    vt->modes = 0;
+    vt->fg    = 0;
+    vt->bg    = 0;
+    vt->state = VT_GROUND;
+    vt->saved_row = 1;
+    vt->saved_col = 1;
+    vt->scroll_top    = 1;
+    vt->scroll_bottom = rows;
+
+    term_vt_clear( vt );
+}
+
+
+//***************************
+// Clear model
+//***************************
+void term_vt_clear( term_vt_t* vt )
+{
+    memset( vt->cells, 0, ( uint16_t )vt->rows * vt->cols );
+    vt->row = 1;
+    vt->col = 1;
+}
+
+
+//***************************
+// Feed one byte
+//***************************
+void term_vt_put( term_vt_t* vt, uint8_t c )
+{
+    switch( vt->state )
+    {
+        case VT_ESCAPE:
+            if( c == '[' )
+            {
+                vt->state    = VT_CSI;
+                vt->nparam   = 0;
+                vt->param[0] = 0;
+                vt->param[1] = 0;
+            }
+            else
+            {
+                vt->state = VT_GROUND;
+            }
+            break;
+
+        case VT_CSI:
+            if( c >= '0' && c <= '9' )
+            {
+                if( vt->nparam == 0 )
+                    vt->nparam = 1;
+                if( vt->nparam <= 2 && vt->param[ vt->nparam - 1 ] < 1000 )
+                    vt->param[ vt->nparam - 1 ] = vt->param[ vt->nparam - 1 ] * 10 + ( c - '0' );
+            }
+            else if( c == ';' )
+            {
+                if( vt->nparam == 0 )
+                    vt->nparam = 1;
+                vt->nparam++;
+            }
+            else
+            {
+                if( ( c >= 'A' && c <= 'D' ) && vt->param[0] == 0 )
+                    vt->param[0] = 1;                // Moves default to 1
+
+                vt_execute( vt, c );
+                vt->state = VT_GROUND;
+            }
+            break;
+
+        default:
+            if( c == 27 )
+            {
+                vt->state = VT_ESCAPE;
+            }
+            else if( c == '\r' )
+            {
+                vt->col = 1;
+            }
+            else if( c == '\n' )
+            {
+                if( vt->row == vt->scroll_bottom )
+                    vt_scroll_up( vt );
+                else if( vt->row < vt->rows )
+                    vt->row++;
+            }
+            else if( c == '\b' )
+            {
+                if( vt->col > 1 )
+                    vt->col--;
+            }
+            else if( c >= ' ' )
+            {
+                if( vt->row <= vt->rows && vt->col <= vt->cols )
+                    VT_CELL( vt, vt->row, vt->col ) = c;
+
+                if( vt->col < 255 )
+                    vt->col++;
+            }
+            break;
+    }
+}
+
+
+//***************************
+// Read one cell
+//***************************
+uint8_t term_vt_cell( term_vt_t* vt, uint8_t row, uint8_t column )
+{
+    if( row < 1 || row > vt->rows || column < 1 || column > vt->cols )
+        return 0;
+
+    return VT_CELL( vt, row, column );
+}
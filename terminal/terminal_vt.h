@@ -0,0 +1,91 @@
+/**
+ * @file terminal_vt.h
+ *
+ * @brief Minimal VT100 screen model
+ *
+ * Interprets the subset of ANSI / VT100 sequences emitted by the terminal
+ * driver and keeps a character grid of what the remote terminal shows.
+ * Used by the replay tool to render recordings and by the driver to keep
+ * per-session shadow screens.
+ *
+ * @author Richard Lowe
+ * @copyright AlphaLoewe
+ *
+ * @date 18/10/2026
+ *
+ * @version .01 - Initial
+ *
+ * @details
+ *
+ * Status: <XX% completed.>
+ *
+ * @note
+ * Test configuration:
+ *   MCU:             %DEVICE%
+ *   Dev.Board:       x
+ *   Oscillator:      %DEVICE_CLOCK%
+ *   Ext. Modules:    x
+ *   SW:              %COMPILER%
+ *
+ * @par
+ *   Cells are stored row major, one byte per cell.  A cell value of 0
+ *   means the cell was erased / never written.  Positions outside the
+ *   grid are clipped, so a driver addressing row 200 does no harm.
+ */
+
+#ifndef TERMINAL_VT_H
+#define TERMINAL_VT_H
+
+#include <stdint.h>
+
+/**
+ *  @struct Screen model state
+ */
+typedef struct
+{
+    uint8_t* cells;          /**< rows * cols character buffer        */
+    uint8_t  rows;           /**< Number of rows in cells             */
+    uint8_t  cols;           /**< Number of columns in cells          */
+    uint8_t  row;            /**< Cursor row, top-left is (1,1)       */
+    uint8_t  col;            /**< Cursor column                       */
+    uint8_t  saved_row;      /**< Row stored by ESC[s                 */
+    uint8_t  saved_col;      /**< Column stored by ESC[s              */
+    uint8_t  scroll_top;     /**< First row of scroll region          */
+    uint8_t  scroll_bottom;  /**< Last row of scroll region           */
+    uint8_t  modes;          /**< Attributes 1 .. 8 on, bit code - 1  */
+    uint8_t  fg;             /**< Foreground 30 .. 37, 0 default      */
+    uint8_t  bg;             /**< Background 40 .. 47, 0 default      */
+    uint8_t  state;          /**< Escape sequence parser state        */
+    uint8_t  nparam;         /**< Number of parameters collected      */
+    uint16_t param[2];       /**< Numeric parameters of sequence      */
+} term_vt_t;
+
+/**
+ *  @brief Initializes screen model
+ *
+ *  @param vt - model to initialize
+ *  @param cells - buffer of rows * cols bytes
+ *  @param rows, cols - size of the modelled screen
+ */
+void term_vt_init( term_vt_t* vt, uint8_t* cells, uint8_t rows, uint8_t cols );
+
+/**
+ *  @brief Feeds one byte of terminal output into the model
+ */
+void term_vt_put( term_vt_t* vt, uint8_t c );
+
+/**
+ *  @brief Clears all cells, cursor goes to (1,1)
+ */
+void term_vt_clear( term_vt_t* vt );
+
+/**
+ *  @brief Reads a cell
+ *
+ *  @param row, column - 1 based position
+ *
+ *  @returns uint8_t - character at position, 0 when erased or outside grid
+ */
+uint8_t term_vt_cell( term_vt_t* vt, uint8_t row, uint8_t column );
+
+#endif